@@ -393,6 +393,8 @@
 		}
 	}
 
+	[TLOFileLogger flushAllPendingWrites];
+
 	[sharedPluginManager() unloadPlugins];
 	
 	[TXSharedApplication releaseSharedMutableSynchronizationSerialQueue];
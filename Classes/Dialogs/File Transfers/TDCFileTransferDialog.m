@@ -192,6 +192,11 @@
 }
 
 - (NSString *)addReceiverForClient:(IRCClient *)client nickname:(NSString *)nickname address:(NSString *)hostAddress port:(NSInteger)hostPort filename:(NSString *)filename filesize:(TXUnsignedLongLong)totalFilesize token:(NSString *)transferToken
+{
+	return [self addReceiverForClient:client nickname:nickname address:hostAddress port:hostPort filename:filename filesize:totalFilesize token:transferToken turbo:NO];
+}
+
+- (NSString *)addReceiverForClient:(IRCClient *)client nickname:(NSString *)nickname address:(NSString *)hostAddress port:(NSInteger)hostPort filename:(NSString *)filename filesize:(TXUnsignedLongLong)totalFilesize token:(NSString *)transferToken turbo:(BOOL)isTurbo
 {
 #ifdef TEXTUAL_BUILT_WITH_ADVANCED_ENCRYPTION
 	BOOL allowWithOTR = [sharedEncryptionManager() safeToContinueFileTransferTo:[client encryptionAccountNameForUser:nickname]
@@ -212,6 +217,7 @@
 	TDCFileTransferDialogTransferController *groupItem = [TDCFileTransferDialogTransferController new];
 	
 	[groupItem setIsSender:NO];
+	[groupItem setAcknowledgementsDisabled:isTurbo];
 	[groupItem setTransferDialog:self];
 	[groupItem setAssociatedClient:client];
 	[groupItem setPeerNickname:nickname];
@@ -54,13 +54,36 @@
 #include <net/if.h>
 #include <netdb.h>
 
-#define RECORDS_LEN     10
-#define MAX_QUEUE_SIZE  2
-#define BUF_SIZE        (1024 * 64)
-#define RATE_LIMIT      (1024 * 1024 * 5)
+#define RECORDS_LEN					10
+#define BUF_SIZE					(1024 * 64)
+
+/* The number of chunks allowed in flight grows while writes complete
+ quickly and shrinks when they start to back up so that roughly 50 to
+ 250 milliseconds of data is buffered by the socket at any time. */
+#define MIN_SEND_WINDOW				2
+#define MAX_SEND_WINDOW				64
+
+#define SEND_WINDOW_GROW_LATENCY	0.05
+#define SEND_WINDOW_SHRINK_LATENCY	0.25
+
+/* Received data is written to disk once this much has accumulated. */
+#define RECEIVE_BUFFER_SIZE			(1024 * 1024)
+
+#define ACK_WRITE_TAG				1
 
 #import "TextualApplication.h"
 
+@interface TDCFileTransferDialogTransferController ()
+@property (nonatomic, strong) NSMutableData *receiveBuffer;
+@property (nonatomic, strong) NSMutableArray *sendTimestamps;
+@property (nonatomic, assign) NSInteger sendWindowSize;
+@property (nonatomic, assign) double rateLimitAllowance;
+@property (nonatomic, assign) CFAbsoluteTime rateLimitLastRefill;
+@property (nonatomic, assign) BOOL rateLimitResumeScheduled;
+@property (nonatomic, assign) BOOL acknowledgementInFlight;
+@property (nonatomic, assign) BOOL acknowledgementQueued;
+@end
+
 @implementation TDCFileTransferDialogTransferController
 
 #pragma mark -
@@ -72,6 +95,12 @@
 		self.transferStatus = TDCFileTransferDialogTransferStoppedStatus;
 		
 		self.speedRecords = [NSMutableArray new];
+
+		self.sendTimestamps = [NSMutableArray new];
+
+		self.receiveBuffer = [NSMutableData dataWithCapacity:RECEIVE_BUFFER_SIZE];
+
+		self.sendWindowSize = MIN_SEND_WINDOW;
 	}
 	
 	return self;
@@ -584,11 +613,6 @@
 		/* Update progress. */
 		[self reloadStatusInformation];
 	});
-
-	/* Send more. */
-	if ([self isSender]) {
-		[self send];
-	}
 }
 
 #pragma mark -
@@ -596,6 +620,30 @@
 
 - (BOOL)openFileHandle
 {
+	/* Files being sent are read one chunk at a time instead of being mapped
+	 into memory. Touching a mapping of a file that was truncated or replaced
+	 while it is being sent raises SIGBUS. A read only comes up short. */
+	if ([self isSender]) {
+		self.fileHandle = [NSFileHandle fileHandleForReadingAtPath:[self completePath]];
+
+		if (self.fileHandle == nil) {
+			[self postErrorWithErrorMessage:@"TDCFileTransferDialog[1018]"];
+
+			return NO;
+		}
+
+		/* The file must still be as large as the request said it was. */
+		if ([self.fileHandle seekToEndOfFile] < self.totalFilesize) {
+			[self postErrorWithErrorMessage:@"TDCFileTransferDialog[1018]"];
+
+			return NO;
+		}
+
+		[self.fileHandle seekToFileOffset:0];
+
+		return YES;
+	}
+
 	/* Make sure we are doing something on a file that doesn't exist. */
 	if ([self isSender] == NO) {
 		/* Update filename. */
@@ -621,11 +669,24 @@
 - (void)closeFileHandle
 {
 	PointerIsEmptyAssert(self.fileHandle);
-	
+
+	[self flushReceiveBuffer];
+
 	[self.fileHandle closeFile];
 		 self.fileHandle = nil;
 }
 
+- (void)flushReceiveBuffer
+{
+	@synchronized(self.receiveBuffer) {
+		NSAssertReturn([self.receiveBuffer length] > 0);
+
+		[self.fileHandle writeData:self.receiveBuffer];
+
+		[self.receiveBuffer setLength:0];
+	}
+}
+
 #pragma mark -
 #pragma mark Socket Delegate
 
@@ -727,15 +788,57 @@
 	self.processedFilesize += [data length];
 	self.currentRecord += [data length];
 	
-	/* Write data to file. */
+	/* Queue data for the file. It is written once enough has accumulated. */
 	if ([data length] > 0) {
-		[self.fileHandle writeData:data];
+		@synchronized(self.receiveBuffer) {
+			[self.receiveBuffer appendData:data];
+		}
+
+		if ([self.receiveBuffer length] >= RECEIVE_BUFFER_SIZE) {
+			[self flushReceiveBuffer];
+		}
 	}
 
 	/* Tell socket to prepare for read. */
 	[[self readSocket] readDataWithTimeout:(-1) tag:0];
 
-	/* Send acknowledgement back to server. */
+	/* Did we complete transfer? */
+    if (self.processedFilesize >= self.totalFilesize) {
+		if (self.acknowledgementsDisabled == NO) {
+			[self writeAcknowledgement];
+		}
+
+		[self flushReceiveBuffer];
+
+		self.transferStatus = TDCFileTransferDialogTransferCompleteStatus;
+		
+		[self.associatedClient notifyFileTransfer:TXNotificationFileTransferReceiveSuccessfulType nickname:self.peerNickname filename:self.filename filesize:self.totalFilesize requestIdentifier:[self uniqueIdentifier]];
+		
+		[self close]; // Close Connection
+    } else {
+		/* Send acknowledgement back to server. */
+		if (self.acknowledgementsDisabled == NO) {
+			[self sendAcknowledgement];
+		}
+	}
+}
+
+- (void)sendAcknowledgement
+{
+	/* Each acknowledgement carries the total received so far so only
+	 the newest matters. While one is still being written, those that
+	 follow are collapsed into a single write once it finishes. */
+	if (self.acknowledgementInFlight) {
+		self.acknowledgementQueued = YES;
+	} else {
+		self.acknowledgementInFlight = YES;
+
+		[self writeAcknowledgement];
+	}
+}
+
+- (void)writeAcknowledgement
+{
     uint32_t rsize = (self.processedFilesize & 0xFFFFFFFF);
 	
     unsigned char ack[4];
@@ -745,31 +848,53 @@
     ack[2] = ((rsize >>  8) & 0xFF);
     ack[3] =  (rsize & 0xFF);
 
-	[[self readSocket] writeData:[NSData dataWithBytes:ack length:4] withTimeout:(-1) tag:0];
-	
-	/* Did we complete transfer? */
-    if (self.processedFilesize >= self.totalFilesize) {
-		self.transferStatus = TDCFileTransferDialogTransferCompleteStatus;
-		
-		[self.associatedClient notifyFileTransfer:TXNotificationFileTransferReceiveSuccessfulType nickname:self.peerNickname filename:self.filename filesize:self.totalFilesize requestIdentifier:[self uniqueIdentifier]];
-		
-		[self close]; // Close Connection
-    }
+	[[self readSocket] writeData:[NSData dataWithBytes:ack length:4] withTimeout:(-1) tag:ACK_WRITE_TAG];
 }
 
 - (void)socket:(GCDAsyncSocket *)sock didWriteDataWithTag:(long)tag
 {
+	/* Acknowledgements written by a receiver. */
+	if (tag == ACK_WRITE_TAG) {
+		self.acknowledgementInFlight = NO;
+
+		if (self.acknowledgementQueued) {
+			self.acknowledgementQueued = NO;
+
+			[self sendAcknowledgement];
+		}
+
+		return;
+	}
+
 	/* Connection check. */
 	NSAssertReturn([self isSender]);
 
 	/* Update pending sends. */
 	self.sendQueueSize -= 1;
 
+	/* Resize the window based on how long this chunk was queued for. */
+	if ([self.sendTimestamps count] > 0) {
+		CFAbsoluteTime queuedTime = [self.sendTimestamps[0] doubleValue];
+
+		[self.sendTimestamps removeObjectAtIndex:0];
+
+		CFAbsoluteTime writeLatency = (CFAbsoluteTimeGetCurrent() - queuedTime);
+
+		if (writeLatency < SEND_WINDOW_GROW_LATENCY) {
+			self.sendWindowSize = MIN((self.sendWindowSize + 1), MAX_SEND_WINDOW);
+		} else if (writeLatency > SEND_WINDOW_SHRINK_LATENCY) {
+			self.sendWindowSize = MAX((self.sendWindowSize / 2), MIN_SEND_WINDOW);
+		}
+	}
+
 	/* Update transfer information. */
 	if (self.processedFilesize >= self.totalFilesize) {
 		if (self.sendQueueSize <= 0) {
 			self.transferStatus = TDCFileTransferDialogTransferCompleteStatus;
 
+			/* Everything has been read from the file. */
+			[self closeFileHandle];
+
 			[self.associatedClient notifyFileTransfer:TXNotificationFileTransferSendSuccessfulType nickname:self.peerNickname filename:self.filename filesize:self.totalFilesize requestIdentifier:[self uniqueIdentifier]];
 
 			[self reloadStatusInformation];
@@ -798,33 +923,94 @@
 
 	PointerIsEmptyAssert([self writeSocket]);
 
-    while (1) {
-        if (self.currentRecord >= RATE_LIMIT) {
-			return; // Break chain.
-		}
+	PointerIsEmptyAssert(self.fileHandle);
+
+	TXUnsignedLongLong maximumTransferRate = [TPCPreferences fileTransferMaximumTransferRate];
 
-        if (self.sendQueueSize >= MAX_QUEUE_SIZE) {
+	while (self.sendQueueSize < self.sendWindowSize) {
+		if (self.processedFilesize >= self.totalFilesize) {
 			return; // Break chain.
 		}
 
-		if (self.processedFilesize >= self.totalFilesize) {
-			[self closeFileHandle];
+		NSUInteger chunkLength = (NSUInteger)MIN(BUF_SIZE, (self.totalFilesize - self.processedFilesize));
 
-			return; // Break chain.
+		/* Take from the rate limit allowance. When there is not enough,
+		 sending resumes once it has refilled. */
+		if (maximumTransferRate > 0) {
+			if ([self consumeRateLimitAllowance:chunkLength withMaximumTransferRate:maximumTransferRate] == NO) {
+				return; // Break chain.
+			}
 		}
 
 		/* Perform write to socket. */
-        NSData *data = [self.fileHandle readDataOfLength:BUF_SIZE];
+		NSData *data = nil;
 
-		self.processedFilesize += [data length];
-		self.currentRecord += [data length];
+		@try {
+			data = [self.fileHandle readDataOfLength:chunkLength];
+		}
+		@catch (NSException *exception) {
+			LogToConsole(@"DCC File Read Error: %@", [exception reason]);
+		}
+
+		/* The file was truncated since the request was sent. The transfer
+		 cannot finish so it fails instead of waiting for data forever. */
+		if ([data length] < chunkLength) {
+			[self postErrorWithErrorMessage:@"TDCFileTransferDialog[1018]"];
+
+			return; // Break chain.
+		}
+
+		self.processedFilesize += chunkLength;
+		self.currentRecord += chunkLength;
 
 		self.sendQueueSize += 1;
 
+		[self.sendTimestamps addObject:@(CFAbsoluteTimeGetCurrent())];
+
 		[[self writeSocket] writeData:data withTimeout:30 tag:0];
     }
 }
 
+- (BOOL)consumeRateLimitAllowance:(NSUInteger)length withMaximumTransferRate:(TXUnsignedLongLong)maximumTransferRate
+{
+	/* The allowance refills continuously and holds at most one second
+	 worth of data, or a single chunk for rates slower than that. */
+	CFAbsoluteTime currentTime = CFAbsoluteTimeGetCurrent();
+
+	double allowanceLimit = MAX((double)maximumTransferRate, (double)BUF_SIZE);
+
+	if (self.rateLimitLastRefill > 0) {
+		double allowance = (self.rateLimitAllowance + ((currentTime - self.rateLimitLastRefill) * maximumTransferRate));
+
+		self.rateLimitAllowance = MIN(allowance, allowanceLimit);
+	} else {
+		self.rateLimitAllowance = allowanceLimit;
+	}
+
+	self.rateLimitLastRefill = currentTime;
+
+	if (self.rateLimitAllowance >= length) {
+		self.rateLimitAllowance -= length;
+
+		return YES;
+	}
+
+	/* Schedule sending to resume once enough is available. */
+	if (self.rateLimitResumeScheduled == NO) {
+		self.rateLimitResumeScheduled = YES;
+
+		double resumeDelay = ((length - self.rateLimitAllowance) / maximumTransferRate);
+
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(resumeDelay * NSEC_PER_SEC)), self.serverDispatchQueue, ^{
+			self.rateLimitResumeScheduled = NO;
+
+			[self send];
+		});
+	}
+
+	return NO;
+}
+
 #pragma mark -
 #pragma mark Properties
 
@@ -885,6 +1071,20 @@
 	self.errorMessageToken = nil;
 
 	self.sendQueueSize = 0;
+	self.sendWindowSize = MIN_SEND_WINDOW;
+
+	[self.sendTimestamps removeAllObjects];
+
+	self.rateLimitAllowance = 0;
+	self.rateLimitLastRefill = 0;
+	self.rateLimitResumeScheduled = NO;
+
+	self.acknowledgementInFlight = NO;
+	self.acknowledgementQueued = NO;
+
+	@synchronized(self.receiveBuffer) {
+		[self.receiveBuffer setLength:0];
+	}
 	
 	@synchronized(self.speedRecords) {
 		[self.speedRecords removeAllObjects];
@@ -38,16 +38,145 @@
 
 #import "TextualApplication.h"
 
+/* Number of rendered topics kept for rows that have been displayed. */
+#define _renderedTopicCacheLimit		500
+
+/* TDCListDialogChannelStore holds every channel received in columns that
+ are only ever appended to. Rows are addressed by the order they arrived
+ in. The order they are displayed in is kept separately as a list of rows
+ so that sorting and filtering never move the columns themselves. */
+@interface TDCListDialogChannelStore : NSObject
+@property (nonatomic, strong) NSMutableArray *channelNames;
+@property (nonatomic, strong) NSMutableData *userCounts; // NSInteger per row
+@property (nonatomic, strong) NSMutableArray *channelTopics;
+@property (nonatomic, strong) NSMutableArray *searchText; // Folded name and topic per row
+
++ (NSString *)foldedSearchString:(NSString *)string;
+
+- (NSUInteger)appendChannel:(NSString *)channel count:(NSInteger)count topic:(NSString *)topic;
+
+- (void)removeAllChannels;
+
+@property (readonly) NSUInteger count;
+
+- (NSInteger)userCountAtRow:(NSUInteger)row;
+
+- (void)sortRows:(NSMutableData *)rows byKey:(NSInteger)sortKey order:(NSComparisonResult)sortOrder;
+@end
+
+@implementation TDCListDialogChannelStore
+
+- (instancetype)init
+{
+	if ((self = [super init])) {
+		self.channelNames = [NSMutableArray new];
+		self.userCounts = [NSMutableData new];
+		self.channelTopics = [NSMutableArray new];
+		self.searchText = [NSMutableArray new];
+	}
+
+	return self;
+}
+
++ (NSString *)foldedSearchString:(NSString *)string
+{
+	return [string stringByFoldingWithOptions:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSWidthInsensitiveSearch) locale:nil];
+}
+
+- (NSUInteger)appendChannel:(NSString *)channel count:(NSInteger)count topic:(NSString *)topic
+{
+	NSUInteger row = [self.channelNames count];
+
+	[self.channelNames addObject:channel];
+	[self.channelTopics addObject:topic];
+
+	[self.userCounts appendBytes:&count length:sizeof(NSInteger)];
+
+	/* Formatting is removed and the text folded once here so that
+	 filtering is a plain substring search of each row. */
+	NSString *searchText = [NSString stringWithFormat:@"%@\n%@", channel, [topic stripIRCEffects]];
+
+	[self.searchText addObject:[TDCListDialogChannelStore foldedSearchString:searchText]];
+
+	return row;
+}
+
+- (void)removeAllChannels
+{
+	[self.channelNames removeAllObjects];
+	[self.channelTopics removeAllObjects];
+	[self.searchText removeAllObjects];
+
+	[self.userCounts setLength:0];
+}
+
+- (NSUInteger)count
+{
+	return [self.channelNames count];
+}
+
+- (NSInteger)userCountAtRow:(NSUInteger)row
+{
+	return ((const NSInteger *)[self.userCounts bytes])[row];
+}
+
+- (void)sortRows:(NSMutableData *)rows byKey:(NSInteger)sortKey order:(NSComparisonResult)sortOrder
+{
+	NSUInteger rowCount = ([rows length] / sizeof(NSUInteger));
+
+	NSAssertReturn(rowCount > 1);
+
+	const NSInteger *userCounts = [self.userCounts bytes];
+
+	NSArray *strings = nil;
+
+	if (sortKey == 0) {
+		strings = self.channelNames;
+	} else if (sortKey == 2) {
+		strings = self.channelTopics;
+	}
+
+	qsort_b([rows mutableBytes], rowCount, sizeof(NSUInteger), ^int(const void *a, const void *b) {
+		NSUInteger row1 = *(const NSUInteger *)a;
+		NSUInteger row2 = *(const NSUInteger *)b;
+
+		NSComparisonResult result;
+
+		if (strings) {
+			result = [strings[row1] caseInsensitiveCompare:strings[row2]];
+		} else {
+			result = ((userCounts[row1] < userCounts[row2]) ? NSOrderedAscending : ((userCounts[row1] > userCounts[row2]) ? NSOrderedDescending : NSOrderedSame));
+		}
+
+		if (sortOrder == NSOrderedDescending) {
+			return (int) -(result);
+		} else {
+			return (int)   result;
+		}
+	});
+}
+
+@end
+
+#pragma mark -
+
 @interface TDCListDialog ()
 @property (nonatomic, assign) BOOL waitingForReload;
 @property (nonatomic, weak) IBOutlet NSButton *updateButton;
 @property (nonatomic, weak) IBOutlet NSSearchField *searchTextField;
 @property (nonatomic, weak) IBOutlet NSTextField *networkNameTextField;
 @property (nonatomic, weak) IBOutlet TVCBasicTableView *channelListTable;
-@property (nonatomic, strong) NSMutableArray *unfilteredList;
-@property (nonatomic, strong) NSMutableArray *filteredList;
-@property (nonatomic, readonly) NSMutableArray *activeList; // Proxies one of the two above.
-@property (nonatomic, readonly) NSInteger listCount; // Proxies one of the two above.
+@property (nonatomic, strong) TDCListDialogChannelStore *channelStore;
+@property (nonatomic, strong) NSMutableData *sortedRows; // Every row, in display order
+@property (nonatomic, strong) NSMutableData *filteredRows; // Rows matching the filter, in display order. nil when not filtering.
+@property (nonatomic, assign) BOOL rowsNeedSorting;
+@property (nonatomic, copy) NSString *activeFilter; // Folded
+@property (nonatomic, assign) NSUInteger filterGeneration;
+@property (nonatomic, assign) BOOL filterInProgress;
+@property (nonatomic, strong) dispatch_queue_t filterQueue;
+@property (nonatomic, strong) NSCache *renderedTopics;
+@property (nonatomic, readonly) NSData *activeRows; // Proxies one of sortedRows or filteredRows.
+@property (nonatomic, readonly) NSInteger listCount; // Proxies one of sortedRows or filteredRows.
 @property (nonatomic, assign) NSComparisonResult sortOrder;
 @property (nonatomic, assign) NSInteger sortKey;
 
@@ -65,7 +194,15 @@
 	if ((self = [super init])) {
 		[RZMainBundle() loadNibNamed:@"TDCListDialog" owner:self topLevelObjects:nil];
 
-		self.unfilteredList = [NSMutableArray new];
+		self.channelStore = [TDCListDialogChannelStore new];
+
+		self.sortedRows = [NSMutableData new];
+
+		self.renderedTopics = [NSCache new];
+
+		[self.renderedTopics setCountLimit:_renderedTopicCacheLimit];
+
+		self.filterQueue = dispatch_queue_create("TDCListDialogFilterQueue", DISPATCH_QUEUE_SERIAL);
 
 		self.sortKey = 1;
 		self.sortOrder = NSOrderedDescending;
@@ -107,9 +244,22 @@
 
 - (void)clear
 {
-	[self.unfilteredList removeAllObjects];
+	[self.channelStore removeAllChannels];
+
+	[self.sortedRows setLength:0];
+
+	[self.renderedTopics removeAllObjects];
 
-	 self.filteredList = nil;
+	/* A filter that is still running refers to rows that no longer exist. */
+	self.filterGeneration += 1;
+
+	self.filterInProgress = NO;
+
+	if (self.activeFilter) {
+		self.filteredRows = [NSMutableData new];
+	} else {
+		self.filteredRows = nil;
+	}
 
 	[self reloadTable];
 }
@@ -117,26 +267,19 @@
 - (void)addChannel:(NSString *)channel count:(NSInteger)count topic:(NSString *)topic
 {
 	if ([channel isChannelName]) {
-		NSAttributedString *renderedTopic = [topic attributedStringWithIRCFormatting:[NSTableView preferredGlobalTableViewFont] preferredFontColor:[NSColor blackColor]];
-
-		NSArray *item = @[channel, @(count), topic, renderedTopic];
+		NSUInteger row = [self.channelStore appendChannel:channel count:count topic:topic];
 
-		NSString *filter = [self.searchTextField stringValue];
+		/* Rows are sorted into place when the table is next reloaded. */
+		[self.sortedRows appendBytes:&row length:sizeof(NSUInteger)];
 
-		if ([filter length] > 0) {
-			if (self.filteredList == nil) {
-				self.filteredList = [NSMutableArray new];
-			}
-
-			NSInteger tr = [topic stringPositionIgnoringCase:filter];
-			NSInteger cr = [channel stringPositionIgnoringCase:filter];
-
-			if (tr > -1 || cr > -1) {
-				[self.filteredList insertSortedObject:item usingComparator:[self sortComparator]];
+		/* Rows that arrive while a filter is running are matched when it finishes. */
+		if (self.activeFilter && self.filterInProgress == NO) {
+			if ([self.channelStore.searchText[row] rangeOfString:self.activeFilter].location != NSNotFound) {
+				[self.filteredRows appendBytes:&row length:sizeof(NSUInteger)];
 			}
 		}
 
-		[self.unfilteredList insertSortedObject:item usingComparator:[self sortComparator]];
+		self.rowsNeedSorting = YES;
 
         /* Reload table instantly until we reach at least 200 channels. 
          At that point we begin reloading every 2.0 seconds. For networks
@@ -159,10 +302,14 @@
 {
     self.waitingForReload = NO;
 
+	if (self.rowsNeedSorting) {
+		[self sort];
+	}
+
 	NSString *titleCount = nil;
 
-	NSString *count1 = TXFormattedNumber([self.unfilteredList count]);
-	NSString *count2 = TXFormattedNumber([self.filteredList count]);
+	NSString *count1 = TXFormattedNumber([self.channelStore count]);
+	NSString *count2 = TXFormattedNumber([self.filteredRows length] / sizeof(NSUInteger));
 	
 	NSString *filterText = [self.searchTextField stringValue];
 
@@ -177,32 +324,15 @@
 	[self.channelListTable reloadData];
 }
 
-- (NSComparator)sortComparator
-{
-	return [^(NSArray *obj1, NSArray *obj2)
-	{
-		NSString *str1 = obj1[self.sortKey];
-		NSString *str2 = obj2[self.sortKey];
-		
-		NSComparisonResult result;
-		
-		if (self.sortKey == 1) {
-			result = [str1 compare:str2];
-		} else {
-			result = [str1 caseInsensitiveCompare:str2];
-		}
-		
-		if (self.sortOrder == NSOrderedDescending) {
-			return (NSComparisonResult) -(result);
-		} else {
-			return (NSComparisonResult)   result;
-		}
-	} copy];
-}
-
 - (void)sort
 {
-	[self.unfilteredList sortUsingComparator:[self sortComparator]];
+	self.rowsNeedSorting = NO;
+
+	[self.channelStore sortRows:self.sortedRows byKey:self.sortKey order:self.sortOrder];
+
+	if (self.filteredRows) {
+		[self.channelStore sortRows:self.filteredRows byKey:self.sortKey order:self.sortOrder];
+	}
 }
 
 #pragma mark -
@@ -236,38 +366,103 @@
 	for (NSNumber *index in [indexes arrayFromIndexSet]) {
 		NSUInteger i = [index unsignedIntegerValue];
 		
-		NSArray *item = self.activeList[i];
+		NSString *channel = self.channelStore.channelNames[[self storeRowForTableRow:i]];
 		
 		if ([self.delegate respondsToSelector:@selector(listDialogOnJoin:channel:)]) {
-			[self.delegate listDialogOnJoin:self channel:item[0]];
+			[self.delegate listDialogOnJoin:self channel:channel];
 		}
 	}
 }
 
 - (void)onSearchFieldChange:(id)sender
 {
-	self.filteredList = nil;
+	NSString *filter = [TDCListDialogChannelStore foldedSearchString:[self.searchTextField stringValue]];
+
+	/* Any filter still running is now out of date. */
+	self.filterGeneration += 1;
+
+	if ([filter length] == 0) {
+		self.activeFilter = nil;
+
+		self.filteredRows = nil;
+
+		self.filterInProgress = NO;
+
+		[self reloadTable];
+
+		return;
+	}
+
+	/* A row that matches the new filter also matched the previous one
+	 when the new filter extends it so only those rows are searched. */
+	NSData *candidateRows = nil;
+
+	if (self.filteredRows && self.activeFilter && self.filterInProgress == NO && [filter contains:self.activeFilter]) {
+		candidateRows = [self.filteredRows copy];
+	} else {
+		candidateRows = [self.sortedRows copy];
+	}
+
+	self.activeFilter = filter;
+
+	self.filterInProgress = YES;
+
+	NSArray *searchText = [self.channelStore.searchText copy];
+
+	NSUInteger filterGeneration = self.filterGeneration;
+
+	/* Matches keep the order of the candidates. They need sorting when
+	 finished if the candidates were not sorted or the sort changes. */
+	BOOL candidatesSorted = (self.rowsNeedSorting == NO);
+
+	NSInteger sortKey = self.sortKey;
+
+	NSComparisonResult sortOrder = self.sortOrder;
 
-	NSString *filter = [self.searchTextField stringValue];
+	dispatch_async(self.filterQueue, ^{
+		NSMutableData *matchedRows = [NSMutableData new];
 
-	if ([filter length] > 0) {
-		NSMutableArray *ary = [NSMutableArray new];
+		const NSUInteger *rows = [candidateRows bytes];
 
-		for (NSArray *item in self.unfilteredList) {
-			NSString *channel = item[0];
-			NSString *topicva = item[2];
+		NSUInteger rowCount = ([candidateRows length] / sizeof(NSUInteger));
 
-			NSInteger tr = [topicva stringPositionIgnoringCase:filter];
-			NSInteger cr = [channel stringPositionIgnoringCase:filter];
+		for (NSUInteger i = 0; i < rowCount; i++) {
+			NSUInteger row = rows[i];
 
-			if (tr >= 0 || cr >= 0) {
-				[ary addObject:item];
+			if (row < [searchText count] && [searchText[row] rangeOfString:filter].location != NSNotFound) {
+				[matchedRows appendBytes:&row length:sizeof(NSUInteger)];
 			}
 		}
 
-		self.filteredList = [ary mutableCopy];
+		XRPerformBlockAsynchronouslyOnMainQueue(^{
+			if (candidatesSorted == NO || NSDissimilarObjects(sortKey, self.sortKey) || NSDissimilarObjects(sortOrder, self.sortOrder)) {
+				self.rowsNeedSorting = YES;
+			}
+
+			[self filterFinishedWithMatchedRows:matchedRows searchedRowCount:[searchText count] generation:filterGeneration];
+		});
+	});
+}
+
+- (void)filterFinishedWithMatchedRows:(NSMutableData *)matchedRows searchedRowCount:(NSUInteger)searchedRowCount generation:(NSUInteger)filterGeneration
+{
+	NSAssertReturn(filterGeneration == self.filterGeneration);
+
+	self.filterInProgress = NO;
+
+	/* Match rows that were added while the filter was running. */
+	NSUInteger rowCount = [self.channelStore count];
+
+	for (NSUInteger row = searchedRowCount; row < rowCount; row++) {
+		if ([self.channelStore.searchText[row] rangeOfString:self.activeFilter].location != NSNotFound) {
+			[matchedRows appendBytes:&row length:sizeof(NSUInteger)];
+
+			self.rowsNeedSorting = YES;
+		}
 	}
 
+	self.filteredRows = matchedRows;
+
 	[self reloadTable];
 }
 
@@ -276,22 +471,23 @@
 
 - (NSInteger)listCount
 {
-	if (	    self.filteredList) {
-		return [self.filteredList count];
-	} else {
-		return [self.unfilteredList count];
-	}
+	return ([self.activeRows length] / sizeof(NSUInteger));
 }
 
-- (NSArray *)activeList
+- (NSData *)activeRows
 {
-	if (	   self.filteredList) {
-		return self.filteredList;
+	if (	   self.filteredRows) {
+		return self.filteredRows;
 	} else {
-		return self.unfilteredList;
+		return self.sortedRows;
 	}
 }
 
+- (NSUInteger)storeRowForTableRow:(NSUInteger)row
+{
+	return ((const NSUInteger *)[self.activeRows bytes])[row];
+}
+
 - (NSInteger)numberOfRowsInTableView:(NSTableView *)sender
 {
 	return self.listCount;
@@ -299,14 +495,27 @@
 
 - (id)tableView:(NSTableView *)sender objectValueForTableColumn:(NSTableColumn *)column row:(NSInteger)row
 {
-	NSArray *item = self.activeList[row];
+	NSAssertReturnR((row < self.listCount), nil);
+
+	NSUInteger storeRow = [self storeRowForTableRow:row];
 
 	if ([[column identifier] isEqualToString:@"chname"]) {
-		return item[0];
+		return self.channelStore.channelNames[storeRow];
 	} else if ([[column identifier] isEqualToString:@"count"]) {
-		return item[1];
+		return @([self.channelStore userCountAtRow:storeRow]);
 	} else {
-		return item[3];
+		/* Topics are only rendered once their row is displayed. */
+		NSAttributedString *renderedTopic = [self.renderedTopics objectForKey:@(storeRow)];
+
+		if (renderedTopic == nil) {
+			NSString *topic = self.channelStore.channelTopics[storeRow];
+
+			renderedTopic = [topic attributedStringWithIRCFormatting:[NSTableView preferredGlobalTableViewFont] preferredFontColor:[NSColor blackColor]];
+
+			[self.renderedTopics setObject:renderedTopic forKey:@(storeRow)];
+		}
+
+		return renderedTopic;
 	}
 }
 
@@ -334,11 +543,7 @@
         }
 	}
 
-	[self sort];
-
-	if (self.filteredList) {
-		[self onSearchFieldChange:nil];
-	}
+	self.rowsNeedSorting = YES;
 
 	[self reloadTable];
 }
@@ -42,6 +42,20 @@ typedef enum IRCAddressBookEntryType : NSInteger {
 	IRCAddressBookUserTrackingEntryType
 } IRCAddressBookEntryType;
 
+typedef enum IRCAddressBookIgnoreFlags : NSUInteger {
+	IRCAddressBookNoIgnoreFlags								= 0,
+	IRCAddressBookIgnoreNoticeMessagesFlag					= 1 << 0,
+	IRCAddressBookIgnorePublicMessagesFlag					= 1 << 1,
+	IRCAddressBookIgnorePublicMessageHighlightsFlag			= 1 << 2,
+	IRCAddressBookIgnorePrivateMessagesFlag					= 1 << 3,
+	IRCAddressBookIgnorePrivateMessageHighlightsFlag		= 1 << 4,
+	IRCAddressBookIgnoreGeneralEventMessagesFlag			= 1 << 5,
+	IRCAddressBookIgnoreFileTransferRequestsFlag			= 1 << 6,
+	IRCAddressBookIgnoreMessagesContainingMatchFlag			= 1 << 7,
+	IRCAddressBookIgnoreClientToClientProtocolFlag			= 1 << 8,
+	IRCAddressBookTrackUserActivityFlag						= 1 << 9
+} IRCAddressBookIgnoreFlags;
+
 /* Keys that can be accessed by -dictionaryValue. It is recommended to only access
  these keys as any other are used internally and may change without notice. */
 TEXTUAL_EXTERN NSString * const IRCAddressBookDictionaryValueIgnoreNoticeMessagesKey;
@@ -81,5 +95,28 @@ TEXTUAL_EXTERN NSString * const IRCAddressBookDictionaryValueTrackUserActivityKe
 
 @property (readonly, copy) NSString *trackingNickname;
 
+@property (readonly) IRCAddressBookIgnoreFlags ignoreFlags; // All enabled options as a bitmask
+
 - (BOOL)checkIgnore:(NSString *)thehost;
+
+/* Translates the keys accepted by -dictionaryValue into a bitmask. */
++ (IRCAddressBookIgnoreFlags)ignoreFlagsForDictionaryValueKeys:(NSArray *)keys;
+@end
+
+/* IRCAddressBookMatcher compiles a list of address book entries once so that
+ a hostmask can be tested against all of them without going through regular
+ expressions. Hostmasks without wildcards are kept in a hash table. The rest
+ are kept in a trie keyed by their text up to the first wildcard, which means
+ only entries whose fixed prefix matches the hostmask are tested at all. 
+ 
+ A matcher is immutable. Create a new one when the list of entries changes. */
+@interface IRCAddressBookMatcher : NSObject
+- (instancetype)initWithEntries:(NSArray *)entries;
+
+@property (readonly, copy) NSArray *entries;
+
+/* Returns the union of the flags of every entry matching hostmask, limited
+ to those in flags. matchedEntry is set to the first entry (in the order
+ of -entries) which matched with at least one of flags. */
+- (IRCAddressBookIgnoreFlags)matchHostmask:(NSString *)hostmask withFlags:(IRCAddressBookIgnoreFlags)flags matchedEntry:(IRCAddressBookEntry **)matchedEntry;
 @end
@@ -99,9 +99,15 @@ TEXTUAL_EXTERN NSString * const IRCChannelConfigurationWasUpdatedNotification;
 
 - (BOOL)memberExists:(NSString *)nickname;
 
+/* Nicknames are matched using the CASEMAPPING of the server. As has always
+ been the case, the mask of -findMember:options: is not used. */
 - (IRCUser *)findMember:(NSString *)nickname;
 - (IRCUser *)findMember:(NSString *)nickname options:(NSStringCompareOptions)mask;
 
+/* Refolds the nickname of every member. Called when CASEMAPPING changes. Each
+ member is noted with the client again so its index must be cleared first. */
+- (void)rebuildMemberListNicknameIndex;
+
 - (void)addMember:(IRCUser *)user;
 - (void)removeMember:(NSString *)nickname;
 - (void)renameMember:(NSString *)fromNickname to:(NSString *)toNickname;
@@ -109,6 +115,15 @@ TEXTUAL_EXTERN NSString * const IRCChannelConfigurationWasUpdatedNotification;
 
 - (void)clearMembers; // This will not reload table view. 
 
+/* Members received in NAMES replies are staged and turned into the member
+ list in one pass when the end of the reply is received. Committing reloads
+ the member list view and posts a single event to the style. Removing or
+ renaming a member also applies to the staged members. Staged members are
+ discarded when the member list is cleared or a new NAMES request is sent. */
+- (void)stageMembersFromNamesReply:(NSArray *)members;
+- (void)commitStagedMembersFromNamesReply;
+- (void)discardStagedMembersFromNamesReply;
+
 @property (readonly) NSInteger numberOfMembers;
 
 /* The member list methods returns the actual instance of user stored in 
@@ -121,6 +136,10 @@ TEXTUAL_EXTERN NSString * const IRCChannelConfigurationWasUpdatedNotification;
 @property (readonly, copy) NSArray *memberList; // Automatically sorted by channel rank
 @property (readonly, copy) NSArray *memberListSortedByNicknameLength; // Copy of member list automatically sorted by longest nickname to shortest nickname
 
+/* Finds the nickname of every member mentioned in string in a single pass.
+ Matches are not checked for what surrounds them. See TLOMultiPatternScanner. */
+- (void)enumerateMembersMentionedInString:(NSString *)string usingBlock:(void (^)(IRCUser *member, NSRange range, BOOL *stop))block;
+
 - (BOOL)memberRequiresRedraw:(IRCUser *)user1 comparedTo:(IRCUser *)user2;
 
 - (void)updateAllMembersOnTableView;
@@ -38,6 +38,7 @@
 
 #import "IRCTreeItem.h" // superclass
 
+#import "IRCMessage.h"			// typedef struct
 #import "TVCLogLine.h"			// typedef enum
 #import "TLOGrowlController.h"	// typedef enum
 
@@ -216,6 +217,7 @@ TEXTUAL_EXTERN NSString * const IRCClientConfigurationWasUpdatedNotification;
 - (void)postEventToViewController:(NSString *)eventToken forChannel:(IRCChannel *)channel;
 
 - (IRCAddressBookEntry *)checkIgnoreAgainstHostmask:(NSString *)host withMatches:(NSArray *)matches;
+- (IRCAddressBookEntry *)checkIgnoreAgainstHostmask:(NSString *)host withFlags:(IRCAddressBookIgnoreFlags)flags;
 
 - (BOOL)outputRuleMatchedInMessage:(NSString *)raw inChannel:(IRCChannel *)chan withLineType:(TVCLogLineType)type;
 
@@ -282,9 +284,28 @@ TEXTUAL_EXTERN NSString * const IRCClientConfigurationWasUpdatedNotification;
 - (IRCChannel *)findChannelOrCreate:(NSString *)name;
 - (IRCChannel *)findChannelOrCreate:(NSString *)name isPrivateMessage:(BOOL)isPM;
 
+// -findChannel: is backed by an index of folded channel names. IRCChannel
+// calls this when the name of a channel or private message changes.
+- (void)rebuildChannelNameIndex;
+
+// Channels and private messages that the nickname is a member of, in no
+// particular order. Backed by an index that IRCChannel keeps up to date as
+// members are added, removed, and renamed so that QUIT and NICK handling
+// does not have to ask every channel.
+- (NSArray *)channelsContainingMember:(NSString *)nickname;
+
+// The identity shared by every channel that the nickname is a member of.
+// Returns nil when the nickname is not in any channel.
+- (IRCUserIdentity *)identityForMember:(NSString *)nickname;
+
+- (void)noteMember:(IRCUser *)member withIndexKey:(NSString *)indexKey wasAddedToChannel:(IRCChannel *)channel;
+- (void)noteMemberWithIndexKey:(NSString *)indexKey wasRemovedFromChannel:(IRCChannel *)channel;
+
 - (NSData *)convertToCommonEncoding:(NSString *)data;
 - (NSString *)convertFromCommonEncoding:(NSData *)data;
 
+- (IRCMessageParseOptions)receivedLineParseOptions; // Main queue only
+
 - (NSString *)formatNickname:(NSString *)nick channel:(IRCChannel *)channel; // Defaults to TVCLogLineUndefinedNicknameFormat
 - (NSString *)formatNickname:(NSString *)nick channel:(IRCChannel *)channel formatOverride:(NSString *)forcedFormat;
 
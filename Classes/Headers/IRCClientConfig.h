@@ -87,6 +87,7 @@ typedef enum TXConnectionProxyType : NSInteger {
 @property (nonatomic, copy) NSArray *channelList;
 @property (nonatomic, copy) NSArray *highlightList;
 @property (nonatomic, copy) NSArray *ignoreList;
+@property (readonly, strong) IRCAddressBookMatcher *ignoreListMatcher; // Rebuilt when ignoreList is set
 @property (nonatomic, copy) NSArray *loginCommands;
 @property (nonatomic, copy) NSData *identityClientSideCertificate;
 @property (nonatomic, copy) NSString *awayNickname;
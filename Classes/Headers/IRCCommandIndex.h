@@ -47,6 +47,9 @@ TEXTUAL_EXTERN NSString *IRCPublicCommandIndex(const char *key);
 
 + (NSArray *)publicIRCCommandList;
 
+/* Returns the interned, uppercase form of a known command, or nil. */
++ (NSString *)commandWithBytes:(const char *)bytes length:(NSUInteger)length;
+
 + (NSInteger)indexOfIRCommand:(NSString *)command;
 + (NSInteger)indexOfIRCommand:(NSString *)command publicSearch:(BOOL)isPublic;
 
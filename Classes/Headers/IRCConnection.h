@@ -38,6 +38,16 @@
 
 #import "TextualApplication.h"
 
+#import "IRCMessage.h" // typedef struct
+
+/* Lines of a higher priority are always sent before those of a lower one.
+ Lines of the same priority are sent in the order they were queued. */
+typedef enum IRCConnectionSendPriority : NSInteger {
+	IRCConnectionControlSendPriority = 0, // PING, PONG and registration (PASS, NICK, USER, CAP). Never held back by flood control.
+	IRCConnectionInteractiveSendPriority = 1, // Anything the user asked for, including QUIT
+	IRCConnectionBackgroundSendPriority = 2, // Autojoin, WHO and ISON polling, and other bulk traffic
+} IRCConnectionSendPriority;
+
 @interface IRCConnection : NSObject
 @property (nonatomic, weak) IRCClient *associatedClient;
 @property (nonatomic, strong) TLOTimer *floodTimer;
@@ -50,6 +60,8 @@
 @property (nonatomic, assign) BOOL connectionUsesOutgoingFloodControl;
 @property (nonatomic, assign) NSInteger floodControlDelayInterval;
 @property (nonatomic, assign) NSInteger floodControlMaximumMessageCount;
+@property (nonatomic, assign) NSUInteger receiveBatchMaximumLineCount; // Maximum number of lines handed to the main queue at once.
+@property (nonatomic, assign) NSTimeInterval receiveBatchLatencyBudget; // Maximum time spent processing received lines before yielding the main queue.
 @property (nonatomic, copy) NSString *serverAddress;
 @property (nonatomic, assign) NSInteger serverPort;
 @property (nonatomic, copy) NSString *proxyAddress;
@@ -62,7 +74,8 @@
 - (void)open;
 - (void)close;
 
-- (void)sendLine:(NSString *)line;
+- (void)sendLine:(NSString *)line; // Control priority for control commands, otherwise interactive
+- (void)sendLine:(NSString *)line priority:(IRCConnectionSendPriority)priority;
 
 - (void)clearSendQueue;
 
@@ -77,6 +90,8 @@
 - (void)ircConnectionDidDisconnect:(IRCConnection *)sender withError:(NSError *)distcError;
 - (void)ircConnectionDidError:(NSString *)error;
 - (void)ircConnectionDidReceive:(NSString *)data;
+- (void)ircConnectionDidReceiveMessage:(IRCMessage *)message;
+- (IRCMessageParseOptions)ircConnectionReceivedLineParseOptions; // Called on the main queue.
 - (void)ircConnectionWillSend:(NSString *)line;
 - (void)ircConnectionDidSecureConnection;
 @end
@@ -38,18 +38,26 @@
 #import "TextualApplication.h"
 
 @interface IRCConnection ()
-@property (nonatomic, strong) NSMutableArray *sendQueue;
-@property (nonatomic, assign) NSInteger floodControlCurrentMessageCount;
+@property (nonatomic, copy) NSArray *sendQueues; // One per IRCConnectionSendPriority
+@property (nonatomic, assign) double floodControlAvailableTokens;
+@property (nonatomic, assign) CFAbsoluteTime floodControlLastRefill;
 @property (nonatomic, assign) BOOL lastDisconnectWasErroneous;
 @property (nonatomic, strong) dispatch_queue_t dispatchQueue;
 @property (nonatomic, strong) dispatch_queue_t socketQueue;
-@property (nonatomic, copy) NSData *bufferOverflowString;
+@property (nonatomic, strong) IRCConnectionLineBuffer *readBuffer;
+@property (nonatomic, strong) NSMutableArray *receiveBatchMessages; // Socket queue only
+@property (nonatomic, strong) NSMutableArray *receivedMessageQueue; // Main queue only
+@property (nonatomic, assign) BOOL isProcessingReceivedLineQueue; // Main queue only
+@property (nonatomic, assign) BOOL isDeliveringReceivedLine; // Main queue only
+@property (assign) IRCMessageParseOptions receivedLineParseOptions; // Written on the main queue, read on the socket queue
 @property (nonatomic, strong) id socketConnection;
 
 - (void)tcpClientDidConnect;
 - (void)tcpClientDidError:(NSString *)error;
 - (void)tcpClientDidDisconnect:(NSError *)distcError;
-- (void)tcpClientDidReceiveData:(NSString *)data;
+- (void)tcpClientDidReceiveMessages:(NSArray *)messages;
+
+- (void)refreshReceivedLineParseOptions;
 - (void)tcpClientDidSecureConnection;
 - (void)tcpClientDidSendData;
 @end
@@ -38,6 +38,12 @@
 
 #import "TextualApplication.h"
 
+typedef enum IRCISupportCaseMapping : NSInteger {
+	IRCISupportRFC1459CaseMapping			= 0,	// A-Z[]\^ to a-z{}|~ (default)
+	IRCISupportStrictRFC1459CaseMapping,			// A-Z[]\ to a-z{}|
+	IRCISupportASCIICaseMapping,					// A-Z to a-z
+} IRCISupportCaseMapping;
+
 @interface IRCISupportInfo : NSObject
 @property (nonatomic, copy) NSDictionary *channelModes;
 @property (nonatomic, assign) NSInteger nicknameLength;
@@ -49,6 +55,7 @@
 @property (nonatomic, copy) NSArray *userModePrefixes;
 @property (nonatomic, copy) NSArray *cachedConfiguration;
 @property (nonatomic, copy) NSString *privateMessageNicknamePrefix;
+@property (nonatomic, assign) IRCISupportCaseMapping caseMapping;
 
 - (void)reset;
 
@@ -63,6 +70,17 @@
 - (BOOL)symbolIsUserPrefixCharacter:(NSString *)symbol;
 - (NSInteger)rankForUserPrefixWithMode:(NSString *)mode; // Starts at 100; 100 = highest rank
 
+/* Character versions of the above backed by lookup tables that are rebuilt
+ whenever PREFIX or CHANMODES changes. They return 0 for characters that the
+ server did not advertise. */
+- (unichar)modeCharacterFromUserPrefixCharacter:(unichar)symbol;
+- (unichar)userPrefixCharacterWithModeCharacter:(unichar)mode;
+- (NSInteger)rankForUserPrefixModeCharacter:(unichar)mode; // Starts at 100; 100 = highest rank
+
+/* Folds a nickname using the CASEMAPPING advertised by the server so that two
+ nicknames the server considers equal produce the same string. */
+- (NSString *)caseMappedNickname:(NSString *)nickname;
+
 - (NSArray *)parseMode:(NSString *)modeString;
 - (IRCModeInfo *)createMode:(NSString *)mode;
 @end
@@ -38,6 +38,24 @@
 
 #import "TextualApplication.h"
 
+/* The state of the client that decides how a line is parsed. Received lines are
+ parsed on the socket queue so this is captured on the main queue beforehand
+ instead of asking the client and preferences from the socket queue. */
+typedef struct IRCMessageParseOptions {
+	NSStringEncoding primaryEncoding;
+	NSStringEncoding fallbackEncoding;
+	BOOL stripFormatting;
+	BOOL parseServerTime;
+} IRCMessageParseOptions;
+
+NS_INLINE BOOL IRCMessageParseOptionsAreEqual(IRCMessageParseOptions options1, IRCMessageParseOptions options2)
+{
+	return (options1.primaryEncoding == options2.primaryEncoding &&
+			options1.fallbackEncoding == options2.fallbackEncoding &&
+			options1.stripFormatting == options2.stripFormatting &&
+			options1.parseServerTime == options2.parseServerTime);
+}
+
 @interface IRCMessage : NSObject
 @property (nonatomic, assign) NSInteger numericReply;
 @property (nonatomic, copy) IRCPrefix *sender;
@@ -52,6 +70,24 @@
 - (void)parseLine:(NSString *)line;
 - (void)parseLine:(NSString *)line forClient:(IRCClient *)client;
 
+/* Parses a line directly from the raw bytes received from the server. Only the
+ location of each component is recorded during parsing. The sender, command, and
+ parameters are not turned into strings until they are first asked for. */
+- (void)parseData:(NSData *)data forClient:(IRCClient *)client; // Main queue only
+- (void)parseData:(NSData *)data options:(IRCMessageParseOptions)options;
+
+/* Unlike the above, the data is not copied. It must not change for as long
+ as the message exists. Any number of messages can share the same data. */
+- (void)parseData:(NSData *)data range:(NSRange)range options:(IRCMessageParseOptions)options;
+
+/* Parses the same bytes again. Does nothing for a message parsed from a string. */
+- (void)parseAgainWithOptions:(IRCMessageParseOptions)options;
+
+@property (readonly) IRCMessageParseOptions parseOptions; // The options the message was last parsed with
+
+@property (readonly, copy) NSData *rawData; // The bytes of the line or nil when parsed from a string. Created when first asked for.
+@property (readonly) NSUInteger rawDataLength; // Length of -rawData without creating it
+
 @property (readonly, copy) NSString *senderNickname;
 @property (readonly, copy) NSString *senderUsername;
 @property (readonly, copy) NSString *senderAddress;
@@ -91,6 +91,14 @@ typedef enum IRCUserRank : NSInteger {
 
 @property (readonly, copy) NSString *mark; // Returns mode symbol for highest rank (-modes)
 
+// -username, -address, -realname, -isCop, and -isAway are stored in the
+// identity of the user. Once the user is added to a channel, IRCClient
+// replaces its identity with the one shared by every channel the nickname
+// is in. Copies of a user always receive an identity of their own.
+@property (readonly, strong) IRCUserIdentity *identity;
+
+- (void)shareIdentity:(IRCUserIdentity *)identity;
+
 - (void)outgoingConversation;
 - (void)incomingConversation;
 - (void)conversation;
@@ -93,6 +93,16 @@ typedef enum TDCFileTransferDialogNavigationControllerSelectedTab : NSInteger {
 						  filesize:(TXUnsignedLongLong)totalFilesize
 					   token:(NSString *)transferToken;
 
+/* Same as above. Turbo transfers (DCC TSEND) are not acknowledged by the receiver. */
+- (NSString *)addReceiverForClient:(IRCClient *)client
+						  nickname:(NSString *)nickname
+						   address:(NSString *)hostAddress
+							  port:(NSInteger)hostPort
+						  filename:(NSString *)filename
+						  filesize:(TXUnsignedLongLong)totalFilesize
+							 token:(NSString *)transferToken
+							 turbo:(BOOL)isTurbo;
+
 - (NSString *)addSenderForClient:(IRCClient *)client
 				  nickname:(NSString *)nickname
 					  path:(NSString *)completePath
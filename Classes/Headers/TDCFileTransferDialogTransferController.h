@@ -43,6 +43,7 @@
 @property (nonatomic, assign) BOOL isHidden; // Is visible on the dialog.
 @property (nonatomic, assign) BOOL isReversed; // Is reverse DCC transfer.
 @property (nonatomic, assign) BOOL isSender; // Type of transfer.
+@property (nonatomic, assign) BOOL acknowledgementsDisabled; // Receiver does not send acknowledgements (TSEND).
 @property (nonatomic, copy) NSString *path;
 @property (nonatomic, copy) NSString *filename;
 @property (nonatomic, copy) NSString *peerNickname;
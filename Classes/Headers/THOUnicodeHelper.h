@@ -38,9 +38,23 @@
 
 #import "TextualApplication.h"
 
+typedef enum THOUnicodeByteSequenceType : NSInteger {
+	THOUnicodeASCIIByteSequenceType,
+	THOUnicodeUTF8ByteSequenceType,
+	THOUnicodeUnknownByteSequenceType, // Not valid UTF-8
+} THOUnicodeByteSequenceType;
+
 @interface THOUnicodeHelper : NSObject
 + (BOOL)isPrivate:(UniChar)c;
 + (BOOL)isIdeographic:(UniChar)c;
 + (BOOL)isIdeographicOrPrivate:(UniChar)c;
 + (BOOL)isAlphabeticalCodePoint:(NSInteger)c;
+
+/* Classifies bytes in a single pass as plain ASCII, valid UTF-8, or neither. */
++ (THOUnicodeByteSequenceType)typeOfByteSequence:(const char *)bytes length:(NSUInteger)length;
+
+/* Decodes bytes using the primary encoding, then the fallback, then ASCII,
+ the same as trying each in turn. The bytes are classified first so that
+ a decoder which is known to fail is never attempted. */
++ (NSString *)stringWithBytes:(const char *)bytes length:(NSUInteger)length primaryEncoding:(NSStringEncoding)primaryEncoding fallbackEncoding:(NSStringEncoding)fallbackEncoding;
 @end
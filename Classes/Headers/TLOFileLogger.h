@@ -64,6 +64,13 @@ TEXTUAL_EXTERN NSString * const TLOFileLoggerTwentyFourHourClockFormat;
 
 @property (readonly, copy) NSURL *buildPath;
 
+/* Writes are buffered and performed on a background queue shared by every logger.
+ Lines are rendered and the folder they belong in is resolved on the main thread,
+ which is where the write methods, -open, and -reopenIfNeeded are called from.
+ -close and -reset wait for that queue. +flushAllPendingWrites waits until every
+ buffered line of every logger is on disk. It is called during termination. */
 - (void)writeLine:(TVCLogLine *)logLine;
 - (void)writePlainTextLine:(NSString *)s;
+
++ (void)flushAllPendingWrites;
 @end
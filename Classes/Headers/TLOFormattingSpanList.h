@@ -0,0 +1,76 @@
+/* ********************************************************************* 
+                  _____         _               _
+                 |_   _|____  _| |_ _   _  __ _| |
+                   | |/ _ \ \/ / __| | | |/ _` | |
+                   | |  __/>  <| |_| |_| | (_| | |
+                   |_|\___/_/\_\\__|\__,_|\__,_|_|
+
+ Copyright (c) 2010 - 2015 Codeux Software, LLC & respective contributors.
+        Please see Acknowledgements.pdf for additional information.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Textual and/or "Codeux Software, LLC", nor the 
+      names of its contributors may be used to endorse or promote products 
+      derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+ *********************************************************************** */
+
+
+#import "TextualApplication.h"
+
+typedef enum TLOFormattingSpanType : NSInteger {
+	TLOFormattingBoldSpanType,
+	TLOFormattingItalicSpanType,
+	TLOFormattingUnderlineSpanType,
+	TLOFormattingColorSpanType,
+	TLOFormattingTerminatingSpanType,
+} TLOFormattingSpanType;
+
+typedef struct TLOFormattingSpan {
+	NSRange range; // The formatting characters, including color digits, in the scanned string
+	TLOFormattingSpanType type;
+	NSInteger foregroundColor; // -1 when not specified. Only used by TLOFormattingColorSpanType
+	NSInteger backgroundColor; // -1 when not specified. Only used by TLOFormattingColorSpanType
+} TLOFormattingSpan;
+
+/* TLOFormattingSpanList holds the location of every IRC formatting sequence
+ in a string, found in a single pass. Strings without any formatting are the
+ common case and are recognized without building a list. Control characters
+ are searched for eight at a time where SSE2 is available.
+ 
+ The same list is used to remove formatting from a string and to turn it
+ into the effects applied by TVCLogRenderer, so neither has to parse color
+ sequences on its own. */
+@interface TLOFormattingSpanList : NSObject
+/* Returns nil when string contains no formatting. */
++ (TLOFormattingSpanList *)spanListForString:(NSString *)string;
+
+@property (readonly, copy) NSString *string;
+
+@property (readonly) NSUInteger count;
+
+- (TLOFormattingSpan)spanAtIndex:(NSUInteger)index;
+
+/* string with each span removed. Built once and then reused. */
+@property (readonly, copy) NSString *strippedString;
+@end
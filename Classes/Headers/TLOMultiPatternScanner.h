@@ -0,0 +1,62 @@
+/* ********************************************************************* 
+                  _____         _               _
+                 |_   _|____  _| |_ _   _  __ _| |
+                   | |/ _ \ \/ / __| | | |/ _` | |
+                   | |  __/>  <| |_| |_| | (_| | |
+                   |_|\___/_/\_\\__|\__,_|\__,_|_|
+
+ Copyright (c) 2010 - 2015 Codeux Software, LLC & respective contributors.
+        Please see Acknowledgements.pdf for additional information.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Textual and/or "Codeux Software, LLC", nor the 
+      names of its contributors may be used to endorse or promote products 
+      derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+ *********************************************************************** */
+
+#import "TextualApplication.h"
+
+/* TLOMultiPatternScanner finds every occurrence of any number of patterns in
+ a string in a single pass using an Aho-Corasick automaton. Patterns are
+ matched case-insensitively. Each pattern is added with an object that is
+ handed back when the pattern is found. Objects are compared by pointer. 
+ 
+ Patterns can be added and removed at any time. Failure links are rebuilt
+ lazily the next time a string is scanned after patterns were added. 
+ 
+ The scanner does not check what surrounds a match. A pattern "bob" is
+ reported inside "bobby". It is up to the caller to filter. 
+ 
+ The block given to -enumerateMatchesInString:usingBlock: is called once
+ the string has been scanned, without the scanner being locked. Objects
+ removed from the scanner during enumeration are still reported. */
+@interface TLOMultiPatternScanner : NSObject
+- (void)addPattern:(NSString *)pattern withObject:(id)object; // Replaces the pattern of object if it was already added
+- (void)removeObject:(id)object;
+- (void)removeAllObjects;
+
+@property (readonly) NSUInteger count;
+
+- (void)enumerateMatchesInString:(NSString *)string usingBlock:(void (^)(id object, NSRange range, BOOL *stop))block;
+@end
@@ -261,6 +261,8 @@ typedef enum TXFileTransferIPAddressDetectionMethod : NSInteger {
 
 + (NSString *)fileTransferManuallyEnteredIPAddress;
 
++ (TXUnsignedLongLong)fileTransferMaximumTransferRate; // Bytes per second. 0 means no limit.
+
 + (NSString *)tabCompletionSuffix;
 + (void)setTabCompletionSuffix:(NSString *)value;
 
@@ -311,4 +313,32 @@ typedef enum TXFileTransferIPAddressDetectionMethod : NSInteger {
 
 + (BOOL)textFieldTextReplacement;
 + (void)setTextFieldTextReplacement:(BOOL)value;
+
+/* Values read for every line are kept in an immutable snapshot which is
+ rebuilt when user defaults change. Their accessors above read from it
+ already. Code that reads several of them at once can take the snapshot
+ once and read it directly. */
++ (TPCPreferencesSnapshot *)preferencesSnapshot;
+
++ (void)rebuildPreferencesSnapshot;
+@end
+
+@interface TPCPreferencesSnapshot : NSObject
+@property (readonly) BOOL showJoinLeave;
+@property (readonly) BOOL showInlineImages;
+@property (readonly) BOOL removeAllFormatting;
+@property (readonly) BOOL rightToLeftFormatting;
+@property (readonly) BOOL automaticallyDetectHighlightSpam;
+@property (readonly) BOOL automaticallyFilterUnicodeTextSpam;
+@property (readonly) BOOL conversationTrackingIncludesUserModeSymbol;
+@property (readonly) BOOL disableNicknameColorHashing;
+@property (readonly) BOOL memberListSortFavorsServerStaff;
+@property (readonly) BOOL highlightCurrentNickname;
+@property (readonly) BOOL logHighlights;
+@property (readonly) TXNicknameHighlightMatchType highlightMatchingMethod;
+@property (readonly) NSInteger trackUserAwayStatusMaximumChannelSize;
+@property (readonly) NSInteger inlineImagesMaxWidth;
+@property (readonly) NSInteger inlineImagesMaxHeight;
+@property (readonly, copy) NSString *themeNicknameFormat;
+@property (readonly, copy) NSString *themeTimestampFormat;
 @end
@@ -65,6 +65,8 @@
 
 - (BOOL)highlightAvailable:(BOOL)previous;
 
+- (void)pageInOlderLines; // Restores lines trimmed from the WebView from the scrollback model
+
 @property (readonly, copy) NSString *uniqueIdentifier;
 
 @property (readonly, copy) DOMDocument *mainFrameDocument;
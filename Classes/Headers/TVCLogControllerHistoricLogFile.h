@@ -41,12 +41,12 @@
 @property (nonatomic, weak) TVCLogController *associatedController;
 
 - (void)writeNewEntryForLogLine:(TVCLogLine *)logLine;
-- (void)writeNewEntryWithRawData:(NSData *)jsondata; // Does not automatically append newline.
+- (BOOL)writeNewEntriesForLogLines:(NSArray *)logLines; // Returns NO if any of the entries could not be written
 
 - (void)open;
 - (void)close;
 
 - (void)resetData;
 
-- (NSArray *)listEntriesWithFetchLimit:(NSUInteger)maxEntryCount;
+- (NSArray *)listEntriesWithFetchLimit:(NSUInteger)maxEntryCount; // Array of TVCLogLine, oldest first.
 @end
@@ -40,9 +40,14 @@
 /* No plugins should be accessing this. */
 @class TVCLogControllerOperationItem;
 
-typedef void (^TVCLogControllerOperationBlock)(NSOperation *sender);
+/* The object passed to an operation block responds to -isCancelled. An operation
+ is cancelled when its view controller is cancelled after it was enqueued. */
+typedef void (^TVCLogControllerOperationBlock)(id operation);
 
-@interface TVCLogControllerOperationQueue : NSOperationQueue
+/* Each view controller is given its own first-in, first-out queue. Queues are
+ drained on a small pool of serial dispatch queues shared by every instance of
+ this class. Operations for a view do not run until that view has loaded. */
+@interface TVCLogControllerOperationQueue : NSObject
 /* Add new operations. */
 - (void)enqueueMessageBlock:(TVCLogControllerOperationBlock)callbackBlock for:(TVCLogController *)sender;
 
@@ -56,6 +61,15 @@ typedef void (^TVCLogControllerOperationBlock)(NSOperation *sender);
 
 - (void)cancelOperationsForViewController:(TVCLogController *)controller;
 
+- (void)cancelAllOperations;
+
 /* Update state. */
 - (void)updateReadinessState:(TVCLogController *)controller;
+
+/* Statistics. Latency is the time between an operation being enqueued
+ and it beginning to execute. */
+- (NSInteger)pendingOperationCountForViewController:(TVCLogController *)controller;
+
+- (NSTimeInterval)averageOperationLatencyForViewController:(TVCLogController *)controller;
+- (NSTimeInterval)maximumOperationLatencyForViewController:(TVCLogController *)controller;
 @end
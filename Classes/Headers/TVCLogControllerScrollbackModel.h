@@ -0,0 +1,73 @@
+/* ********************************************************************* 
+                  _____         _               _
+                 |_   _|____  _| |_ _   _  __ _| |
+                   | |/ _ \ \/ / __| | | |/ _` | |
+                   | |  __/>  <| |_| |_| | (_| | |
+                   |_|\___/_/\_\\__|\__,_|\__,_|_|
+
+ Copyright (c) 2010 - 2015 Codeux Software, LLC & respective contributors.
+        Please see Acknowledgements.pdf for additional information.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Textual and/or "Codeux Software, LLC", nor the 
+      names of its contributors may be used to endorse or promote products 
+      derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+ *********************************************************************** */
+
+#import "TextualApplication.h"
+
+/* The scrollback model holds the rendered HTML of the most recent lines of a view
+ in a ring buffer. The WebView only displays a window at the end of the model, and
+ older lines are paged back into it from here. A capacity of zero holds every line.
+
+ Each line is given a sequence number. Appended lines count up from zero. Lines
+ prepended when history is reloaded count down from the oldest line, so they can
+ be negative. The model is meant to be used from the main thread. */
+@interface TVCLogControllerScrollbackModel : NSObject
+- (instancetype)initWithCapacity:(NSInteger)capacity;
+
+@property (nonatomic, assign) NSInteger capacity; // Lowering it discards the oldest lines.
+
+@property (readonly) NSInteger firstSequence; // Oldest line held.
+@property (readonly) NSInteger endSequence; // One past the newest line held.
+
+@property (readonly) NSInteger count;
+
+/* Appending to a full model discards its oldest line. Prepending to
+ a full model does nothing and returns NO. */
+- (void)appendLineNumber:(NSString *)lineNumber html:(NSString *)html highlighted:(BOOL)highlighted;
+- (BOOL)prependLineNumber:(NSString *)lineNumber html:(NSString *)html highlighted:(BOOL)highlighted;
+
+- (void)removeAllLines;
+
+- (NSString *)lineNumberAtSequence:(NSInteger)sequence;
+
+- (NSInteger)sequenceForLineNumber:(NSString *)lineNumber; // NSNotFound if not held.
+
+/* The HTML of every line from startSequence up to but not including endSequence. */
+- (NSString *)htmlFromSequence:(NSInteger)startSequence toSequence:(NSInteger)endSequence;
+
+/* Line numbers of highlighted lines, oldest first. */
+@property (readonly, copy) NSArray *highlightedLineNumbers;
+@end
@@ -96,6 +96,15 @@ typedef enum TVCLogLineMemberType : NSInteger {
 
 @property (readonly, copy) NSData *jsonDictionaryRepresentation;
 
+/* The binary representation is a versioned record used by the historic log archive.
+ Nicknames, commands, and keyword lists are stored as identifiers into a string table
+ shared by every record in the same file. Any definitions the table gains while a line
+ is encoded must be written out by the caller before the record itself. */
+/* Records written as JSON are also accepted by the binary initializer. */
+- (TVCLogLine *)initWithBinaryRepresentation:(NSData *)input stringTable:(TVCLogLineStringTable *)stringTable;
+
+- (NSData *)binaryRepresentationWithStringTable:(TVCLogLineStringTable *)stringTable;
+
 @property (readonly, copy) NSString *formattedTimestamp;
 - (NSString *)formattedTimestampWithForcedFormat:(NSString *)format;
 
@@ -110,3 +119,20 @@ typedef enum TVCLogLineMemberType : NSInteger {
 + (NSString *)lineTypeString:(TVCLogLineType)type;
 + (NSString *)memberTypeString:(TVCLogLineMemberType)type;
 @end
+
+@interface TVCLogLineStringTable : NSObject
+/* Definitions are the serialized form of the table. -pendingDefinitions returns
+ everything added since -markPendingDefinitionsAsWritten was last called so it can
+ be appended to a file. Only mark them written once the file write succeeded. */
+- (NSUInteger)loadDefinitions:(NSData *)definitions; // Returns the length of the definitions that could be loaded
+
+@property (readonly, copy) NSData *pendingDefinitions;
+
+- (void)markPendingDefinitionsAsWritten;
+
+- (uint32_t)identifierForString:(NSString *)string;
+- (uint32_t)identifierForStringArray:(NSArray *)stringArray;
+
+- (NSString *)stringForIdentifier:(uint32_t)identifier;
+- (NSArray *)stringArrayForIdentifier:(uint32_t)identifier;
+@end
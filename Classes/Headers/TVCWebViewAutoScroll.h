@@ -6,6 +6,7 @@
 @property (nonatomic, assign) NSRect lastFrame;
 @property (nonatomic, assign) NSRect lastVisibleRect;
 @property (nonatomic, weak) WebFrameView *webFrame;
+@property (nonatomic, weak) TVCLogController *logController;
 
 @property (readonly) BOOL canScroll;
 
@@ -55,6 +55,7 @@
 
 	/* Class Forwarders. */
 	@class IRCAddressBookEntry;
+	@class IRCAddressBookMatcher;
 	@class IRCChannel;
 	@class IRCChannelConfig;
 	@class IRCChannelMode;
@@ -62,6 +63,7 @@
 	@class IRCClientConfig;
 	@class IRCCommandIndex;
 	@class IRCConnection;
+	@class IRCConnectionLineBuffer;
 	@class IRCExtras;
 	@class IRCISupportInfo;
 	@class IRCMessage;
@@ -70,6 +72,7 @@
 	@class IRCSendingMessage;
 	@class IRCTreeItem;
 	@class IRCUser;
+	@class IRCUserIdentity;
 	@class IRCWorld;
 	@class TDCAboutPanel;
 	@class TDCAddressBookSheet;
@@ -101,12 +104,14 @@
 	@class THOUnicodeHelper;
 	@class TLOEncryptionManager;
 	@class TLOFileLogger;
+	@class TLOFormattingSpanList;
 	@class TLOGrowlController;
 	@class TLOInputHistory;
 	@class TLOInputHistoryObject;
 	@class TLOKeyEventHandler;
 	@class TLOLanguagePreferences;
 	@class TLOLinkParser;
+	@class TLOMultiPatternScanner;
 	@class TLONicknameCompletionStatus;
 	@class TLOpenLink;
 	@class TLOPopupPrompts;
@@ -119,6 +124,7 @@
 	@class TPCPreferences;
 	@class TPCPreferencesCloudSync;
 	@class TPCPreferencesImportExport;
+	@class TPCPreferencesSnapshot;
 	@class TPCPreferencesUserDefaults;
 	@class TPCPreferencesUserDefaultsObjectProxy;
 	@class TPCResourceManager;
@@ -134,8 +140,10 @@
 	@class TVCLogController;
 	@class TVCLogControllerHistoricLogFile;
 	@class TVCLogControllerOperationQueue;
+	@class TVCLogControllerScrollbackModel;
 	@class TVCLogControllerOperationItem;
 	@class TVCLogLine;
+	@class TVCLogLineStringTable;
 	@class TVCLogPolicy;
 	@class TVCLogRenderer;
 	@class TVCLogScriptEventSink;
@@ -257,6 +265,7 @@
 	#import "IRCColorFormat.h"
 	#import "IRCCommandIndex.h"
 	#import "IRCConnection.h"
+	#import "IRCConnectionLineBuffer.h"
 	#import "IRCConnectionSocket.h"
 	#import "IRCExtras.h"
 	#import "IRCISupportInfo.h"
@@ -266,6 +275,7 @@
 	#import "IRCSendingMessage.h"
 	#import "IRCTreeItem.h"
 	#import "IRCUser.h"
+	#import "IRCUserIdentity.h"
 	#import "IRCWorld.h"
 	#import "IRCWorldCloudExtension.h"
 
@@ -310,11 +320,13 @@
 	/* Library. */
 	#import "TLOEncryptionManager.h"
 	#import "TLOFileLogger.h"
+	#import "TLOFormattingSpanList.h"
 	#import "TLOGrowlController.h"
 	#import "TLOInputHistory.h"
 	#import "TLOKeyEventHandler.h"
 	#import "TLOLanguagePreferences.h"
 	#import "TLOLinkParser.h"
+	#import "TLOMultiPatternScanner.h"
 	#import "TLONicknameCompletionStatus.h"
 	#import "TLOPopupPrompts.h"
 	#import "TLOSoundPlayer.h"
@@ -346,6 +358,7 @@
 	#import "TVCLogController.h"
 	#import "TVCLogControllerHistoricLogFile.h"
 	#import "TVCLogControllerOperationQueue.h"
+	#import "TVCLogControllerScrollbackModel.h"
 	#import "TVCLogLine.h"
 	#import "TVCLogPolicy.h"
 	#import "TVCLogRenderer.h"
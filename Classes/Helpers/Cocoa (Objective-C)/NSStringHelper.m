@@ -300,120 +300,13 @@ NSStringEncoding const TXDefaultFallbackStringEncoding		= NSISOLatin1StringEncod
 {
 	NSObjectIsEmptyAssertReturn(self, nil);
 
-	NSInteger pos = 0;
-	NSInteger len = [self length];
-	
-	NSInteger buflen = (len * sizeof(UniChar));
-	
-	UniChar *src = alloca(buflen);
-	UniChar *buf = alloca(buflen);
-	
-	[self getCharacters:src range:NSMakeRange(0, len)];
-	
-	for (NSInteger i = 0; i < len; ++i) {
-		unichar c = src[i];
-		
-		if (c < 0x20) {
-			switch (c) {
-				case IRCTextFormatterBoldEffectCharacter:
-				case 0x16: // Old character used for italic text
-				case IRCTextFormatterItalicEffectCharacter:
-				case IRCTextFormatterUnderlineEffectCharacter:
-				case IRCTextFormatterTerminatingCharacter:
-				{
-					break;
-				}
-				case IRCTextFormatterColorEffectCharacter:
-				{
-					if ((i + 1) >= len) {
-						continue;
-					}
-
-					UniChar d = src[(i + 1)];
-					
-					if (CSCEF_StringIsBase10Numeric(d) == NO) {
-						continue;
-					}
-					
-					i++;
-
-					// ---- //
-					
-					if ((i + 1) >= len) {
-						continue;
-					}
-
-					UniChar e = src[(i + 1)];
-					
-					if (CSCEF_StringIsBase10Numeric(e) == NO && NSDissimilarObjects(e, ',')) {
-						continue;
-					}
-					
-					i++;
-
-					// ---- //
-					
-					if ((e == ',') == NO) {
-						if ((i + 1) >= len) {
-							continue;
-						}
-						
-						UniChar f = src[(i + 1)];
-						
-						if (NSDissimilarObjects(f, ',')) {
-							continue;
-						}
-						
-						i++;
-					}
-
-					// ---- //
-
-					if ((i + 1) >= len) {
-						continue;
-					}
-
-					UniChar g = src[(i + 1)];
-
-					if (CSCEF_StringIsBase10Numeric(g) == NO) {
-						i--;
-						
-						continue;
-					}
-					
-					i++;
-
-					// ---- //
-
-					if ((i + 1) >= len) {
-						continue;
-					}
-
-					UniChar h = src[(i + 1)];
-
-					if (CSCEF_StringIsBase10Numeric(h) == NO) {
-						continue;
-					}
-					
-					i++;
-
-					// ---- //
-					
-					break;
-				}
-				default:
-				{
-					buf[pos++] = c;
-					
-					break;
-				}
-			}
-		} else {
-			buf[pos++] = c;
-		}
+	TLOFormattingSpanList *spanList = [TLOFormattingSpanList spanListForString:self];
+
+	if (spanList == nil) {
+		return [self copy];
 	}
-	
-	return [NSString stringWithCharacters:buf length:pos];
+
+	return [spanList strippedString];
 }
 
 - (NSString *)base64EncodingWithLineLength:(NSUInteger)lineLength
@@ -38,6 +38,10 @@
 
 #import "TextualApplication.h"
 
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
 static NSUInteger TABLE1[] = {
 	9,
 	0x00aa, 0x00aa,
@@ -477,4 +481,186 @@ static NSUInteger OTHERS_TABLE[] = {
 	return NO;
 }
 
+#pragma mark -
+#pragma mark Decoding
+
+/* Returns the offset of the first byte with the high bit set, or length if
+ there is none. Sixteen bytes are checked at a time where SSE2 is available
+ and eight at a time otherwise. */
+static NSUInteger THOUnicodeSkipASCII(const unsigned char *bytes, NSUInteger offset, NSUInteger length)
+{
+#if defined(__SSE2__)
+	while ((offset + 16) <= length) {
+		__m128i chunk = _mm_loadu_si128((const __m128i *)(bytes + offset));
+
+		int highBits = _mm_movemask_epi8(chunk);
+
+		if (highBits) {
+			return (offset + __builtin_ctz(highBits));
+		}
+
+		offset += 16;
+	}
+#endif
+
+	while ((offset + 8) <= length) {
+		uint64_t chunk;
+
+		memcpy(&chunk, (bytes + offset), 8);
+
+		if (chunk & 0x8080808080808080ULL) {
+			break;
+		}
+
+		offset += 8;
+	}
+
+	while (offset < length && bytes[offset] < 0x80) {
+		offset += 1;
+	}
+
+	return offset;
+}
+
++ (THOUnicodeByteSequenceType)typeOfByteSequence:(const char *)bytes length:(NSUInteger)length
+{
+	const unsigned char *b = (const unsigned char *)bytes;
+
+	NSUInteger offset = THOUnicodeSkipASCII(b, 0, length);
+
+	if (offset == length) {
+		return THOUnicodeASCIIByteSequenceType;
+	}
+
+	/* Validate the remainder. Overlong forms, surrogates, and code
+	 points above U+10FFFF are rejected, as they are by NSString. */
+	while (offset < length) {
+		unsigned char c = b[offset];
+
+		if (c < 0x80) {
+			offset = THOUnicodeSkipASCII(b, offset, length);
+
+			continue;
+		}
+
+		NSUInteger sequenceLength = 0;
+
+		unsigned char lowerBound = 0x80;
+		unsigned char upperBound = 0xBF;
+
+		if (c >= 0xC2 && c <= 0xDF) {
+			sequenceLength = 2;
+		} else if (c >= 0xE0 && c <= 0xEF) {
+			sequenceLength = 3;
+
+			if (c == 0xE0) {
+				lowerBound = 0xA0;
+			} else if (c == 0xED) {
+				upperBound = 0x9F;
+			}
+		} else if (c >= 0xF0 && c <= 0xF4) {
+			sequenceLength = 4;
+
+			if (c == 0xF0) {
+				lowerBound = 0x90;
+			} else if (c == 0xF4) {
+				upperBound = 0x8F;
+			}
+		} else {
+			return THOUnicodeUnknownByteSequenceType;
+		}
+
+		if ((offset + sequenceLength) > length) {
+			return THOUnicodeUnknownByteSequenceType;
+		}
+
+		/* Only the first continuation byte has a narrowed range. */
+		if (b[(offset + 1)] < lowerBound || b[(offset + 1)] > upperBound) {
+			return THOUnicodeUnknownByteSequenceType;
+		}
+
+		for (NSUInteger i = 2; i < sequenceLength; i++) {
+			if ((b[(offset + i)] & 0xC0) != 0x80) {
+				return THOUnicodeUnknownByteSequenceType;
+			}
+		}
+
+		offset += sequenceLength;
+	}
+
+	return THOUnicodeUTF8ByteSequenceType;
+}
+
++ (BOOL)encodingIsASCIICompatible:(NSStringEncoding)encoding
+{
+	/* Encodings where bytes below 0x80 always mean the same as in ASCII.
+	 Others, such as ISO-2022-JP, give meaning to ASCII escape sequences. */
+	switch (encoding) {
+		case NSASCIIStringEncoding:
+		case NSUTF8StringEncoding:
+		case NSISOLatin1StringEncoding:
+		case NSISOLatin2StringEncoding:
+		case NSWindowsCP1250StringEncoding:
+		case NSWindowsCP1251StringEncoding:
+		case NSWindowsCP1252StringEncoding:
+		case NSWindowsCP1253StringEncoding:
+		case NSWindowsCP1254StringEncoding:
+		case NSMacOSRomanStringEncoding:
+		{
+			return YES;
+		}
+		default:
+		{
+			return NO;
+		}
+	}
+}
+
++ (NSString *)stringWithBytes:(const char *)bytes length:(NSUInteger)length primaryEncoding:(NSStringEncoding)primaryEncoding fallbackEncoding:(NSStringEncoding)fallbackEncoding
+{
+	NSString *s = nil;
+
+	if ([THOUnicodeHelper encodingIsASCIICompatible:primaryEncoding]) {
+		THOUnicodeByteSequenceType sequenceType = [THOUnicodeHelper typeOfByteSequence:bytes length:length];
+
+		/* Every compatible encoding decodes ASCII the same way and ASCII
+		 is stored by NSString as is, without being converted to UTF-16. */
+		if (sequenceType == THOUnicodeASCIIByteSequenceType) {
+			return [NSString stringWithBytes:bytes length:length encoding:NSASCIIStringEncoding];
+		}
+
+		/* A UTF-8 primary encoding is only attempted when it will succeed. */
+		if (primaryEncoding == NSUTF8StringEncoding) {
+			if (sequenceType == THOUnicodeUTF8ByteSequenceType) {
+				s = [NSString stringWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+			}
+		} else {
+			s = [NSString stringWithBytes:bytes length:length encoding:primaryEncoding];
+		}
+
+		if (s == nil) {
+			if (fallbackEncoding == NSUTF8StringEncoding && NSDissimilarObjects(sequenceType, THOUnicodeUTF8ByteSequenceType)) {
+				return nil; // Neither encoding can decode these bytes and they are not ASCII.
+			}
+
+			s = [NSString stringWithBytes:bytes length:length encoding:fallbackEncoding];
+		}
+
+		return s;
+	}
+
+	/* Encodings that are not ASCII compatible are tried in turn. */
+	s = [NSString stringWithBytes:bytes length:length encoding:primaryEncoding];
+
+	if (s == nil) {
+		s = [NSString stringWithBytes:bytes length:length encoding:fallbackEncoding];
+
+		if (s == nil) {
+			s = [NSString stringWithBytes:bytes length:length encoding:NSASCIIStringEncoding];
+		}
+	}
+
+	return s;
+}
+
 @end
@@ -209,6 +209,57 @@ NSString * const IRCAddressBookDictionaryValueTrackUserActivityKey				= @"trackU
 	return NO;
 }
 
+- (IRCAddressBookIgnoreFlags)ignoreFlags
+{
+	IRCAddressBookIgnoreFlags flags = IRCAddressBookNoIgnoreFlags;
+
+	if (self.ignoreNoticeMessages)				flags |= IRCAddressBookIgnoreNoticeMessagesFlag;
+	if (self.ignorePublicMessages)				flags |= IRCAddressBookIgnorePublicMessagesFlag;
+	if (self.ignorePublicMessageHighlights)		flags |= IRCAddressBookIgnorePublicMessageHighlightsFlag;
+	if (self.ignorePrivateMessages)				flags |= IRCAddressBookIgnorePrivateMessagesFlag;
+	if (self.ignorePrivateMessageHighlights)	flags |= IRCAddressBookIgnorePrivateMessageHighlightsFlag;
+	if (self.ignoreGeneralEventMessages)		flags |= IRCAddressBookIgnoreGeneralEventMessagesFlag;
+	if (self.ignoreFileTransferRequests)		flags |= IRCAddressBookIgnoreFileTransferRequestsFlag;
+	if (self.ignoreMessagesContainingMatchh)	flags |= IRCAddressBookIgnoreMessagesContainingMatchFlag;
+	if (self.ignoreClientToClientProtocol)		flags |= IRCAddressBookIgnoreClientToClientProtocolFlag;
+	if (self.trackUserActivity)					flags |= IRCAddressBookTrackUserActivityFlag;
+
+	return flags;
+}
+
++ (IRCAddressBookIgnoreFlags)ignoreFlagsForDictionaryValueKeys:(NSArray *)keys
+{
+	static NSDictionary *flagsForKeys = nil;
+
+	static dispatch_once_t onceToken;
+
+	dispatch_once(&onceToken, ^{
+		flagsForKeys = @{
+			IRCAddressBookDictionaryValueIgnoreNoticeMessagesKey				: @(IRCAddressBookIgnoreNoticeMessagesFlag),
+			IRCAddressBookDictionaryValueIgnorePublicMessagesKey				: @(IRCAddressBookIgnorePublicMessagesFlag),
+			IRCAddressBookDictionaryValueIgnorePublicMessageHighlightsKey		: @(IRCAddressBookIgnorePublicMessageHighlightsFlag),
+			IRCAddressBookDictionaryValueIgnorePrivateMessagesKey				: @(IRCAddressBookIgnorePrivateMessagesFlag),
+			IRCAddressBookDictionaryValueIgnorePrivateMessageHighlightsKey		: @(IRCAddressBookIgnorePrivateMessageHighlightsFlag),
+			IRCAddressBookDictionaryValueIgnoreGeneralEventMessagesKey			: @(IRCAddressBookIgnoreGeneralEventMessagesFlag),
+			IRCAddressBookDictionaryValueIgnoreFileTransferRequestsKey			: @(IRCAddressBookIgnoreFileTransferRequestsFlag),
+			IRCAddressBookDictionaryValueIgnoreMessagesContainingMatchKey		: @(IRCAddressBookIgnoreMessagesContainingMatchFlag),
+			IRCAddressBookDictionaryValueIgnoreClientToClientProtocolKey		: @(IRCAddressBookIgnoreClientToClientProtocolFlag),
+			IRCAddressBookDictionaryValueTrackUserActivityKey					: @(IRCAddressBookTrackUserActivityFlag),
+
+			/* Legacy name of IRCAddressBookDictionaryValueIgnoreMessagesContainingMatchKey */
+			@"hideMessagesContainingMatch"										: @(IRCAddressBookIgnoreMessagesContainingMatchFlag)
+		};
+	});
+
+	IRCAddressBookIgnoreFlags flags = IRCAddressBookNoIgnoreFlags;
+
+	for (NSString *key in keys) {
+		flags |= [flagsForKeys[key] unsignedIntegerValue];
+	}
+
+	return flags;
+}
+
 - (NSString *)trackingNickname
 {
 	NSString *nickname = [self.hostmask nicknameFromHostmask];
@@ -294,3 +345,410 @@ NSString * const IRCAddressBookDictionaryValueTrackUserActivityKey				= @"trackU
 }
 
 @end
+
+#pragma mark -
+
+#define _hostmaskStackBufferLength			512
+
+typedef struct IRCAddressBookPattern {
+	unichar *characters; // Folded to lowercase
+	NSUInteger length;
+	NSUInteger prefixLength; // Characters before the first wildcard
+	NSUInteger entryIndex;
+	IRCAddressBookIgnoreFlags flags;
+	NSUInteger hash; // Only computed for patterns without wildcards
+	NSUInteger nextPatternInNode; // Index + 1 of the next pattern stored in the same trie node
+} IRCAddressBookPattern;
+
+typedef struct IRCAddressBookTrieNode {
+	unichar character;
+	NSUInteger firstChild; // Index of first child; 0 = none (the root is never a child)
+	NSUInteger nextSibling; // Index of next sibling; 0 = none
+	NSUInteger firstPattern; // Index + 1 of first pattern ending its prefix here; 0 = none
+} IRCAddressBookTrieNode;
+
+static NSUInteger _foldedCharactersHash(const unichar *characters, NSUInteger length)
+{
+	/* FNV-1a */
+	NSUInteger hash = 2166136261U;
+
+	for (NSUInteger i = 0; i < length; i++) {
+		hash ^= characters[i];
+
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static BOOL _foldCharacters(unichar *characters, NSUInteger length)
+{
+	/* Returns NO if a character outside of ASCII is found. Those
+	 are left for -lowercaseString which is much more expensive. */
+	for (NSUInteger i = 0; i < length; i++) {
+		unichar c = characters[i];
+
+		if (c >= 'A' && c <= 'Z') {
+			characters[i] = (c + ('a' - 'A'));
+		} else if (c > 0x7F) {
+			return NO;
+		}
+	}
+
+	return YES;
+}
+
+static BOOL _globMatch(const unichar *pattern, NSUInteger patternLength, const unichar *string, NSUInteger stringLength)
+{
+	/* * matches any sequence of characters and ? matches a single character.
+	 On a mismatch, backtrack to the last * and let it consume one more
+	 character. This never allocates and never recurses. */
+	NSUInteger p = 0;
+	NSUInteger s = 0;
+
+	NSUInteger starPattern = NSNotFound;
+	NSUInteger starString = 0;
+
+	while (s < stringLength) {
+		if (p < patternLength && (pattern[p] == '?' || pattern[p] == string[s])) {
+			p++;
+			s++;
+		} else if (p < patternLength && pattern[p] == '*') {
+			starPattern = p;
+			starString = s;
+
+			p++;
+		} else if (starPattern != NSNotFound) {
+			p = (starPattern + 1);
+
+			starString++;
+
+			s = starString;
+		} else {
+			return NO;
+		}
+	}
+
+	while (p < patternLength && pattern[p] == '*') {
+		p++;
+	}
+
+	return (p == patternLength);
+}
+
+static void _recordMatch(IRCAddressBookPattern *pattern, IRCAddressBookIgnoreFlags flags, IRCAddressBookIgnoreFlags *matchedFlags, NSUInteger *matchedEntryIndex)
+{
+	if ((pattern->flags & flags) == IRCAddressBookNoIgnoreFlags) {
+		return;
+	}
+
+	*matchedFlags |= (pattern->flags & flags);
+
+	if (*matchedEntryIndex == NSNotFound || pattern->entryIndex < *matchedEntryIndex) {
+		*matchedEntryIndex = pattern->entryIndex;
+	}
+}
+
+@implementation IRCAddressBookMatcher
+{
+	IRCAddressBookPattern *_patterns;
+	NSUInteger _patternCount;
+
+	IRCAddressBookTrieNode *_trieNodes;
+	NSUInteger _trieNodeCount;
+	NSUInteger _trieNodeCapacity;
+
+	NSUInteger *_exactTable; // Index + 1 of pattern; 0 = empty slot
+	NSUInteger _exactTableMask;
+}
+
+- (instancetype)initWithEntries:(NSArray *)entries
+{
+	if ((self = [super init])) {
+		_entries = [entries copy];
+
+		[self compile];
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	for (NSUInteger i = 0; i < _patternCount; i++) {
+		free(_patterns[i].characters);
+	}
+
+	free(_patterns);
+	free(_trieNodes);
+	free(_exactTable);
+}
+
+#pragma mark -
+#pragma mark Compiling
+
+- (NSString *)patternForEntry:(IRCAddressBookEntry *)entry
+{
+	NSString *hostmask = [entry hostmask];
+
+	NSObjectIsEmptyAssertReturn(hostmask, nil);
+
+	/* User tracking entries only define a nickname. */
+	if ([entry entryType] == IRCAddressBookUserTrackingEntryType) {
+		return [hostmask stringByAppendingString:@"!*@*"];
+	} else {
+		return hostmask;
+	}
+}
+
+- (NSUInteger)addTrieNodeWithCharacter:(unichar)character
+{
+	if (_trieNodeCount == _trieNodeCapacity) {
+		_trieNodeCapacity = MAX(32, (_trieNodeCapacity * 2));
+
+		_trieNodes = realloc(_trieNodes, (sizeof(IRCAddressBookTrieNode) * _trieNodeCapacity));
+	}
+
+	_trieNodes[_trieNodeCount] = (IRCAddressBookTrieNode){character, 0, 0, 0};
+
+	return _trieNodeCount++;
+}
+
+- (void)insertPatternAtIndex:(NSUInteger)patternIndex
+{
+	IRCAddressBookPattern *pattern = &_patterns[patternIndex];
+
+	NSUInteger nodeIndex = 0; // Root
+
+	for (NSUInteger i = 0; i < pattern->prefixLength; i++) {
+		unichar c = pattern->characters[i];
+
+		NSUInteger childIndex = _trieNodes[nodeIndex].firstChild;
+
+		while (childIndex > 0 && _trieNodes[childIndex].character != c) {
+			childIndex = _trieNodes[childIndex].nextSibling;
+		}
+
+		if (childIndex == 0) {
+			childIndex = [self addTrieNodeWithCharacter:c];
+
+			/* _trieNodes may have moved. */
+			_trieNodes[childIndex].nextSibling = _trieNodes[nodeIndex].firstChild;
+
+			_trieNodes[nodeIndex].firstChild = childIndex;
+		}
+
+		nodeIndex = childIndex;
+	}
+
+	pattern->nextPatternInNode = _trieNodes[nodeIndex].firstPattern;
+
+	_trieNodes[nodeIndex].firstPattern = (patternIndex + 1);
+}
+
+- (void)insertExactPatternAtIndex:(NSUInteger)patternIndex
+{
+	NSUInteger slot = (_patterns[patternIndex].hash & _exactTableMask);
+
+	while (_exactTable[slot] > 0) {
+		slot = ((slot + 1) & _exactTableMask);
+	}
+
+	_exactTable[slot] = (patternIndex + 1);
+}
+
+- (void)compile
+{
+	NSObjectIsEmptyAssert(_entries);
+
+	NSUInteger entryCount = [_entries count];
+
+	_patterns = calloc(entryCount, sizeof(IRCAddressBookPattern));
+
+	NSUInteger exactPatternCount = 0;
+
+	for (NSUInteger i = 0; i < entryCount; i++) {
+		IRCAddressBookEntry *entry = _entries[i];
+
+		IRCAddressBookIgnoreFlags flags = [entry ignoreFlags];
+
+		if (flags == IRCAddressBookNoIgnoreFlags) {
+			continue;
+		}
+
+		NSString *patternString = [[self patternForEntry:entry] lowercaseString];
+
+		NSObjectIsEmptyAssertLoopContinue(patternString);
+
+		NSUInteger patternLength = [patternString length];
+
+		unichar *characters = malloc(sizeof(unichar) * patternLength);
+
+		[patternString getCharacters:characters range:NSMakeRange(0, patternLength)];
+
+		NSUInteger prefixLength = 0;
+
+		while (prefixLength < patternLength &&
+			   characters[prefixLength] != '*' &&
+			   characters[prefixLength] != '?')
+		{
+			prefixLength++;
+		}
+
+		IRCAddressBookPattern *pattern = &_patterns[_patternCount];
+
+		pattern->characters = characters;
+		pattern->length = patternLength;
+		pattern->prefixLength = prefixLength;
+		pattern->entryIndex = i;
+		pattern->flags = flags;
+
+		if (prefixLength == patternLength) {
+			pattern->hash = _foldedCharactersHash(characters, patternLength);
+
+			exactPatternCount += 1;
+		}
+
+		_patternCount += 1;
+	}
+
+	/* Exact table is kept at most half full. */
+	NSUInteger exactTableCapacity = 8;
+
+	while (exactTableCapacity < (exactPatternCount * 2)) {
+		exactTableCapacity *= 2;
+	}
+
+	_exactTable = calloc(exactTableCapacity, sizeof(NSUInteger));
+
+	_exactTableMask = (exactTableCapacity - 1);
+
+	(void)[self addTrieNodeWithCharacter:0]; // Root
+
+	for (NSUInteger i = 0; i < _patternCount; i++) {
+		if (_patterns[i].prefixLength == _patterns[i].length) {
+			[self insertExactPatternAtIndex:i];
+		} else {
+			[self insertPatternAtIndex:i];
+		}
+	}
+}
+
+#pragma mark -
+#pragma mark Matching
+
+- (IRCAddressBookIgnoreFlags)matchHostmask:(NSString *)hostmask withFlags:(IRCAddressBookIgnoreFlags)flags matchedEntry:(IRCAddressBookEntry **)matchedEntry
+{
+	if (matchedEntry) {
+		*matchedEntry = nil;
+	}
+
+	NSObjectIsEmptyAssertReturn(hostmask, IRCAddressBookNoIgnoreFlags);
+
+	if (_patternCount == 0 || flags == IRCAddressBookNoIgnoreFlags) {
+		return IRCAddressBookNoIgnoreFlags;
+	}
+
+	NSUInteger hostmaskLength = [hostmask length];
+
+	unichar stackBuffer[_hostmaskStackBufferLength];
+
+	unichar *characters = stackBuffer;
+
+	if (hostmaskLength > _hostmaskStackBufferLength) {
+		characters = malloc(sizeof(unichar) * hostmaskLength);
+	}
+
+	[hostmask getCharacters:characters range:NSMakeRange(0, hostmaskLength)];
+
+	if (_foldCharacters(characters, hostmaskLength) == NO) {
+		/* Lowercasing outside of ASCII may change the length. */
+		NSString *lowercaseHostmask = [hostmask lowercaseString];
+
+		if (NSDissimilarObjects([lowercaseHostmask length], hostmaskLength)) {
+			if (characters != stackBuffer) {
+				free(characters);
+			}
+
+			return [self matchHostmask:lowercaseHostmask withFlags:flags matchedEntry:matchedEntry];
+		}
+
+		[lowercaseHostmask getCharacters:characters range:NSMakeRange(0, hostmaskLength)];
+	}
+
+	IRCAddressBookIgnoreFlags matchedFlags = IRCAddressBookNoIgnoreFlags;
+
+	NSUInteger matchedEntryIndex = NSNotFound;
+
+	/* Hostmasks without wildcards. */
+	NSUInteger hash = _foldedCharactersHash(characters, hostmaskLength);
+
+	NSUInteger slot = (hash & _exactTableMask);
+
+	while (_exactTable[slot] > 0) {
+		IRCAddressBookPattern *pattern = &_patterns[_exactTable[slot] - 1];
+
+		if (pattern->hash == hash &&
+			pattern->length == hostmaskLength &&
+			memcmp(pattern->characters, characters, (sizeof(unichar) * hostmaskLength)) == 0)
+		{
+			_recordMatch(pattern, flags, &matchedFlags, &matchedEntryIndex);
+		}
+
+		slot = ((slot + 1) & _exactTableMask);
+	}
+
+	/* Walk the trie along the hostmask. Every node reached has a fixed
+	 prefix which matches so only the rest of its patterns are tested. */
+	NSUInteger nodeIndex = 0;
+
+	NSUInteger depth = 0;
+
+	while (1) {
+		NSUInteger patternIndex = _trieNodes[nodeIndex].firstPattern;
+
+		while (patternIndex > 0) {
+			IRCAddressBookPattern *pattern = &_patterns[patternIndex - 1];
+
+			if (pattern->flags & flags) {
+				if (_globMatch((pattern->characters + depth), (pattern->length - depth),
+							   (characters + depth), (hostmaskLength - depth)))
+				{
+					_recordMatch(pattern, flags, &matchedFlags, &matchedEntryIndex);
+				}
+			}
+
+			patternIndex = pattern->nextPatternInNode;
+		}
+
+		if (depth == hostmaskLength) {
+			break;
+		}
+
+		NSUInteger childIndex = _trieNodes[nodeIndex].firstChild;
+
+		while (childIndex > 0 && _trieNodes[childIndex].character != characters[depth]) {
+			childIndex = _trieNodes[childIndex].nextSibling;
+		}
+
+		if (childIndex == 0) {
+			break;
+		}
+
+		nodeIndex = childIndex;
+
+		depth += 1;
+	}
+
+	if (characters != stackBuffer) {
+		free(characters);
+	}
+
+	if (matchedEntry && NSDissimilarObjects(matchedEntryIndex, NSNotFound)) {
+		*matchedEntry = _entries[matchedEntryIndex];
+	}
+
+	return matchedFlags;
+}
+
+@end
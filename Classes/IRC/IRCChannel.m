@@ -60,6 +60,19 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
  NSMutableArray by itself is not thread safe. */
 @property (nonatomic, strong) NSMutableArray *memberListLengthSortedContainer;
 
+/* memberListNicknameIndex maps the nickname of each member, folded using the casemapping
+ of the server, to the instance of IRCUser stored in the two sorted containers. Lookups
+ go through this index instead of scanning the containers. Same rules apply about access. */
+@property (nonatomic, strong) NSMutableDictionary *memberListNicknameIndex;
+
+/* memberListScanner is an automaton of the nicknames of all members used by
+ TVCLogRenderer to find mentions of them. It is thread safe by itself. */
+@property (nonatomic, strong) TLOMultiPatternScanner *memberListScanner;
+
+/* namesReplyStagingArea holds members received in NAMES replies until the
+ end of the reply so that the member list is only rebuilt once. */
+@property (nonatomic, strong) NSMutableArray *namesReplyStagingArea;
+
 /* Misc. private properties. */
 @property (nonatomic, strong) TLOFileLogger *logFile;
 @end
@@ -74,6 +87,12 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 	if ((self = [super init])) {
 		self.memberListStandardSortedContainer = [NSMutableArray array];
 		self.memberListLengthSortedContainer = [NSMutableArray array];
+
+		self.memberListNicknameIndex = [NSMutableDictionary dictionary];
+
+		self.namesReplyStagingArea = [NSMutableArray array];
+
+		self.memberListScanner = [TLOMultiPatternScanner new];
 	}
 	
 	return self;
@@ -111,8 +130,14 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 	if (seed) {
 		NSAssertReturn([seed isEqualToChannelConfiguration:self.config] == NO);
 
+		BOOL nameChanged = NSObjectsAreEqual([seed channelName], [self.config channelName]) == NO;
+
 		[self setConfig:seed]; // Value is copied on assign.
 
+		if (nameChanged) {
+			[self.associatedClient rebuildChannelNameIndex];
+		}
+
 		[self.config writeKeychainItemsToDisk];
 
 		if (updateStoredChannelList) {
@@ -195,6 +220,8 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 - (void)setName:(NSString *)value
 {
 	[self.config setChannelName:value];
+
+	[self.associatedClient rebuildChannelNameIndex];
 }
 
 - (void)setTopic:(NSString *)topic
@@ -420,9 +447,68 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 #pragma mark -
 #pragma mark Member List
 
+- (NSString *)_memberListIndexKeyForNickname:(NSString *)nickname
+{
+	IRCISupportInfo *supportInfo = [self.associatedClient supportInfo];
+
+	if (supportInfo) {
+		return [supportInfo caseMappedNickname:nickname];
+	} else {
+		return [nickname lowercaseString];
+	}
+}
+
+- (NSUInteger)_indexOfMember:(IRCUser *)user inSortedList:(NSArray *)memberList usingComparator:(NSComparator)comparator
+{
+	/* The sort keys of a member are normally unchanged since it was inserted
+	 so a binary search lands on it. A member modified in place before being
+	 removed (or a change to the sort preferences) is caught by falling back
+	 to an identity scan of the list. */
+	NSUInteger memberCount = [memberList count];
+
+	NSUInteger searchIndex = [memberList indexOfObject:user
+										 inSortedRange:NSMakeRange(0, memberCount)
+											   options:NSBinarySearchingFirstEqual
+									   usingComparator:comparator];
+
+	if (NSDissimilarObjects(searchIndex, NSNotFound)) {
+		for (NSUInteger i = searchIndex; i < memberCount; i++) {
+			IRCUser *matchedUser = memberList[i];
+
+			if (matchedUser == user) {
+				return i;
+			} else if (comparator(matchedUser, user) != NSOrderedSame) {
+				break;
+			}
+		}
+	}
+
+	return [memberList indexOfObjectIdenticalTo:user];
+}
+
 - (NSInteger)_sortedInsert:(IRCUser *)item
 {
 	NSInteger insertedIndex = 0;
+
+	/* A member with the same nickname would leave an entry in the
+	 sorted containers that the index no longer points to. */
+	NSString *indexKey = [self _memberListIndexKeyForNickname:[item nickname]];
+
+	if (indexKey) {
+		IRCUser *existingUser = nil;
+
+		@synchronized(self.memberListNicknameIndex) {
+			existingUser = self.memberListNicknameIndex[indexKey];
+
+			self.memberListNicknameIndex[indexKey] = item;
+		}
+
+		[self.associatedClient noteMember:item withIndexKey:indexKey wasAddedToChannel:self];
+
+		if (existingUser) {
+			[self _removeIndexedMember:existingUser];
+		}
+	}
 	
 	/* Insert into normal list and maybe tree view. */
 	@synchronized(self.memberListStandardSortedContainer) {
@@ -433,6 +519,8 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 	@synchronized(self.memberListLengthSortedContainer) {
 		(void)[self.memberListLengthSortedContainer insertSortedObject:item usingComparator:[IRCUser nicknameLengthComparator]];
 	}
+
+	[self.memberListScanner addPattern:[item nickname] withObject:item];
 	
 	return insertedIndex;
 }
@@ -454,17 +542,38 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 }
 
 - (void)_removeMemberWithNickname:(NSString *)nickname
+{
+	NSString *indexKey = [self _memberListIndexKeyForNickname:nickname];
+
+	PointerIsEmptyAssert(indexKey);
+
+	/* Remove from index. */
+	IRCUser *matchedUser = nil;
+
+	@synchronized(self.memberListNicknameIndex) {
+		matchedUser = self.memberListNicknameIndex[indexKey];
+
+		if (matchedUser) {
+			[self.memberListNicknameIndex removeObjectForKey:indexKey];
+		}
+	}
+
+	PointerIsEmptyAssert(matchedUser);
+
+	[self.associatedClient noteMemberWithIndexKey:indexKey wasRemovedFromChannel:self];
+
+	[self _removeIndexedMember:matchedUser];
+}
+
+- (void)_removeIndexedMember:(IRCUser *)matchedUser
 {
 	/* Find in normal member list. */
 	/* This also removes matched user from tree view. */
 	@synchronized(self.memberListStandardSortedContainer) {
 		/* Remove from internal list. */
-		NSInteger crmi = [self indexOfMember:nickname options:NSCaseInsensitiveSearch inList:self.memberListStandardSortedContainer];
+		NSUInteger crmi = [self _indexOfMember:matchedUser inSortedList:self.memberListStandardSortedContainer usingComparator:NSDefaultComparator];
 		
 		if (NSDissimilarObjects(crmi, NSNotFound)) {
-			/* Get matched user. */
-			IRCUser *matchedUser = self.memberListStandardSortedContainer[crmi];
-			
 			/* Maybe remove from tree view. */
 			XRPerformBlockSynchronouslyOnMainQueue(^{
 				[self _removeMemberFromTreeView:matchedUser];
@@ -477,12 +586,14 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 	
 	/* Find in alternate list. */
 	@synchronized(self.memberListLengthSortedContainer) {
-		NSInteger crmi = [self indexOfMember:nickname options:NSCaseInsensitiveSearch inList:self.memberListLengthSortedContainer];
+		NSUInteger crmi = [self _indexOfMember:matchedUser inSortedList:self.memberListLengthSortedContainer usingComparator:[IRCUser nicknameLengthComparator]];
 		
 		if (NSDissimilarObjects(crmi, NSNotFound)) {
 			[self.memberListLengthSortedContainer removeObjectAtIndex:crmi];
 		}
 	}
+
+	[self.memberListScanner removeObject:matchedUser];
 }
 
 - (void)_removeMember:(IRCUser *)user
@@ -517,6 +628,8 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 	
 	XRPerformBlockOnSharedMutableSynchronizationDispatchQueue(^{
 		[self _removeMemberWithNickname:nickname];
+
+		[self _removeStagedMemberWithNickname:nickname];
 	});
 	
 	XRPerformBlockSynchronouslyOnMainQueue(^{
@@ -547,6 +660,10 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 			/* Insert new copy of user. */
 			insertedIndex = [self _sortedInsert:user];
 		}
+
+		/* A user that changes their nickname while a NAMES reply is
+		 still being received has to be renamed there as well. */
+		[self _renameStagedMember:fromNickname to:toNickname];
 	});
 	
 	/* Update the actual member list view. */
@@ -605,32 +722,34 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 
 		IRCISupportInfo *supportInfo = [[self associatedClient] supportInfo];
 
-		NSInteger rankOfNewMode = [supportInfo rankForUserPrefixWithMode:mode];
+		unichar modeCharacter = [mode characterAtIndex:0];
+
+		NSInteger rankOfNewMode = [supportInfo rankForUserPrefixModeCharacter:modeCharacter];
 
 		NSMutableString *newModeValues = [NSMutableString string];
 
 		for (NSInteger i = 0; i < [existingModeValues length]; i++) {
-			NSString *cc = [existingModeValues stringCharacterAtIndex:i];
+			unichar cc = [existingModeValues characterAtIndex:i];
 
 			if (value == NO) {
 				/* If we are unsetting a mode value, then all we have to 
 				 do is skip over the existing mode, if it exists at all. */
 
-				if (NSObjectsAreEqual(cc, mode)) {
+				if (cc == modeCharacter) {
 					continue;
 				} else {
-					[newModeValues appendString:cc];
+					[newModeValues appendFormat:@"%C", cc];
 				}
 			} else {
 				/* When setting a mode, we have to insert it into our
 				 string into its correct rank. */
-				NSInteger rankOfCurrentMode = [supportInfo rankForUserPrefixWithMode:cc];
+				NSInteger rankOfCurrentMode = [supportInfo rankForUserPrefixModeCharacter:cc];
 
 				if (rankOfNewMode > rankOfCurrentMode) {
 					[newModeValues appendString:mode];
 				}
 
-				[newModeValues appendString:cc];
+				[newModeValues appendFormat:@"%C", cc];
 			}
 		}
 
@@ -692,6 +811,134 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 		@synchronized(self.memberListLengthSortedContainer) {
 			[self.memberListLengthSortedContainer removeAllObjects];
 		}
+
+		@synchronized(self.memberListNicknameIndex) {
+			for (NSString *indexKey in self.memberListNicknameIndex) {
+				[self.associatedClient noteMemberWithIndexKey:indexKey wasRemovedFromChannel:self];
+			}
+
+			[self.memberListNicknameIndex removeAllObjects];
+		}
+
+		@synchronized(self.namesReplyStagingArea) {
+			[self.namesReplyStagingArea removeAllObjects];
+		}
+
+		[self.memberListScanner removeAllObjects];
+	});
+}
+
+- (void)_removeStagedMemberWithNickname:(NSString *)nickname
+{
+	NSString *indexKey = [self _memberListIndexKeyForNickname:nickname];
+
+	@synchronized(self.namesReplyStagingArea) {
+		NSIndexSet *matchedIndexes = [self.namesReplyStagingArea indexesOfObjectsPassingTest:^BOOL(IRCUser *user, NSUInteger idx, BOOL *stop) {
+			return NSObjectsAreEqual([self _memberListIndexKeyForNickname:[user nickname]], indexKey);
+		}];
+
+		[self.namesReplyStagingArea removeObjectsAtIndexes:matchedIndexes];
+	}
+}
+
+- (void)_renameStagedMember:(NSString *)fromNickname to:(NSString *)toNickname
+{
+	NSString *indexKey = [self _memberListIndexKeyForNickname:fromNickname];
+
+	@synchronized(self.namesReplyStagingArea) {
+		for (IRCUser *user in self.namesReplyStagingArea) {
+			if (NSObjectsAreEqual([self _memberListIndexKeyForNickname:[user nickname]], indexKey)) {
+				[user setNickname:toNickname];
+			}
+		}
+	}
+}
+
+- (void)discardStagedMembersFromNamesReply
+{
+	XRPerformBlockOnSharedMutableSynchronizationDispatchQueue(^{
+		@synchronized(self.namesReplyStagingArea) {
+			[self.namesReplyStagingArea removeAllObjects];
+		}
+	});
+}
+
+- (void)stageMembersFromNamesReply:(NSArray *)members
+{
+	NSObjectIsEmptyAssert(members);
+
+	XRPerformBlockOnSharedMutableSynchronizationDispatchQueue(^{
+		@synchronized(self.namesReplyStagingArea) {
+			[self.namesReplyStagingArea addObjectsFromArray:members];
+		}
+	});
+}
+
+- (void)commitStagedMembersFromNamesReply
+{
+	__block BOOL memberListChanged = NO;
+
+	XRPerformBlockOnSharedMutableSynchronizationDispatchQueue(^{
+		NSArray *stagedMembers = nil;
+
+		@synchronized(self.namesReplyStagingArea) {
+			stagedMembers = [self.namesReplyStagingArea copy];
+
+			[self.namesReplyStagingArea removeAllObjects];
+		}
+
+		NSObjectIsEmptyAssert(stagedMembers);
+
+		/* A member already in the list (such as one added by a JOIN, or
+		 when the user requested NAMES themselves) is replaced by the
+		 instance from the reply. Everything is then sorted once. */
+		NSArray *allMembers = nil;
+
+		@synchronized(self.memberListNicknameIndex) {
+			for (IRCUser *user in stagedMembers) {
+				NSString *indexKey = [self _memberListIndexKeyForNickname:[user nickname]];
+
+				if (indexKey) {
+					self.memberListNicknameIndex[indexKey] = user;
+
+					[self.associatedClient noteMember:user withIndexKey:indexKey wasAddedToChannel:self];
+				}
+			}
+
+			allMembers = [self.memberListNicknameIndex allValues];
+		}
+
+		NSArray *standardSortedMembers = [allMembers sortedArrayUsingComparator:NSDefaultComparator];
+
+		NSArray *lengthSortedMembers = [allMembers sortedArrayUsingComparator:[IRCUser nicknameLengthComparator]];
+
+		@synchronized(self.memberListStandardSortedContainer) {
+			[self.memberListStandardSortedContainer setArray:standardSortedMembers];
+		}
+
+		@synchronized(self.memberListLengthSortedContainer) {
+			[self.memberListLengthSortedContainer setArray:lengthSortedMembers];
+		}
+
+		[self.memberListScanner removeAllObjects];
+
+		for (IRCUser *user in allMembers) {
+			[self.memberListScanner addPattern:[user nickname] withObject:user];
+		}
+
+		memberListChanged = YES;
+	});
+
+	NSAssertReturn(memberListChanged);
+
+	XRPerformBlockSynchronouslyOnMainQueue(^{
+		/* Update the actual member list view. */
+		[self reloadDataForTableView];
+
+		/* Post event to the style. */
+		if ([self isChannel]) {
+			[self.associatedClient postEventToViewController:@"channelMemberAdded" forChannel:self];
+		}
 	});
 }
 
@@ -738,6 +985,15 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 	return mutlist;
 }
 
+- (void)enumerateMembersMentionedInString:(NSString *)string usingBlock:(void (^)(IRCUser *member, NSRange range, BOOL *stop))block
+{
+	PointerIsEmptyAssert(block);
+
+	[self.memberListScanner enumerateMatchesInString:string usingBlock:^(id object, NSRange range, BOOL *stop) {
+		block(object, range, stop);
+	}];
+}
+
 - (NSArray *)sortedByNicknameLengthMemberList
 {
 	return [self memberListSortedByNicknameLength];
@@ -756,14 +1012,8 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 	__block BOOL foundUser;
 	
 	XRPerformBlockOnSharedMutableSynchronizationDispatchQueue(^{
-		@synchronized(self.memberListStandardSortedContainer) {
-			NSInteger somi = [self indexOfMember:nickname options:NSCaseInsensitiveSearch inList:self.memberListStandardSortedContainer];
-			
-			if (somi == NSNotFound) {
-				foundUser = NO;
-			} else {
-				foundUser = YES;
-			}
+		@synchronized(self.memberListNicknameIndex) {
+			foundUser = ([self _memberWithNickname:nickname] != nil);
 		}
 	});
 	
@@ -780,14 +1030,8 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 	__block IRCUser *foundUser;
 	
 	XRPerformBlockOnSharedMutableSynchronizationDispatchQueue(^{
-		@synchronized(self.memberListStandardSortedContainer) {
-			NSInteger somi = [self indexOfMember:nickname options:NSCaseInsensitiveSearch inList:self.memberListStandardSortedContainer];
-			
-			if (somi == NSNotFound) {
-				foundUser = nil;
-			} else {
-				foundUser = self.memberListStandardSortedContainer[somi];
-			}
+		@synchronized(self.memberListNicknameIndex) {
+			foundUser = [self _memberWithNickname:nickname];
 		}
 	});
 	
@@ -807,15 +1051,38 @@ NSString * const IRCChannelConfigurationWasUpdatedNotification = @"IRCChannelCon
 	return foundUser;
 }
 
-- (NSInteger)indexOfMember:(NSString *)nick options:(NSStringCompareOptions)mask inList:(NSArray *)memberList
+- (void)rebuildMemberListNicknameIndex
 {
-	NSObjectIsEmptyAssertReturn(nick, NSNotFound);
-	
-	if (mask & NSCaseInsensitiveSearch) {
-		return [memberList indexOfObjectMatchingValue:nick withKeyPath:@"nickname" usingSelector:@selector(isEqualIgnoringCase:)];
-	} else {
-		return [memberList indexOfObjectMatchingValue:nick withKeyPath:@"nickname" usingSelector:@selector(isEqualToString:)];
-	}
+	XRPerformBlockOnSharedMutableSynchronizationDispatchQueue(^{
+		NSArray *members = nil;
+
+		@synchronized(self.memberListStandardSortedContainer) {
+			members = [self.memberListStandardSortedContainer copy];
+		}
+
+		@synchronized(self.memberListNicknameIndex) {
+			[self.memberListNicknameIndex removeAllObjects];
+
+			for (IRCUser *user in members) {
+				NSString *indexKey = [self _memberListIndexKeyForNickname:[user nickname]];
+
+				if (indexKey) {
+					self.memberListNicknameIndex[indexKey] = user;
+
+					[self.associatedClient noteMember:user withIndexKey:indexKey wasAddedToChannel:self];
+				}
+			}
+		}
+	});
+}
+
+- (IRCUser *)_memberWithNickname:(NSString *)nickname
+{
+	NSObjectIsEmptyAssertReturn(nickname, nil);
+
+	NSString *indexKey = [self _memberListIndexKeyForNickname:nickname];
+
+	return self.memberListNicknameIndex[indexKey];
 }
 
 #pragma mark -
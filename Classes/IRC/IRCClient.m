@@ -117,9 +117,16 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 @property (nonatomic, strong) TLOTimer *commandQueueTimer;
 @property (nonatomic, assign) ClientIRCv3SupportedCapacities capacitiesPending;
 @property (nonatomic, strong) NSMutableArray *channels;
+@property (nonatomic, strong) NSMutableDictionary *channelNameIndex; // Folded name -> IRCChannel; guarded by self.channels
+@property (nonatomic, assign) IRCISupportCaseMapping channelNameIndexCaseMapping;
 @property (nonatomic, strong) NSMutableArray *commandQueue;
 @property (nonatomic, strong) NSMutableDictionary *trackedUsers;
+@property (nonatomic, strong) NSMutableDictionary *memberChannelIndex; // Folded nickname -> NSMutableSet of IRCChannel
+@property (nonatomic, strong) NSMutableDictionary *memberIdentities; // Folded nickname -> IRCUserIdentity; guarded by memberChannelIndex
 @property (nonatomic, weak) IRCChannel *lagCheckDestinationChannel;
+@property (nonatomic, strong) NSArray *cachedHighlightKeywords; // Match keywords plus local nickname
+@property (nonatomic, strong) NSArray *cachedHighlightKeywordsSource;
+@property (nonatomic, copy) NSString *cachedHighlightKeywordsNickname;
 @end
 
 @implementation IRCClient
@@ -180,8 +187,14 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 		self.channels = [NSMutableArray array];
 		self.commandQueue = [NSMutableArray array];
 
+		self.channelNameIndex = [NSMutableDictionary dictionary];
+		self.channelNameIndexCaseMapping = [self.supportInfo caseMapping];
+
 		self.trackedUsers = [NSMutableDictionary dictionary];
 
+		self.memberChannelIndex = [NSMutableDictionary dictionary];
+		self.memberIdentities = [NSMutableDictionary dictionary];
+
 		self.preAwayNickname = nil;
 
 		self.lastMessageReceived = 0;
@@ -384,6 +397,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	@synchronized(self.channels) {
 		[self.channels removeAllObjects];
 		[self.channels addObjectsFromArray:newChannelList];
+
+		[self rebuildChannelNameIndex];
 	}
 	
 	/* Reset stored channel list now that we are done. */
@@ -764,6 +779,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 					[self.channels addObject:channel];
 				}
 			}
+
+			[self addChannelToNameIndex:channel];
 			
 			[self updateStoredChannelList];
 		}
@@ -775,6 +792,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	XRPerformBlockOnSharedMutableSynchronizationDispatchQueue(^{
 		@synchronized(self.channels) {
 			[self.channels insertObject:channel atIndex:pos];
+
+			[self addChannelToNameIndex:channel];
 			
 			[self updateStoredChannelList];
 		}
@@ -786,6 +805,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	XRPerformBlockOnSharedMutableSynchronizationDispatchQueue(^{
 		@synchronized(self.channels) {
 			[self.channels removeObjectIdenticalTo:channel];
+
+			[self removeChannelFromNameIndex:channel];
 			
 			[self updateStoredChannelList];
 		}
@@ -836,6 +857,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 			[self.channels removeAllObjects];
 			
 			[self.channels addObjectsFromArray:channelList];
+
+			[self rebuildChannelNameIndex];
 			
 			[self updateStoredChannelList];
 		}
@@ -903,17 +926,26 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	return s;
 }
 
-- (NSString *)convertFromCommonEncoding:(NSData *)data
+- (IRCMessageParseOptions)receivedLineParseOptions
 {
-	NSString *s = [NSString stringWithBytes:[data bytes] length:[data length] encoding:self.config.primaryEncoding];
+	IRCMessageParseOptions options;
 
-	if (s == nil) {
-		s = [NSString stringWithBytes:[data bytes] length:[data length] encoding:self.config.fallbackEncoding];
+	options.primaryEncoding = [self.config primaryEncoding];
+	options.fallbackEncoding = [self.config fallbackEncoding];
 
-		if (s == nil) {
-			s = [NSString stringWithBytes:[data bytes] length:[data length] encoding:NSASCIIStringEncoding];
-		}
-	}
+	options.stripFormatting = [TPCPreferences removeAllFormatting];
+
+	options.parseServerTime = [self isCapacityEnabled:ClientIRCv3SupportedCapacityServerTime];
+
+	return options;
+}
+
+- (NSString *)convertFromCommonEncoding:(NSData *)data
+{
+	NSString *s = [THOUnicodeHelper stringWithBytes:[data bytes]
+											 length:[data length]
+									primaryEncoding:self.config.primaryEncoding
+								   fallbackEncoding:self.config.fallbackEncoding];
 
 	if (s == nil) {
 		DebugLogToConsole(@"NSData decode failure. (%@)", data);
@@ -928,24 +960,22 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 
 - (IRCAddressBookEntry *)checkIgnoreAgainstHostmask:(NSString *)host withMatches:(NSArray *)matches
 {
-	NSObjectIsEmptyAssertReturn(host, nil);
 	NSObjectIsEmptyAssertReturn(matches, nil);
-	
-	NSString *hostmask = [host lowercaseString];
 
-	for (IRCAddressBookEntry *g in self.config.ignoreList) {
-		if ([g checkIgnore:hostmask]) {
-			NSDictionary *ignoreDict = [g dictionaryValue];
+	IRCAddressBookIgnoreFlags flags = [IRCAddressBookEntry ignoreFlagsForDictionaryValueKeys:matches];
 
-			for (NSString *matchkey in matches) {
-				if ([ignoreDict boolForKey:matchkey] == YES) {
-					return g;
-				}
-			}
-		}
-	}
+	return [self checkIgnoreAgainstHostmask:host withFlags:flags];
+}
 
-	return nil;
+- (IRCAddressBookEntry *)checkIgnoreAgainstHostmask:(NSString *)host withFlags:(IRCAddressBookIgnoreFlags)flags
+{
+	NSObjectIsEmptyAssertReturn(host, nil);
+
+	IRCAddressBookEntry *matchedEntry = nil;
+
+	(void)[[self.config ignoreListMatcher] matchHostmask:host withFlags:flags matchedEntry:&matchedEntry];
+
+	return matchedEntry;
 }
 
 #pragma mark -
@@ -1566,8 +1596,160 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 
 - (IRCChannel *)findChannel:(NSString *)name
 {
+	NSObjectIsEmptyAssertReturn(name, nil);
+
+	@synchronized(self.channels) {
+		/* Names are folded with the casemapping of the server, which is not
+		 known until RPL_ISUPPORT. Channels added before then are refolded the
+		 first time a lookup notices that the casemapping has changed. */
+		if (NSDissimilarObjects(self.channelNameIndexCaseMapping, [self.supportInfo caseMapping])) {
+			[self rebuildChannelNameIndex];
+		}
+
+		return self.channelNameIndex[[self.supportInfo caseMappedNickname:name]];
+	}
+}
+
+- (void)addChannelToNameIndex:(IRCChannel *)channel
+{
+	NSString *channelName = [channel name];
+
+	NSObjectIsEmptyAssert(channelName);
+
+	NSString *indexKey = [self.supportInfo caseMappedNickname:channelName];
+
+	/* The first of two channels with equal names is the one -findChannel:inList:
+	 would have returned when walking the list so it keeps the index entry. */
+	if (self.channelNameIndex[indexKey] == nil) {
+		self.channelNameIndex[indexKey] = channel;
+	}
+}
+
+- (void)removeChannelFromNameIndex:(IRCChannel *)channel
+{
+	NSString *channelName = [channel name];
+
+	NSObjectIsEmptyAssert(channelName);
+
+	NSString *indexKey = [self.supportInfo caseMappedNickname:channelName];
+
+	if (self.channelNameIndex[indexKey] == channel) {
+		[self.channelNameIndex removeObjectForKey:indexKey];
+
+		/* Another channel with an equal name may have been shadowed. */
+		IRCChannel *shadowedChannel = [self findChannel:channelName inList:self.channels];
+
+		if (shadowedChannel) {
+			self.channelNameIndex[indexKey] = shadowedChannel;
+		}
+	}
+}
+
+- (void)rebuildChannelNameIndex
+{
+	@synchronized(self.channels) {
+		[self.channelNameIndex removeAllObjects];
+
+		self.channelNameIndexCaseMapping = [self.supportInfo caseMapping];
+
+		for (IRCChannel *c in self.channels) {
+			[self addChannelToNameIndex:c];
+		}
+	}
+}
+
+- (NSArray *)channelsContainingMember:(NSString *)nickname
+{
+	NSObjectIsEmptyAssertReturn(nickname, @[]);
+
+	NSString *indexKey = [self.supportInfo caseMappedNickname:nickname];
+
+	@synchronized(self.memberChannelIndex) {
+		NSSet *memberChannels = self.memberChannelIndex[indexKey];
+
+		if (memberChannels) {
+			/* A copy is returned because callers remove the member from
+			 these channels (and so from the index) while enumerating. */
+			return [memberChannels allObjects];
+		} else {
+			return @[];
+		}
+	}
+}
+
+- (IRCUserIdentity *)identityForMember:(NSString *)nickname
+{
+	NSObjectIsEmptyAssertReturn(nickname, nil);
+
+	NSString *indexKey = [self.supportInfo caseMappedNickname:nickname];
+
+	@synchronized(self.memberChannelIndex) {
+		return self.memberIdentities[indexKey];
+	}
+}
+
+- (void)noteMember:(IRCUser *)member withIndexKey:(NSString *)indexKey wasAddedToChannel:(IRCChannel *)channel
+{
+	PointerIsEmptyAssert(member);
+	PointerIsEmptyAssert(indexKey);
+	PointerIsEmptyAssert(channel);
+
+	@synchronized(self.memberChannelIndex) {
+		NSMutableSet *memberChannels = self.memberChannelIndex[indexKey];
+
+		if (memberChannels == nil) {
+			memberChannels = [NSMutableSet set];
+
+			self.memberChannelIndex[indexKey] = memberChannels;
+		}
+
+		[memberChannels addObject:channel];
+
+		/* The first member seen with a nickname provides the identity that
+		 members of other channels with the same nickname then share. A
+		 renamed member carries its identity over to the new nickname. */
+		IRCUserIdentity *sharedIdentity = self.memberIdentities[indexKey];
+
+		if (sharedIdentity == nil) {
+			self.memberIdentities[indexKey] = [member identity];
+		} else if (NSDissimilarObjects(sharedIdentity, [member identity])) {
+			[member shareIdentity:sharedIdentity];
+		}
+	}
+}
+
+- (void)noteMemberWithIndexKey:(NSString *)indexKey wasRemovedFromChannel:(IRCChannel *)channel
+{
+	PointerIsEmptyAssert(indexKey);
+	PointerIsEmptyAssert(channel);
+
+	@synchronized(self.memberChannelIndex) {
+		NSMutableSet *memberChannels = self.memberChannelIndex[indexKey];
+
+		[memberChannels removeObject:channel];
+
+		if ([memberChannels count] == 0) {
+			[self.memberChannelIndex removeObjectForKey:indexKey];
+
+			[self.memberIdentities removeObjectForKey:indexKey];
+		}
+	}
+}
+
+- (void)rebuildMemberIndexes
+{
+	/* Each channel notes its members again as it refolds its own index.
+	 Nicknames which now fold the same end up sharing one identity. */
+	@synchronized(self.memberChannelIndex) {
+		[self.memberChannelIndex removeAllObjects];
+
+		[self.memberIdentities removeAllObjects];
+	}
+
 	@synchronized(self.channels) {
-		return [self findChannel:name inList:self.channels];
+		for (IRCChannel *c in self.channels) {
+			[c rebuildMemberListNicknameIndex];
+		}
 	}
 }
 
@@ -1610,6 +1792,19 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	worldController().bandwidthOut += [str length];
 }
 
+- (void)sendBackgroundLine:(NSString *)str
+{
+	/* Automated traffic waits for anything the user sends. */
+	if (self.isConnected == NO) {
+		return [self printDebugInformationToConsole:BLS(1199)];
+	}
+
+	[self.socket sendLine:str priority:IRCConnectionBackgroundSendPriority];
+
+	worldController().messagesSent += 1;
+	worldController().bandwidthOut += [str length];
+}
+
 - (void)send:(NSString *)str arguments:(NSArray *)arguments
 {
 	NSString *s = [IRCSendingMessage stringWithCommand:str arguments:arguments];
@@ -1619,6 +1814,15 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	[self sendLine:s];
 }
 
+- (void)sendBackground:(NSString *)str arguments:(NSArray *)arguments
+{
+	NSString *s = [IRCSendingMessage stringWithCommand:str arguments:arguments];
+
+	NSObjectIsEmptyAssert(s);
+
+	[self sendBackgroundLine:s];
+}
+
 - (void)send:(NSString *)str, ...
 {
 	NSMutableArray *arguments = [NSMutableArray array];
@@ -2297,6 +2501,16 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 
 			self.inUserInvokedNamesRequest = YES;
 
+			/* A reply to an earlier request that never ended would
+			 otherwise be merged into the reply to this one. */
+			NSString *channelList = [[uncutInput componentsSeparatedByString:@" "] firstObject];
+
+			for (NSString *channelName in [channelList componentsSeparatedByString:@","]) {
+				IRCChannel *c = [self findChannel:channelName];
+
+				[c discardStagedMembersFromNamesReply];
+			}
+
 			[self send:IRCPrivateCommandIndex("names"), uncutInput, nil];
 
 			break;
@@ -3521,6 +3735,29 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	return [NSString stringWithString:buffer];
 }
 
+- (NSArray *)highlightKeywordsByAddingLocalNickname:(NSArray *)matchKeywords
+{
+	/* Lines printed carry the same array until either the keywords or the 
+	 local nickname change. TVCLogRenderer compares keyword arrays by pointer
+	 so a new array for every line would recompile its matcher every time. */
+	NSString *localNickname = [self localNickname];
+
+	PointerIsEmptyAssertReturn(localNickname, matchKeywords);
+
+	@synchronized(self) {
+		if (self.cachedHighlightKeywordsSource != matchKeywords ||
+			NSObjectsAreEqual(self.cachedHighlightKeywordsNickname, localNickname) == NO)
+		{
+			self.cachedHighlightKeywords = [matchKeywords arrayByAddingObject:localNickname];
+
+			self.cachedHighlightKeywordsSource = matchKeywords;
+			self.cachedHighlightKeywordsNickname = localNickname;
+		}
+
+		return self.cachedHighlightKeywords;
+	}
+}
+
 - (void)printAndLog:(TVCLogLine *)line completionBlock:(IRCClientPrintToWebViewCallbackBlock)completionBlock
 {
 	[self.viewController print:line completionBlock:completionBlock];
@@ -3587,7 +3824,7 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 
 			if (([TPCPreferences highlightMatchingMethod] == TXNicknameHighlightRegularExpressionMatchType) == NO) {
 				if ([TPCPreferences highlightCurrentNickname]) {
-					matchKeywords = [matchKeywords arrayByAddingObject:[self localNickname]];
+					matchKeywords = [self highlightKeywordsByAddingLocalNickname:matchKeywords];
 				}
 			}
 		}
@@ -3937,7 +4174,27 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	[self printError:error forCommand:TVCLogLineDefaultRawCommandValue];
 }
 
+- (IRCMessageParseOptions)ircConnectionReceivedLineParseOptions
+{
+	return [self receivedLineParseOptions];
+}
+
 - (void)ircConnectionDidReceive:(NSString *)data
+{
+	NSObjectIsEmptyAssert(data);
+
+	NSData *rawData = [self convertToCommonEncoding:data];
+
+	PointerIsEmptyAssert(rawData);
+
+	IRCMessage *m = [IRCMessage new];
+
+	[m parseData:rawData forClient:self];
+
+	[self ircConnectionDidReceiveMessage:m];
+}
+
+- (void)ircConnectionDidReceiveMessage:(IRCMessage *)m
 {
 	if ([self isTerminating]) {
 		return; // No reason to show this.
@@ -3946,25 +4203,19 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	NSAssertReturn(self.isConnected);
 	NSAssertReturn(self.isQuitting == NO);
 
-	NSString *s = data;
+	NSUInteger rawDataLength = [m rawDataLength];
 
 	self.lastMessageReceived = [NSDate unixTime];
 
-	NSObjectIsEmptyAssert(s);
+	NSAssertReturn(rawDataLength > 0);
 
 	worldController().messagesReceived += 1;
-	worldController().bandwidthIn += [s length];
-
-	[self logToConsoleIncomingTraffic:s];
+	worldController().bandwidthIn += rawDataLength;
 
-	if ([TPCPreferences removeAllFormatting]) {
-		s = [s stripIRCEffects];
+	if (self.rawModeEnabled) {
+		[self logToConsoleIncomingTraffic:[self convertFromCommonEncoding:[m rawData]]];
 	}
 
-	IRCMessage *m = [IRCMessage new];
-
-	[m parseLine:s forClient:self];
-	
 	PointerIsEmptyAssert(m.params); // If line was malformed, params will be nil.
 
     /* Intercept input. */
@@ -4288,11 +4539,11 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	}
 
 	IRCAddressBookEntry *ignoreChecks = [self checkIgnoreAgainstHostmask:[referenceMessage senderHostmask]
-															 withMatches:@[	IRCAddressBookDictionaryValueIgnorePublicMessageHighlightsKey,
-																			IRCAddressBookDictionaryValueIgnorePrivateMessageHighlightsKey,
-																			IRCAddressBookDictionaryValueIgnoreNoticeMessagesKey,
-																			IRCAddressBookDictionaryValueIgnorePublicMessagesKey,
-																			IRCAddressBookDictionaryValueIgnorePrivateMessagesKey	]];
+															 withFlags:(IRCAddressBookIgnorePublicMessageHighlightsFlag |
+																			IRCAddressBookIgnorePrivateMessageHighlightsFlag |
+																			IRCAddressBookIgnoreNoticeMessagesFlag |
+																			IRCAddressBookIgnorePublicMessagesFlag |
+																			IRCAddressBookIgnorePrivateMessagesFlag)];
 
 
 	/* Ignore highlights? */
@@ -4670,8 +4921,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	NSMutableString *s = [text mutableCopy];
 
 	IRCAddressBookEntry *ignoreChecks = [self checkIgnoreAgainstHostmask:[m senderHostmask]
-															 withMatches:@[IRCAddressBookDictionaryValueIgnoreClientToClientProtocolKey,
-																		   IRCAddressBookDictionaryValueIgnoreFileTransferRequestsKey]];
+															 withFlags:(IRCAddressBookIgnoreClientToClientProtocolFlag |
+																		   IRCAddressBookIgnoreFileTransferRequestsFlag)];
 
 	NSAssertReturn([ignoreChecks ignoreClientToClientProtocol] == NO);
 	
@@ -4783,7 +5034,7 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	NSMutableString *s = [text mutableCopy];
 
 	IRCAddressBookEntry *ignoreChecks = [self checkIgnoreAgainstHostmask:[m senderHostmask]
-															 withMatches:@[IRCAddressBookDictionaryValueIgnoreClientToClientProtocolKey]];
+															 withFlags:IRCAddressBookIgnoreClientToClientProtocolFlag];
 
 	NSAssertReturn([ignoreChecks ignoreClientToClientProtocol] == NO);
 
@@ -4886,8 +5137,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	}
 
 	IRCAddressBookEntry *ignoreChecks = [self checkIgnoreAgainstHostmask:[m senderHostmask]
-															 withMatches:@[IRCAddressBookDictionaryValueIgnoreGeneralEventMessagesKey,
-																		   IRCAddressBookDictionaryValueTrackUserActivityKey]];
+															 withFlags:(IRCAddressBookIgnoreGeneralEventMessagesFlag |
+																		   IRCAddressBookTrackUserActivityFlag)];
 	
 	if ([m isPrintOnlyMessage] == NO) {
 		[self checkAddressBookForTrackedUser:ignoreChecks inMessage:m];
@@ -4952,7 +5203,7 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 
 	if ([TPCPreferences showJoinLeave] || myself) {
 		IRCAddressBookEntry *ignoreChecks = [self checkIgnoreAgainstHostmask:[m senderHostmask]
-																 withMatches:@[IRCAddressBookDictionaryValueIgnoreGeneralEventMessagesKey]];
+																 withFlags:IRCAddressBookIgnoreGeneralEventMessagesFlag];
 
 		if (([ignoreChecks ignoreGeneralEventMessages] || c.config.ignoreGeneralEventMessages) && myself == NO) {
 			return;
@@ -5017,7 +5268,7 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 
 	if ([TPCPreferences showJoinLeave] || myself) {
 		IRCAddressBookEntry *ignoreChecks = [self checkIgnoreAgainstHostmask:[m senderHostmask]
-																 withMatches:@[IRCAddressBookDictionaryValueIgnoreGeneralEventMessagesKey]];
+																 withFlags:IRCAddressBookIgnoreGeneralEventMessagesFlag];
 
 		if (([ignoreChecks ignoreGeneralEventMessages] || c.config.ignoreGeneralEventMessages) && myself == NO) {
 			return;
@@ -5049,8 +5300,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	BOOL myself = [sendern isEqualIgnoringCase:[self localNickname]];
 
 	IRCAddressBookEntry *ignoreChecks = [self checkIgnoreAgainstHostmask:[m senderHostmask]
-															 withMatches:@[IRCAddressBookDictionaryValueIgnoreGeneralEventMessagesKey,
-																		   IRCAddressBookDictionaryValueTrackUserActivityKey]];
+															 withFlags:(IRCAddressBookIgnoreGeneralEventMessagesFlag |
+																		   IRCAddressBookTrackUserActivityFlag)];
 
 	/* When m.isPrintOnlyMessage is set for quit messages the order in which
 	 the paramas is handled is a little different. Index 0 is the target channel
@@ -5102,31 +5353,27 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	}
 
 	/* Continue with normal operations. */
-	@synchronized(self.channels) {
-		for (IRCChannel *c in self.channels) {
-			if ([c memberExists:sendern]) {
-				if (_showQuitInChannel || myself || [c isPrivateMessage]) {
-					if ([c isPrivateMessage]) {
-						text = BLS(1154, sendern);
-					}
+	for (IRCChannel *c in [self channelsContainingMember:sendern]) {
+		if (_showQuitInChannel || myself || [c isPrivateMessage]) {
+			if ([c isPrivateMessage]) {
+				text = BLS(1154, sendern);
+			}
 
-					[self print:c
-						   type:TVCLogLineQuitType
-					   nickname:nil
-					messageBody:text
-					 receivedAt:[m receivedAt]
-						command:[m command]];
-				}
+			[self print:c
+				   type:TVCLogLineQuitType
+			   nickname:nil
+			messageBody:text
+			 receivedAt:[m receivedAt]
+				command:[m command]];
+		}
 
-				[c removeMember:sendern];
+		[c removeMember:sendern];
 
-				if (myself || [c isPrivateMessage]) {
-					[c deactivate];
+		if (myself || [c isPrivateMessage]) {
+			[c deactivate];
 
-					if (myself == NO) {
-						[mainWindow() reloadTreeItem:c];
-					}
-				}
+			if (myself == NO) {
+				[mainWindow() reloadTreeItem:c];
 			}
 		}
 	}
@@ -5148,12 +5395,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 
 	NSString *target = [m paramAt:0];
 	
-	@synchronized(self.channels) {
-		for (IRCChannel *c in self.channels) {
-			if ([c findMember:target]) {
-				[c removeMember:target];
-			}
-		}
+	for (IRCChannel *c in [self channelsContainingMember:target]) {
+		[c removeMember:target];
 	}
 }
 
@@ -5196,15 +5439,15 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 		if ([m isPrintOnlyMessage] == NO) {
 			/* Check new nickname in address book user check. */
 			ignoreChecks = [self checkIgnoreAgainstHostmask:[newNick stringByAppendingString:@"!-@-"]
-												withMatches:@[IRCAddressBookDictionaryValueTrackUserActivityKey]];
+												withFlags:IRCAddressBookTrackUserActivityFlag];
 
 			[self checkAddressBookForTrackedUser:ignoreChecks inMessage:m];
 		}
 
 		/* Check old nickname in address book user check. */
 		ignoreChecks = [self checkIgnoreAgainstHostmask:[m senderHostmask]
-											withMatches:@[IRCAddressBookDictionaryValueIgnoreGeneralEventMessagesKey,
-														  IRCAddressBookDictionaryValueTrackUserActivityKey]];
+											withFlags:(IRCAddressBookIgnoreGeneralEventMessagesFlag |
+														  IRCAddressBookTrackUserActivityFlag)];
 
 		if ([m isPrintOnlyMessage] == NO) {
 			[self checkAddressBookForTrackedUser:ignoreChecks inMessage:m];
@@ -5243,31 +5486,27 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	}
 
 	/* Continue with normal operations. */
-	@synchronized(self.channels) {
-		for (IRCChannel *c in self.channels) {
-			if ([c memberExists:oldNick]) {
-				NSString *text = nil;
-				
-				if ((myself == NO && [TPCPreferences showJoinLeave] && [ignoreChecks ignoreGeneralEventMessages] == NO && c.config.ignoreGeneralEventMessages == NO)) {
-					text = TXTLS(@"BasicLanguage[1152][0]", oldNick, newNick);
-				}
-				
-				if (myself == YES) {
-					text = TXTLS(@"BasicLanguage[1152][1]", newNick);
-				}
-				
-				if (text) {
-					[self print:c
-						   type:TVCLogLineNickType
-					   nickname:nil
-					messageBody:text
-					 receivedAt:[m receivedAt]
-						command:[m command]];
-				}
-				
-				[c renameMember:oldNick to:newNick];
-			}
+	for (IRCChannel *c in [self channelsContainingMember:oldNick]) {
+		NSString *text = nil;
+		
+		if ((myself == NO && [TPCPreferences showJoinLeave] && [ignoreChecks ignoreGeneralEventMessages] == NO && c.config.ignoreGeneralEventMessages == NO)) {
+			text = TXTLS(@"BasicLanguage[1152][0]", oldNick, newNick);
+		}
+		
+		if (myself == YES) {
+			text = TXTLS(@"BasicLanguage[1152][1]", newNick);
+		}
+		
+		if (text) {
+			[self print:c
+				   type:TVCLogLineNickType
+			   nickname:nil
+			messageBody:text
+			 receivedAt:[m receivedAt]
+				command:[m command]];
 		}
+		
+		[c renameMember:oldNick to:newNick];
 	}
 
 	IRCChannel *c = [self findChannel:oldNick];
@@ -5876,15 +6115,17 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
     /* Find all users matching user info. */
 	NSString *nickname = [m senderNickname];
 
-	@synchronized(self.channels) {
-		for (IRCChannel *channel in self.channels) {
-			IRCUser *user = [channel findMember:nickname];
+	IRCUserIdentity *identity = [self identityForMember:nickname];
 
-			if (user) {
-				[user setIsAway:isAway];
-				
-				[channel updateMemberOnTableView:user]; // Redraw the user in the user list.
-			}
+	PointerIsEmptyAssert(identity);
+
+	[identity setIsAway:isAway];
+
+	for (IRCChannel *channel in [self channelsContainingMember:nickname]) {
+		IRCUser *user = [channel findMember:nickname];
+
+		if (user) {
+			[channel updateMemberOnTableView:user]; // Redraw the user in the user list.
 		}
 	}
 }
@@ -6002,7 +6243,14 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 		}
 		case 5: // RPL_ISUPPORT
 		{
+			IRCISupportCaseMapping previousCaseMapping = [self.supportInfo caseMapping];
+
             [self.supportInfo update:[m sequence:1] client:self];
+
+			/* Members indexed before CASEMAPPING was known are folded again. */
+			if (NSDissimilarObjects(previousCaseMapping, [self.supportInfo caseMapping])) {
+				[self rebuildMemberIndexes];
+			}
             
 			NSString *configRep = [self.supportInfo buildConfigurationRepresentationForLastEntry];
 
@@ -6602,32 +6850,6 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
                 isIRCop = YES;
 			}
 
-			/* Textual handles changes from the WHO command differently than you may expect.
-			 Given a user, a copy of that user is created. The copy of the user is then
-			 modified based on the changes in the WHO reply. Once changed, the original 
-			 user and the copied user is compared and based on some predetermined if 
-			 statements, we will decide if the actual instance of the user in the visible
-			 user list requires a redraw. If it does, the only then is the user removed
-			 from the internal user list of the associated channel and readded. */
-			IRCUser *oldUser = [c findMember:nickname];
-			IRCUser *newUser = nil;
-			
-			BOOL insertNewUser = NO;
-
-			if (oldUser == nil) {
-				newUser = [IRCUser newUserOnClient:self withNickname:nickname];
-				
-				insertNewUser = YES;
-			} else {
-				newUser = [oldUser copy];
-			}
-			
-			[newUser setUsername:username];
-			[newUser setAddress:hostmask];
-
-			[newUser setIsAway:isAway];
-			[newUser setIsCop:isIRCop];
-
 			/* Paramater 7 includes the hop count and real name because it begins with a :
 			 Therefore, we cut after the first space to get the real, real name value. */
 			NSInteger realnameFirstSpace = [realname stringPosition:NSStringWhitespacePlaceholder];
@@ -6638,27 +6860,21 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 				}
 			}
 
-			[newUser setRealname:realname];
-
 			/* Update user modes */
 			NSMutableString *userModes = [NSMutableString string];
 
 			for (NSUInteger i = 0; i < [flfields length]; i++) {
-				NSString *prefix = [flfields stringCharacterAtIndex:i];
+				unichar prefix = [flfields characterAtIndex:i];
 
-				NSString *mode = [self.supportInfo modeCharacterFromUserPrefixSymbol:prefix];
+				unichar mode = [self.supportInfo modeCharacterFromUserPrefixCharacter:prefix];
 
-				if (mode == nil) {
+				if (mode == 0) {
 					break;
 				} else {
-					[userModes appendString:mode];
+					[userModes appendFormat:@"%C", mode];
 				}
 			}
 
-			if ([userModes length] > 0) {
-				[newUser setModes:userModes];
-			}
-
 			/* Update local cache of our hostmask. */
 			if ([nickname isEqualIgnoringCase:[self localNickname]]) {
 				NSString *completehost = [NSString stringWithFormat:@"%@!%@@%@", nickname, username, hostmask];
@@ -6666,19 +6882,74 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 				self.cachedLocalHostmask = completehost;
 			}
 
-			/* Continue normal WHO reply tracking. */
-			if (insertNewUser) {
-				[c addMember:newUser];
-			} else {
-				BOOL requiresRedraw = [c memberRequiresRedraw:oldUser comparedTo:newUser];
-				
-				[oldUser migrate:newUser];
-				
-				if (requiresRedraw) {
-					if ([c isChannel]) {
-						[c removeMember:[oldUser nickname]];
-						
-						[c addMember:oldUser];
+			/* Textual handles changes from the WHO command differently than you may expect.
+			 The member is updated in place instead of through a copy. The same conditions
+			 as -memberRequiresRedraw:comparedTo: decide whether the member has to be
+			 removed from the member list of the channel and readded. Removal happens before
+			 the modes change so that the member is found where it was sorted. Username,
+			 address, real name, away, and IRCop status live in the identity shared by
+			 every channel the user is in so they are only stored once. */
+			IRCUser *member = [c findMember:nickname];
+
+			if (member == nil) {
+				member = [IRCUser newUserOnClient:self withNickname:nickname];
+
+				[member setUsername:username];
+				[member setAddress:hostmask];
+				[member setRealname:realname];
+
+				[member setIsAway:isAway];
+				[member setIsCop:isIRCop];
+
+				if ([userModes length] > 0) {
+					[member setModes:userModes];
+				}
+
+				[c addMember:member];
+
+				break;
+			}
+
+			NSString *newModes = [member modes];
+
+			if ([userModes length] > 0) {
+				newModes = userModes;
+			}
+
+			BOOL identityRequiresRedraw = ([member isAway] != isAway || [member isCop] != isIRCop);
+
+			BOOL requiresRedraw = (identityRequiresRedraw || NSObjectsAreEqual([member modes], newModes) == NO);
+
+			BOOL requiresReinsert = (requiresRedraw && [c isChannel]);
+
+			if (requiresReinsert) {
+				[c removeMember:nickname];
+			}
+
+			[member setUsername:username];
+			[member setAddress:hostmask];
+			[member setRealname:realname];
+
+			[member setIsAway:isAway];
+			[member setIsCop:isIRCop];
+
+			[member setModes:newModes];
+
+			if (requiresReinsert) {
+				[c addMember:member];
+			}
+
+			/* Other channels show the same identity. */
+			if (identityRequiresRedraw) {
+				for (IRCChannel *otherChannel in [self channelsContainingMember:nickname]) {
+					if (otherChannel == c) {
+						continue;
+					}
+
+					IRCUser *otherMember = [otherChannel findMember:nickname];
+
+					if (otherMember) {
+						[otherChannel updateMemberOnTableView:otherMember];
 					}
 				}
 			}
@@ -6702,6 +6973,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 
 			NSArray *items = [nameblob componentsSeparatedByString:NSStringWhitespacePlaceholder];
 
+			NSMutableArray *stagedMembers = [NSMutableArray arrayWithCapacity:[items count]];
+
 			for (NSString *nickname in items) {
 				NSObjectIsEmptyAssertLoopContinue(nickname); // Some networks append empty spaces...
 				
@@ -6713,14 +6986,14 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 				NSMutableString *userModes = [NSMutableString string];
 
 				for (i = 0; i < [nickname length]; i++) {
-					NSString *prefix = [nickname stringCharacterAtIndex:i];
+					unichar prefix = [nickname characterAtIndex:i];
 
-					NSString *mode = [self.supportInfo modeCharacterFromUserPrefixSymbol:prefix];
+					unichar mode = [self.supportInfo modeCharacterFromUserPrefixCharacter:prefix];
 
-					if (mode == nil) {
+					if (mode == 0) {
 						break;
 					} else {
-						[userModes appendString:mode];
+						[userModes appendFormat:@"%C", mode];
 					}
 				}
 
@@ -6749,13 +7022,15 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 				[member setAddress:addressInt];
 				
 				/* Populate user list. */
-				/* This data is populated if the user invoked the NAMES command
-				 directly so we must remove any placement of the user. */
-				[c removeMember:nicknameInt];
-				
-				[c addMember:member];
+				/* Members are staged until RPL_ENDOFNAMES so that the member
+				 list is built once instead of once per nickname. If the user
+				 invoked the NAMES command directly, then staged members
+				 replace any existing placement of the user. */
+				[stagedMembers addObject:member];
 			}
 
+			[c stageMembersFromNamesReply:stagedMembers];
+
 			break;
 		}
 		case 366: // RPL_ENDOFNAMES
@@ -6767,6 +7042,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 			IRCChannel *c = [self findChannel:channel];
 
 			PointerIsEmptyAssertLoopBreak(c);
+
+			[c commitStagedMembersFromNamesReply];
 			
 			if (self.inUserInvokedNamesRequest == NO) {
 				if ([c numberOfMembers] <= 1) {
@@ -7155,9 +7432,9 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 				hostmaskwon = [NSString stringWithFormat:@"%@@%@", username, address];
 				hostmaskwnn = [NSString stringWithFormat:@"%@!%@", nickname, hostmaskwon];
 
-				ignoreChecks = [self checkIgnoreAgainstHostmask:hostmaskwnn withMatches:@[IRCAddressBookDictionaryValueTrackUserActivityKey]];
+				ignoreChecks = [self checkIgnoreAgainstHostmask:hostmaskwnn withFlags:IRCAddressBookTrackUserActivityFlag];
 			} else {
-				ignoreChecks = [self checkIgnoreAgainstHostmask:[nickname stringByAppendingString:@"!-@-"] withMatches:@[IRCAddressBookDictionaryValueTrackUserActivityKey]];
+				ignoreChecks = [self checkIgnoreAgainstHostmask:[nickname stringByAppendingString:@"!-@-"] withFlags:IRCAddressBookTrackUserActivityFlag];
 			}
 
 			/* We only continue if there is an actual address book match for the nickname. */
@@ -8284,9 +8561,9 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 			if (channelCount > [TPCPreferences autojoinMaxChannelJoins]) {
 				/* Send previous lists. */
 				if (NSObjectIsEmpty(previousPasswordList)) {
-					[self send:IRCPrivateCommandIndex("join"), previousChannelList, nil];
+					[self sendBackground:IRCPrivateCommandIndex("join") arguments:@[previousChannelList]];
 				} else {
-					[self send:IRCPrivateCommandIndex("join"), previousChannelList, previousPasswordList, nil];
+					[self sendBackground:IRCPrivateCommandIndex("join") arguments:@[previousChannelList, previousPasswordList]];
 				}
 
 				[channelList setString:[c name]];
@@ -8304,9 +8581,9 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 
 	if (NSObjectIsNotEmpty(channelList)) {
 		if (NSObjectIsEmpty(passwordList)) {
-			[self send:IRCPrivateCommandIndex("join"), channelList, nil];
+			[self sendBackground:IRCPrivateCommandIndex("join") arguments:@[channelList]];
 		} else {
-			[self send:IRCPrivateCommandIndex("join"), channelList, passwordList, nil];
+			[self sendBackground:IRCPrivateCommandIndex("join") arguments:@[channelList, passwordList]];
 		}
 	}
 }
@@ -8435,7 +8712,9 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	/* For now, we recognize ACCEPT and RESUME, but we do not act on it. Just adding
 	 code for future expansion in another update. Basically, I had time to write the
 	 basic handler so I will thank myself in time when it comes to write the rest. */
-	BOOL isSendRequest = ([subcommand isEqualToString:@"SEND"]);
+	BOOL isTurboRequest = ([subcommand isEqualToString:@"TSEND"]);
+
+	BOOL isSendRequest = ([subcommand isEqualToString:@"SEND"] || isTurboRequest);
 //	BOOL isResumeRequest = ([subcommand isEqualToString:@"RESUME"]);
 //	BOOL isAcceptRequest = ([subcommand isEqualToString:@"ACCEPT"]);
 	
@@ -8541,7 +8820,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 										  address:hostAddress
 											 port:[hostPort integerValue]
 										 filesize:[filesize longLongValue]
-											token:transferToken];
+											token:transferToken
+											turbo:isTurboRequest];
 
 							return;
 						} else {
@@ -8570,7 +8850,8 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 							  address:hostAddress
 								 port:[hostPort integerValue]
 							 filesize:[filesize longLongValue]
-								token:nil];
+								token:nil
+								turbo:isTurboRequest];
 
 				return;
 			}
@@ -8581,7 +8862,7 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	[self print:nil type:TVCLogLineDCCFileTransferType nickname:nil messageBody:BLS(1020, nickname) command:TVCLogLineDefaultRawCommandValue];
 }
 
-- (void)receivedDCCSend:(NSString *)nickname filename:(NSString *)filename address:(NSString *)address port:(NSInteger)port filesize:(TXUnsignedLongLong)totalFilesize token:(NSString *)transferToken
+- (void)receivedDCCSend:(NSString *)nickname filename:(NSString *)filename address:(NSString *)address port:(NSInteger)port filesize:(TXUnsignedLongLong)totalFilesize token:(NSString *)transferToken turbo:(BOOL)isTurbo
 {
 	/* Inform of the DCC and possibly ignore it. */
 	NSString *message = BLS(1040, nickname, filename, totalFilesize);
@@ -8593,7 +8874,7 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	}
 	
 	/* Add file. */
-	NSString *addedRequest = [[self fileTransferController] addReceiverForClient:self nickname:nickname address:address port:port filename:filename filesize:totalFilesize token:transferToken];
+	NSString *addedRequest = [[self fileTransferController] addReceiverForClient:self nickname:nickname address:address port:port filename:filename filesize:totalFilesize token:transferToken turbo:isTurbo];
 	
 	/* Value returned is nil if it failed to add. */
 	if (addedRequest) {
@@ -8923,7 +9204,7 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 		}
 		
 		for (IRCChannel *c in channelBatch) {
-			[self send:IRCPrivateCommandIndex("who"), [c name], nil];
+			[self sendBackground:IRCPrivateCommandIndex("who") arguments:@[[c name]]];
 		}
 		
 		for (IRCChannel *channel in self.channels) {
@@ -8945,7 +9226,7 @@ NSString * const IRCClientConfigurationWasUpdatedNotification = @"IRCClientConfi
 	/* We send a ISON request to track private messages as well as tracked users. */
 	NSObjectIsEmptyAssert(userstr);
 
-    [self send:IRCPrivateCommandIndex("ison"), userstr, nil];
+    [self sendBackground:IRCPrivateCommandIndex("ison") arguments:@[userstr]];
 }
 
 - (void)checkAddressBookForTrackedUser:(IRCAddressBookEntry *)abEntry inMessage:(IRCMessage *)message
@@ -51,6 +51,8 @@ NSInteger const IRCConnectionDefaultProxyPort = 1080;
 @synthesize serverPassword = _serverPassword;
 @synthesize proxyPassword = _proxyPassword;
 @synthesize nicknamePassword = _nicknamePassword;
+@synthesize ignoreList = _ignoreList;
+@synthesize ignoreListMatcher = _ignoreListMatcher;
 
 /* If the defaults dictionary is not already populated, then we populate it.
  If it is already populated, we can supply a dictionary to override certain
@@ -395,6 +397,37 @@ NSInteger const IRCConnectionDefaultProxyPort = 1080;
 	_nicknamePassword = nil;
 }
 
+#pragma mark -
+#pragma mark Address Book
+
+- (void)setIgnoreList:(NSArray *)ignoreList
+{
+	@synchronized(self) {
+		_ignoreList = [ignoreList copy];
+
+		/* The matcher is compiled the next time it is asked for. */
+		_ignoreListMatcher = nil;
+	}
+}
+
+- (NSArray *)ignoreList
+{
+	@synchronized(self) {
+		return _ignoreList;
+	}
+}
+
+- (IRCAddressBookMatcher *)ignoreListMatcher
+{
+	@synchronized(self) {
+		if (_ignoreListMatcher == nil) {
+			_ignoreListMatcher = [[IRCAddressBookMatcher alloc] initWithEntries:_ignoreList];
+		}
+
+		return _ignoreListMatcher;
+	}
+}
+
 #pragma mark -
 #pragma mark Server Configuration
 
@@ -39,11 +39,104 @@
 
 #define _reservedSlotDictionaryKey			@"Reserved Information"
 
+#define _maximumCommandLength				32
+
 @implementation IRCCommandIndex
 
 static NSDictionary *IRCCommandIndexPublicValues = nil;
 static NSDictionary *IRCCommandIndexPrivateValues = nil;
 
+/* The tables below are compiled from the property lists once at launch so
+ that lookups are a single hash table probe. Tables keyed by C strings are
+ case insensitive and allow lookups without creating an NSString. */
+static CFDictionaryRef IRCCommandIndexPublicKeyTable = NULL; // index key -> command
+static CFDictionaryRef IRCCommandIndexPrivateKeyTable = NULL; // index key -> command
+static CFDictionaryRef IRCCommandIndexInternedCommandTable = NULL; // command -> command
+
+static NSDictionary *IRCCommandIndexPublicCommandTable = nil; // command -> index information
+static NSDictionary *IRCCommandIndexPrivateCommandTable = nil; // command -> index information (standalone only)
+
+static Boolean _cStringKeyEqual(const void *value1, const void *value2)
+{
+	return (strcasecmp(value1, value2) == 0);
+}
+
+static CFHashCode _cStringKeyHash(const void *value)
+{
+	/* FNV-1a over the lowercase form of the string. */
+	CFHashCode hash = 2166136261U;
+
+	for (const unsigned char *c = value; *c; c++) {
+		hash ^= tolower(*c);
+
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static CFMutableDictionaryRef _createCStringKeyedTable(void)
+{
+	/* Keys are duplicated by the caller and live for the
+	 lifetime of the process so no retain callback is needed. */
+	CFDictionaryKeyCallBacks keyCallbacks = {0, NULL, NULL, NULL, _cStringKeyEqual, _cStringKeyHash};
+
+	return CFDictionaryCreateMutable(NULL, 0, &keyCallbacks, &kCFTypeDictionaryValueCallBacks);
+}
+
+static void _addCStringKeyedValue(CFMutableDictionaryRef table, NSString *key, NSString *value)
+{
+	const char *keyString = [key UTF8String];
+
+	if (CFDictionaryContainsKey(table, keyString) == NO) {
+		CFDictionarySetValue(table, strdup(keyString), (__bridge const void *)value);
+	}
+}
+
++ (void)compileLookupTables
+{
+	CFMutableDictionaryRef publicKeyTable = _createCStringKeyedTable();
+	CFMutableDictionaryRef privateKeyTable = _createCStringKeyedTable();
+	CFMutableDictionaryRef internedCommandTable = _createCStringKeyedTable();
+
+	NSMutableDictionary *publicCommandTable = [NSMutableDictionary dictionary];
+	NSMutableDictionary *privateCommandTable = [NSMutableDictionary dictionary];
+
+	for (NSString *indexKey in IRCCommandIndexPublicValues) {
+		NSDictionary *indexInfo = IRCCommandIndexPublicValues[indexKey];
+
+		NSString *command = [indexInfo[@"command"] uppercaseString];
+
+		_addCStringKeyedValue(publicKeyTable, indexKey, indexInfo[@"command"]);
+
+		publicCommandTable[command] = indexInfo;
+	}
+
+	for (NSString *indexKey in IRCCommandIndexPrivateValues) {
+		NSDictionary *indexInfo = IRCCommandIndexPrivateValues[indexKey];
+
+		NSString *command = [indexInfo[@"command"] uppercaseString];
+
+		_addCStringKeyedValue(privateKeyTable, indexKey, indexInfo[@"command"]);
+
+		/* The same command string can appear under more than one key. Interning
+		 the uppercase form means every lookup returns the same instance. */
+		_addCStringKeyedValue(internedCommandTable, command, command);
+
+		/* Only standalone commands are matched against incoming data. */
+		if ([indexInfo boolForKey:@"isStandalone"]) {
+			privateCommandTable[command] = indexInfo;
+		}
+	}
+
+	IRCCommandIndexPublicKeyTable = publicKeyTable;
+	IRCCommandIndexPrivateKeyTable = privateKeyTable;
+	IRCCommandIndexInternedCommandTable = internedCommandTable;
+
+	IRCCommandIndexPublicCommandTable = [publicCommandTable copy];
+	IRCCommandIndexPrivateCommandTable = [privateCommandTable copy];
+}
+
 + (void)populateCommandIndex
 {
 	static BOOL _dataPopulated = NO;
@@ -79,6 +172,8 @@ static NSDictionary *IRCCommandIndexPrivateValues = nil;
 		if (IRCCommandIndexPublicValues == nil) {
 			NSAssert(NO, @"Unable to populate command index.");
 		}
+
+		[IRCCommandIndex compileLookupTables];
 	}
 	
 	_dataPopulated = YES;
@@ -114,29 +209,61 @@ static NSDictionary *IRCCommandIndexPrivateValues = nil;
 	return index;
 }
 
-+ (NSString *)IRCCommandFromIndexKey:(NSString *)key publicSearch:(BOOL)isPublic
++ (NSString *)IRCCommandFromIndexKey:(const char *)key publicSearch:(BOOL)isPublic
 {
-	NSDictionary *searchPath = [IRCCommandIndex IRCCommandIndex:isPublic];
-	
-	for (NSString *indexKey in searchPath) {
-		if ([indexKey isEqualIgnoringCase:key]) {
-			NSDictionary *indexInfo = searchPath[indexKey];
+	CFDictionaryRef searchPath = ((isPublic) ? IRCCommandIndexPublicKeyTable : IRCCommandIndexPrivateKeyTable);
 
-			return indexInfo[@"command"];
-		}
+	if (searchPath == NULL || key == NULL) {
+		return nil;
 	}
-	
-	return nil;
+
+	return (__bridge NSString *)CFDictionaryGetValue(searchPath, key);
 }
 
 NSString *IRCPrivateCommandIndex(const char *key)
 {
-	return [IRCCommandIndex IRCCommandFromIndexKey:@(key) publicSearch:NO];
+	return [IRCCommandIndex IRCCommandFromIndexKey:key publicSearch:NO];
 }
 
 NSString *IRCPublicCommandIndex(const char *key)
 {
-	return [IRCCommandIndex IRCCommandFromIndexKey:@(key) publicSearch:YES];
+	return [IRCCommandIndex IRCCommandFromIndexKey:key publicSearch:YES];
+}
+
++ (NSString *)commandWithBytes:(const char *)bytes length:(NSUInteger)length
+{
+	if (IRCCommandIndexInternedCommandTable == NULL || length == 0 || length >= _maximumCommandLength) {
+		return nil;
+	}
+
+	if (memchr(bytes, '\0', length)) {
+		return nil;
+	}
+
+	char command[_maximumCommandLength];
+
+	memcpy(command, bytes, length);
+
+	command[length] = '\0';
+
+	return (__bridge NSString *)CFDictionaryGetValue(IRCCommandIndexInternedCommandTable, command);
+}
+
++ (NSDictionary *)indexInformationForCommand:(NSString *)command publicSearch:(BOOL)isPublic
+{
+	NSObjectIsEmptyAssertReturn(command, nil);
+
+	NSDictionary *searchPath = ((isPublic) ? IRCCommandIndexPublicCommandTable : IRCCommandIndexPrivateCommandTable);
+
+	/* Commands parsed from the server are already uppercase and usually the
+	 interned instance so the first lookup almost never misses. */
+	NSDictionary *indexInfo = searchPath[command];
+
+	if (indexInfo == nil) {
+		indexInfo = searchPath[[command uppercaseString]];
+	}
+
+	return indexInfo;
 }
 
 + (NSInteger)indexOfIRCommand:(NSString *)command
@@ -146,35 +273,23 @@ NSString *IRCPublicCommandIndex(const char *key)
 
 + (NSInteger)indexOfIRCommand:(NSString *)command publicSearch:(BOOL)isPublic
 {
-	NSDictionary *searchPath = [IRCCommandIndex IRCCommandIndex:isPublic];
-	
-	BOOL inDevMode = [RZUserDefaults() boolForKey:TXDeveloperEnvironmentToken];
-	
-	for (NSString *indexKey in searchPath) {
-		NSDictionary *indexInfo = searchPath[indexKey];
-		
-		NSString *matValue = indexInfo[@"command"];
-		
-		if ([matValue isEqualIgnoringCase:command]) {
-			if (isPublic) {
-				BOOL isDevOnly = [indexInfo boolForKey:@"developerModeOnly"];
-				
-				if (isDevOnly && inDevMode == NO) {
-					continue;
-				}
-			} else {
-				BOOL isStandalone = [indexInfo boolForKey:@"isStandalone"];
-				
-				if (isStandalone == NO) {
-					continue;
-				}
-			}
-			
-			return [indexInfo integerForKey:@"indexValue"];
+	NSDictionary *indexInfo = [IRCCommandIndex indexInformationForCommand:command publicSearch:isPublic];
+
+	if (indexInfo == nil) {
+		return -1;
+	}
+
+	/* The developer mode preference is only consulted
+	 for the handful of commands that depend on it. */
+	if (isPublic) {
+		BOOL isDevOnly = [indexInfo boolForKey:@"developerModeOnly"];
+
+		if (isDevOnly && [RZUserDefaults() boolForKey:TXDeveloperEnvironmentToken] == NO) {
+			return -1;
 		}
 	}
-	
-	return -1;
+
+	return [indexInfo integerForKey:@"indexValue"];
 }
 
 + (NSInteger)colonIndexForCommand:(NSString *)command
@@ -185,24 +300,13 @@ NSString *IRCPublicCommandIndex(const char *key)
 	 that Textual may handle. For example, the internal command list
 	 keeps track of where the colon (:) should be placed for specific
 	 outgoing commands. Better than guessing. */
-	
-	NSDictionary *searchPath = [IRCCommandIndex IRCCommandIndex:NO];
-	
-	for (NSString *indexKey in searchPath) {
-		NSDictionary *indexInfo = searchPath[indexKey];
-		
-		BOOL isStandalone = [indexInfo boolForKey:@"isStandalone"];
-		
-		if (isStandalone) {
-			NSString *matValue = indexInfo[@"command"];
-			
-			if ([matValue isEqualIgnoringCase:command]) {
-				return [indexInfo integerForKey:@"outgoingColonIndex"];
-			}
-		}
+	NSDictionary *indexInfo = [IRCCommandIndex indexInformationForCommand:command publicSearch:NO];
+
+	if (indexInfo == nil) {
+		return -1;
 	}
-	
-	return -1;
+
+	return [indexInfo integerForKey:@"outgoingColonIndex"];
 }
 
 @end
@@ -43,6 +43,18 @@
 /* The actual socket is handled by IRCConnectionSocket.m,
  which is an extension of this class. */
 
+#define _sendPriorityCount			3
+
+/* A line waiting in a send queue. Lines are encoded when they
+ are queued so that sending them involves no more work. */
+@interface IRCConnectionQueuedLine : NSObject
+@property (nonatomic, copy) NSString *line;
+@property (nonatomic, strong) NSData *data;
+@end
+
+@implementation IRCConnectionQueuedLine
+@end
+
 @implementation IRCConnection
 
 #pragma mark -
@@ -51,14 +63,20 @@
 - (instancetype)init
 {
 	if ((self = [super init])) {
-		self.sendQueue = [NSMutableArray new];
+		/* NSMutableArray removes from its front without moving what
+		 follows so each array serves as the deque of its priority. */
+		self.sendQueues = @[[NSMutableArray new], [NSMutableArray new], [NSMutableArray new]];
 		
 		self.floodTimer = [TLOTimer new];
 		
 		[self.floodTimer setDelegate:self];
 		[self.floodTimer setSelector:@selector(timerOnTimer:)];
-		
-		self.floodControlCurrentMessageCount = 0;
+		[self.floodTimer setReqeatTimer:NO];
+
+		self.receivedMessageQueue = [NSMutableArray new];
+
+		self.receiveBatchMaximumLineCount = 100;
+		self.receiveBatchLatencyBudget = 0.025;
 	}
 	
 	return self;
@@ -77,7 +95,9 @@
 
 - (void)open
 {
-	[self startTimer];
+	[self resetFloodControl];
+
+	[self refreshReceivedLineParseOptions];
 
 	[self openSocket];
 }
@@ -88,9 +108,9 @@
 	self.isConnecting = NO;
 	self.isSending = NO;
 
-	self.floodControlCurrentMessageCount = 0;
+	[self clearSendQueue];
 
-	[self.sendQueue removeAllObjects];
+	[self.receivedMessageQueue removeAllObjects];
 	
 	[self stopTimer];
 	
@@ -113,95 +133,161 @@
 #pragma mark -
 #pragma mark Send Data
 
+- (IRCConnectionSendPriority)priorityOfLine:(NSString *)line
+{
+	NSRange commandEnd = [line rangeOfString:NSStringWhitespacePlaceholder];
+
+	NSString *command = nil;
+
+	if (commandEnd.location == NSNotFound) {
+		command = [line uppercaseString];
+	} else {
+		command = [[line substringToIndex:commandEnd.location] uppercaseString];
+	}
+
+	/* QUIT is not a control command. It has to follow whatever the user
+	 sent before it, otherwise queued messages would never be delivered.
+	 NICK is part of registration and must go out no later than USER. */
+	if ([command isEqualToString:IRCPrivateCommandIndex("pong")] ||
+		[command isEqualToString:IRCPrivateCommandIndex("ping")] ||
+		[command isEqualToString:IRCPrivateCommandIndex("pass")] ||
+		[command isEqualToString:IRCPrivateCommandIndex("nick")] ||
+		[command isEqualToString:IRCPrivateCommandIndex("user")] ||
+		[command isEqualToString:IRCPrivateCommandIndex("cap")] ||
+		[command isEqualToString:IRCPrivateCommandIndex("cap_authenticate")])
+	{
+		return IRCConnectionControlSendPriority;
+	}
+
+	return IRCConnectionInteractiveSendPriority;
+}
+
 - (void)sendLine:(NSString *)line
 {
-	/* PONG replies are extremely important. There is no reason they should be
-	 placed in the flood control queue. This writes them directly to the socket
-	 instead of actuallying waiting for the queue. We only need this check if
-	 we actually have flood control enabled. */
-	if (self.connectionUsesOutgoingFloodControl) {
-		BOOL isPong = [line hasPrefix:IRCPrivateCommandIndex("pong")];
+	[self sendLine:line priority:[self priorityOfLine:line]];
+}
 
-		if (isPong) {
-			NSString *firstItem = [line stringByAppendingFormat:@"%c%c", 0x0d, 0x0a];
+- (void)sendLine:(NSString *)line priority:(IRCConnectionSendPriority)priority
+{
+	NSString *lineWithTerminator = [line stringByAppendingFormat:@"%c%c", 0x0d, 0x0a];
 
-			NSData *data = [self convertToCommonEncoding:firstItem];
+	NSData *data = [self convertToCommonEncoding:lineWithTerminator];
 
-			if (data) {
-				[self write:data];
+	PointerIsEmptyAssert(data);
 
-				[self.associatedClient ircConnectionWillSend:firstItem];
+	IRCConnectionQueuedLine *queuedLine = [IRCConnectionQueuedLine new];
 
-				return; // Exit from entering the queue.
-			}
-		}
-	}
+	[queuedLine setLine:lineWithTerminator];
+	[queuedLine setData:data];
 
-	/* Normal send. */
-	[self.sendQueue addObject:line];
+	[self.sendQueues[priority] addObject:queuedLine];
 
 	[self tryToSend];
 }
 
+- (NSMutableArray *)nextSendQueue
+{
+	for (NSMutableArray *sendQueue in self.sendQueues) {
+		if ([sendQueue count] > 0) {
+			return sendQueue;
+		}
+	}
+
+	return nil;
+}
+
 - (BOOL)tryToSend
 {
 	if (self.isSending) {
 		return NO;
 	}
 
-	if ([self.sendQueue count] == 0) {
+	NSMutableArray *sendQueue = [self nextSendQueue];
+
+	if (sendQueue == nil) {
 		return NO;
 	}
 
+	/* Flood control is a token bucket which holds up to the maximum message
+	 count and refills at that count per delay interval. Control lines are
+	 sent right away but still take a token when one is available. */
 	if ([self.associatedClient isLoggedIn]) {
 		if (self.connectionUsesOutgoingFloodControl) {
-			if (self.floodControlCurrentMessageCount >= self.floodControlMaximumMessageCount) {
+			[self refillFloodControlTokens];
+
+			BOOL isControlLine = (sendQueue == self.sendQueues[IRCConnectionControlSendPriority]);
+
+			if (self.floodControlAvailableTokens >= 1.0) {
+				self.floodControlAvailableTokens -= 1.0;
+			} else if (isControlLine == NO) {
+				[self scheduleFloodControlRefill];
+
 				return NO;
 			}
-
-			self.floodControlCurrentMessageCount += 1;
 		}
 	}
 
-	[self sendNextLine];
+	IRCConnectionQueuedLine *queuedLine = sendQueue[0];
+
+	[sendQueue removeObjectAtIndex:0];
+
+	self.isSending = YES;
+
+	[self write:[queuedLine data]];
+
+	[self.associatedClient ircConnectionWillSend:[queuedLine line]];
 	
 	return YES;
 }
 
-- (void)sendNextLine
+- (void)clearSendQueue
 {
-	if ([self.sendQueue count] > 0) {
-		NSString *firstItem = [self.sendQueue[0] stringByAppendingFormat:@"%c%c", 0x0d, 0x0a];
-
-		[self.sendQueue removeObjectAtIndex:0];
-
-		NSData *data = [self convertToCommonEncoding:firstItem];
+	for (NSMutableArray *sendQueue in self.sendQueues) {
+		[sendQueue removeAllObjects];
+	}
 
-		if (data) {
-			self.isSending = YES;
+	[self stopTimer];
+}
 
-			[self write:data];
+#pragma mark -
+#pragma mark Flood Control
 
-			[self.associatedClient ircConnectionWillSend:firstItem];
-		}
+- (double)floodControlRefillRate
+{
+	if (self.floodControlDelayInterval <= 0) {
+		return (double)self.floodControlMaximumMessageCount;
 	}
+
+	return ((double)self.floodControlMaximumMessageCount / self.floodControlDelayInterval);
 }
 
-- (void)clearSendQueue
+- (void)resetFloodControl
 {
-	[self.sendQueue removeAllObjects];
+	self.floodControlAvailableTokens = self.floodControlMaximumMessageCount;
+
+	self.floodControlLastRefill = CFAbsoluteTimeGetCurrent();
 }
 
-#pragma mark -
-#pragma mark Flood Control Timer
+- (void)refillFloodControlTokens
+{
+	CFAbsoluteTime currentTime = CFAbsoluteTimeGetCurrent();
+
+	double refilledTokens = (self.floodControlAvailableTokens + ((currentTime - self.floodControlLastRefill) * [self floodControlRefillRate]));
+
+	self.floodControlAvailableTokens = MIN(refilledTokens, (double)self.floodControlMaximumMessageCount);
 
-- (void)startTimer
+	self.floodControlLastRefill = currentTime;
+}
+
+- (void)scheduleFloodControlRefill
 {
-	if (self.connectionUsesOutgoingFloodControl) {
-		if ([self.floodTimer timerIsActive] == NO) {
-			[self.floodTimer start:self.floodControlDelayInterval];
-		}
-	}
+	NSAssertReturn([self.floodTimer timerIsActive] == NO);
+
+	double refillRate = [self floodControlRefillRate];
+
+	NSAssertReturn(refillRate > 0);
+
+	[self.floodTimer start:((1.0 - self.floodControlAvailableTokens) / refillRate)];
 }
 
 - (void)stopTimer
@@ -213,11 +299,7 @@
 
 - (void)timerOnTimer:(id)sender
 {
-	self.floodControlCurrentMessageCount = 0;
-
-	while ([self tryToSend] == YES) {
-		;
-	}
+	[self tryToSend];
 }
 
 #pragma mark -
@@ -230,8 +312,33 @@
 	[self.associatedClient ircConnectionDidConnect:self];
 }
 
+- (void)refreshReceivedLineParseOptions
+{
+	/* The socket queue parses with a copy of this state so that it never
+	 has to ask the client or preferences for it from off the main queue. */
+	self.receivedLineParseOptions = [self.associatedClient ircConnectionReceivedLineParseOptions];
+}
+
+- (void)flushReceivedLineQueue
+{
+	/* A disconnect caused by the line being delivered right now is handled
+	 by the loop that is delivering it. Processing the queue again from here
+	 would deliver that line, and those after it, a second time. */
+	if (self.isDeliveringReceivedLine) {
+		return;
+	}
+
+	/* Lines that were received before the connection went away are
+	 processed before the delegate is informed of the disconnect. */
+	if ([self.receivedMessageQueue count] > 0) {
+		[self processReceivedLineQueue:NO];
+	}
+}
+
 - (void)tcpClientDidError:(NSString *)error
 {
+	[self flushReceivedLineQueue];
+
 	[self clearSendQueue];
 	
 	[self.associatedClient ircConnectionDidError:error];
@@ -239,14 +346,79 @@
 
 - (void)tcpClientDidDisconnect:(NSError *)distcError
 {
+	[self flushReceivedLineQueue];
+
 	[self clearSendQueue];
 	
 	[self.associatedClient ircConnectionDidDisconnect:self withError:distcError];
 }
 
-- (void)tcpClientDidReceiveData:(NSString *)data
+- (void)tcpClientDidReceiveMessages:(NSArray *)messages
 {
-	[self.associatedClient ircConnectionDidReceive:data];
+	/* Batches are appended to a queue instead of being processed directly so
+	 that a batch which is posted while an earlier one is being worked through
+	 in slices is never processed out of order. */
+	[self.receivedMessageQueue addObjectsFromArray:messages];
+
+	if (self.isProcessingReceivedLineQueue == NO) {
+		[self processReceivedLineQueue:YES];
+	}
+}
+
+- (void)processReceivedLineQueue:(BOOL)yieldWhenBudgetIsSpent
+{
+	self.isProcessingReceivedLineQueue = YES;
+
+	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+
+	NSUInteger processedCount = 0;
+
+	while (processedCount < [self.receivedMessageQueue count]) {
+		IRCMessage *message = self.receivedMessageQueue[processedCount];
+
+		processedCount += 1;
+
+		/* A line that changes how lines are parsed (such as the CAP ACK for
+		 server-time) may have been followed by lines that were parsed on the
+		 socket queue before it was acted on. Those are parsed again. */
+		IRCMessageParseOptions parseOptions = self.receivedLineParseOptions;
+
+		if (IRCMessageParseOptionsAreEqual([message parseOptions], parseOptions) == NO) {
+			[message parseAgainWithOptions:parseOptions];
+		}
+
+		self.isDeliveringReceivedLine = YES;
+
+		[self.associatedClient ircConnectionDidReceiveMessage:message];
+
+		self.isDeliveringReceivedLine = NO;
+
+		[self refreshReceivedLineParseOptions];
+
+		/* The queue is emptied by -close if the connection was closed
+		 as a result of the line that was just processed. */
+		if (processedCount > [self.receivedMessageQueue count]) {
+			processedCount = 0;
+
+			break;
+		}
+
+		/* Yield the main queue once the latency budget is spent so that
+		 the user interface remains responsive during large bursts. */
+		if (yieldWhenBudgetIsSpent && (CFAbsoluteTimeGetCurrent() - startTime) >= self.receiveBatchLatencyBudget) {
+			break;
+		}
+	}
+
+	[self.receivedMessageQueue removeObjectsInRange:NSMakeRange(0, processedCount)];
+
+	if ([self.receivedMessageQueue count] > 0) {
+		XRPerformBlockAsynchronouslyOnMainQueue(^{
+			[self processReceivedLineQueue:YES];
+		});
+	} else {
+		self.isProcessingReceivedLineQueue = NO;
+	}
 }
 
 - (void)tcpClientDidSecureConnection
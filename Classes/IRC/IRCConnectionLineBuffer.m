@@ -0,0 +1,248 @@
+/* ********************************************************************* 
+                  _____         _               _
+                 |_   _|____  _| |_ _   _  __ _| |
+                   | |/ _ \ \/ / __| | | |/ _` | |
+                   | |  __/>  <| |_| |_| | (_| | |
+                   |_|\___/_/\_\\__|\__,_|\__,_|_|
+
+ Copyright (c) 2010 - 2015 Codeux Software, LLC & respective contributors.
+        Please see Acknowledgements.pdf for additional information.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Textual and/or "Codeux Software, LLC", nor the 
+      names of its contributors may be used to endorse or promote products 
+      derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+ *********************************************************************** */
+
+
+#import "TextualApplication.h"
+
+#define _initialBufferCapacity			16384
+
+@interface IRCConnectionLineBuffer ()
+@property (nonatomic, assign) char *buffer;
+@property (nonatomic, assign) NSUInteger capacity;
+@property (nonatomic, assign) NSUInteger readOffset;
+@property (nonatomic, assign) NSUInteger length;
+@property (nonatomic, assign) NSUInteger scannedLength;
+@property (nonatomic, strong) NSMutableData *wrappedLineBuffer;
+@end
+
+@implementation IRCConnectionLineBuffer
+
+- (instancetype)init
+{
+	if ((self = [super init])) {
+		self.buffer = NULL;
+
+		[self reset];
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	if ( self.buffer) {
+		free(self.buffer);
+	}
+}
+
+- (void)reset
+{
+	if ( self.buffer) {
+		free(self.buffer);
+	}
+
+	self.buffer = malloc(_initialBufferCapacity);
+
+	self.capacity = _initialBufferCapacity;
+
+	self.readOffset = 0;
+	self.length = 0;
+
+	self.scannedLength = 0;
+
+	self.wrappedLineBuffer = nil;
+}
+
+#pragma mark -
+#pragma mark Storage
+
+- (void)copyBytesToLinearBuffer:(char *)destination range:(NSRange)range
+{
+	/* Copies a range relative to the read offset into a linear buffer,
+	 taking into account that the range may wrap around the end. */
+	NSUInteger start = ((self.readOffset + range.location) % self.capacity);
+
+	NSUInteger firstSegmentLength = MIN(range.length, (self.capacity - start));
+
+	memcpy(destination, (self.buffer + start), firstSegmentLength);
+
+	if (firstSegmentLength < range.length) {
+		memcpy((destination + firstSegmentLength), self.buffer, (range.length - firstSegmentLength));
+	}
+}
+
+- (void)growToFitLength:(NSUInteger)requiredLength
+{
+	NSUInteger newCapacity = self.capacity;
+
+	while (newCapacity < requiredLength) {
+		newCapacity *= 2;
+	}
+
+	if (newCapacity == self.capacity) {
+		return;
+	}
+
+	/* Unwrap the existing contents so the read offset starts at zero. */
+	char *newBuffer = malloc(newCapacity);
+
+	[self copyBytesToLinearBuffer:newBuffer range:NSMakeRange(0, self.length)];
+
+	free(self.buffer);
+
+	self.buffer = newBuffer;
+
+	self.capacity = newCapacity;
+
+	self.readOffset = 0;
+}
+
+- (void)appendData:(NSData *)data
+{
+	[self appendBytes:[data bytes] length:[data length]];
+}
+
+- (void)appendBytes:(const void *)bytes length:(NSUInteger)length
+{
+	if (bytes == NULL || length == 0) {
+		return;
+	}
+
+	[self growToFitLength:(self.length + length)];
+
+	NSUInteger writeOffset = ((self.readOffset + self.length) % self.capacity);
+
+	NSUInteger firstSegmentLength = MIN(length, (self.capacity - writeOffset));
+
+	memcpy((self.buffer + writeOffset), bytes, firstSegmentLength);
+
+	if (firstSegmentLength < length) {
+		memcpy(self.buffer, ((const char *)bytes + firstSegmentLength), (length - firstSegmentLength));
+	}
+
+	self.length += length;
+}
+
+#pragma mark -
+#pragma mark Line Framing
+
+- (NSUInteger)locationOfNextLineFeed
+{
+	/* Only the bytes that were not part of a previous scan are looked at. */
+	NSUInteger scanLocation = self.scannedLength;
+
+	while (scanLocation < self.length) {
+		NSUInteger start = ((self.readOffset + scanLocation) % self.capacity);
+
+		NSUInteger segmentLength = MIN((self.length - scanLocation), (self.capacity - start));
+
+		char *lineFeed = memchr((self.buffer + start), '\n', segmentLength);
+
+		if (lineFeed) {
+			return (scanLocation + (lineFeed - (self.buffer + start)));
+		}
+
+		scanLocation += segmentLength;
+	}
+
+	self.scannedLength = self.length;
+
+	return NSNotFound;
+}
+
+- (void)enumerateLinesUsingBlock:(void (^)(NSData *line, BOOL *stop))block
+{
+	PointerIsEmptyAssert(block);
+
+	BOOL stop = NO;
+
+	while (stop == NO) {
+		NSUInteger lineFeedLocation = [self locationOfNextLineFeed];
+
+		if (lineFeedLocation == NSNotFound) {
+			break;
+		}
+
+		NSUInteger lineLength = lineFeedLocation;
+
+		/* Drop the carriage return of a CRLF line ending. */
+		if (lineLength > 0) {
+			char lastCharacter = self.buffer[((self.readOffset + lineLength - 1) % self.capacity)];
+
+			if (lastCharacter == '\r') {
+				lineLength -= 1;
+			}
+		}
+
+		NSData *line = nil;
+
+		if ((self.readOffset + lineLength) <= self.capacity) {
+			line = [NSData dataWithBytesNoCopy:(self.buffer + self.readOffset) length:lineLength freeWhenDone:NO];
+		} else {
+			/* The line wraps around the end of the ring so it has to be
+			 unwrapped into a scratch buffer which is reused between lines. */
+			if (self.wrappedLineBuffer == nil) {
+				self.wrappedLineBuffer = [NSMutableData dataWithLength:lineLength];
+			} else {
+				[self.wrappedLineBuffer setLength:lineLength];
+			}
+
+			[self copyBytesToLinearBuffer:[self.wrappedLineBuffer mutableBytes] range:NSMakeRange(0, lineLength)];
+
+			line = [NSData dataWithBytesNoCopy:[self.wrappedLineBuffer mutableBytes] length:lineLength freeWhenDone:NO];
+		}
+
+		/* Consume the line and its line feed. The storage is not overwritten
+		 until the next append so the line remains valid for the block. */
+		NSUInteger consumedLength = (lineFeedLocation + 1);
+
+		self.readOffset = ((self.readOffset + consumedLength) % self.capacity);
+
+		self.length -= consumedLength;
+
+		self.scannedLength = 0;
+
+		block(line, &stop);
+	}
+
+	/* Rewinding an empty buffer keeps future lines contiguous. */
+	if (self.length == 0) {
+		self.readOffset = 0;
+	}
+}
+
+@end
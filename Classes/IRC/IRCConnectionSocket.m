@@ -84,6 +84,10 @@
 {
     [self createDispatchQueue];
 
+	self.readBuffer = [IRCConnectionLineBuffer new];
+
+	self.receiveBatchMessages = [NSMutableArray new];
+
 	self.lastDisconnectWasErroneous = NO;
 	
 	self.isConnecting = YES;
@@ -145,42 +149,6 @@
 #pragma mark -
 #pragma mark Socket Read & Write
 
-- (NSData *)readLine:(NSMutableData * __autoreleasing *)refString
-{
-	NSObjectIsEmptyAssertReturn(*refString, nil);
-	
-	NSInteger messageSubstringIndex = 0;
-	NSInteger messageDeleteIndex = 0;
-
-	NSRange _LFRange = [*refString rangeOfData:[NSData lineFeed] options:0 range:NSMakeRange(0, [*refString length])];
-	NSRange _CRRange = [*refString rangeOfData:[NSData carriageReturn] options:0 range:NSMakeRange(0, [*refString length])];
-
-	if (_LFRange.location == NSNotFound) {
-		/* If we do not have any line end for this fragment and the refString is not
-		 empty, then we save the remaining fragment for processing once we have more
-		 information. */
-
-		NSObjectIsEmptyAssertReturn(*refString, nil);
-
-		self.bufferOverflowString = *refString;
-	
-		return nil;
-	}
-
-	messageSubstringIndex = _LFRange.location;
-	messageDeleteIndex = (_LFRange.location + 1);
-
-	if ((_LFRange.location - 1) == _CRRange.location) {
-		messageSubstringIndex -= 1;
-	}
-	
-	NSData *readLine = [*refString subdataWithRange:NSMakeRange(0, messageSubstringIndex)];
-
-	[*refString replaceBytesInRange:NSMakeRange(0, messageDeleteIndex) withBytes:NULL length:0];
-
-	return readLine;
-}
-
 - (void)write:(NSData *)data
 {
 	if (self.isConnected) {
@@ -313,39 +281,65 @@
 
 - (void)completeReadForData:(NSData *)data
 {
-	NSMutableData *readBuffer = nil;
+	/* The line buffer holds on to any trailing fragment that is not yet
+	 terminated by a line feed until more data arrives to complete it. */
+	[self.readBuffer appendData:data];
 
-	BOOL hasOverflowPrefix = ([self.bufferOverflowString length] > 0);
+	/* Every complete line of this read is copied into one buffer that the
+	 messages then share instead of each message copying its own line. */
+	NSMutableData *linesData = [NSMutableData dataWithCapacity:[data length]];
 
-	if (hasOverflowPrefix) {
-		readBuffer = [self.bufferOverflowString mutableCopy];
+	NSMutableArray *lineRanges = [NSMutableArray array];
 
-		self.bufferOverflowString = nil; // Destroy old overflow;
+	[self.readBuffer enumerateLinesUsingBlock:^(NSData *line, BOOL *stop) {
+		NSAssertReturn([line length] > 0);
 
-		[readBuffer appendBytes:[data bytes] length:[data length]];
-	} else {
-		readBuffer = [data mutableCopy];
+		[lineRanges addObject:[NSValue valueWithRange:NSMakeRange([linesData length], [line length])]];
+
+		[linesData appendData:line];
+	}];
+
+	for (NSValue *lineRange in lineRanges) {
+		[self enqueueReceivedLineInRange:[lineRange rangeValue] ofData:linesData];
 	}
 
-	while (1 == 1) {
-		NSData *rdata = [self readLine:&readBuffer];
+	[self deliverReceiveBatch];
+}
 
-		if (rdata == nil) {
-			break;
-		}
+- (void)enqueueReceivedLineInRange:(NSRange)range ofData:(NSData *)data
+{
+	/* Lines are parsed here, on the socket queue, so that the main queue
+	 only has to act on the result. The options are a snapshot taken on
+	 the main queue. The data is never changed once lines are parsed. */
+	IRCMessage *message = [IRCMessage new];
 
-		NSString *sdata = [self convertFromCommonEncoding:rdata];
+	[message parseData:data range:range options:self.receivedLineParseOptions];
 
-		if (sdata == nil) {
-			break;
-		}
+	[self.receiveBatchMessages addObject:message];
 
-		XRPerformBlockSynchronouslyOnMainQueue(^{
-			[self tcpClientDidReceiveData:sdata];
-		});
+	/* A CAP reply can change the options that the lines after it have to be
+	 parsed with so the batch is cut after it to have it acted on sooner.
+	 Lines parsed before it was acted on are parsed again on the main queue. */
+	BOOL isCapacityReply = [[message command] isEqualToString:IRCPrivateCommandIndex("cap")];
+
+	if (isCapacityReply || [self.receiveBatchMessages count] >= self.receiveBatchMaximumLineCount) {
+		[self deliverReceiveBatch];
 	}
 }
 
+- (void)deliverReceiveBatch
+{
+	NSObjectIsEmptyAssert(self.receiveBatchMessages);
+
+	NSArray *messages = [self.receiveBatchMessages copy];
+
+	[self.receiveBatchMessages removeAllObjects];
+
+	XRPerformBlockAsynchronouslyOnMainQueue(^{
+		[self tcpClientDidReceiveMessages:messages];
+	});
+}
+
 - (void)onSocket:(id)sock didReadData:(NSData *)data withTag:(long)tag
 {
 	if ([self useNewSocketEngine] == NO) {
@@ -40,8 +40,24 @@
 
 #define _channelUserModeValue		100
 
+#define _lookupTableSize			128
+
 NSString * const IRCISupportRawSuffix = @"are supported by this server";
 
+@interface IRCISupportInfo ()
+{
+	/* The mode and prefix characters advertised in PREFIX and CHANMODES are
+	 all ASCII, so both are flattened into tables indexed by character value
+	 each time they change. NAMES and WHO replies, MODE parsing, and member
+	 sorting then look a character up instead of walking an array of strings.
+	 A zero entry means the character is not known to the server. */
+	unichar _userPrefixSymbolToMode[_lookupTableSize];
+	unichar _userPrefixModeToSymbol[_lookupTableSize];
+	NSInteger _userPrefixModeRank[_lookupTableSize];
+	NSInteger _channelModeClass[_lookupTableSize];
+}
+@end
+
 @implementation IRCISupportInfo
 
 - (instancetype)init
@@ -78,6 +94,63 @@ NSString * const IRCISupportRawSuffix = @"are supported by this server";
 	};
 	
 	self.privateMessageNicknamePrefix = nil;
+
+	self.caseMapping = IRCISupportRFC1459CaseMapping;
+}
+
+#pragma mark -
+#pragma mark Lookup Tables
+
+- (void)setUserModePrefixes:(NSArray *)userModePrefixes
+{
+	_userModePrefixes = [userModePrefixes copy];
+
+	memset(_userPrefixSymbolToMode, 0, sizeof(_userPrefixSymbolToMode));
+	memset(_userPrefixModeToSymbol, 0, sizeof(_userPrefixModeToSymbol));
+	memset(_userPrefixModeRank, 0, sizeof(_userPrefixModeRank));
+
+	/* Ranks count down from 100 in the order the server listed them. When
+	 a character is listed more than once, the first occurrence wins. */
+	NSInteger rankValue = _channelUserModeValue;
+
+	for (NSArray *modePrefix in _userModePrefixes) {
+		NSString *modeKey = modePrefix[0];
+		NSString *modeChar = modePrefix[1];
+
+		if ([modeKey length] == 1 && [modeChar length] == 1) {
+			unichar mode = [modeKey characterAtIndex:0];
+			unichar symbol = [modeChar characterAtIndex:0];
+
+			if (mode < _lookupTableSize && _userPrefixModeRank[mode] == 0) {
+				_userPrefixModeRank[mode] = rankValue;
+
+				_userPrefixModeToSymbol[mode] = symbol;
+			}
+
+			if (symbol < _lookupTableSize && _userPrefixSymbolToMode[symbol] == 0) {
+				_userPrefixSymbolToMode[symbol] = mode;
+			}
+		}
+
+		rankValue -= 1;
+	}
+}
+
+- (void)setChannelModes:(NSDictionary *)channelModes
+{
+	_channelModes = [channelModes copy];
+
+	memset(_channelModeClass, 0, sizeof(_channelModeClass));
+
+	for (NSString *modeKey in _channelModes) {
+		if ([modeKey length] == 1) {
+			unichar mode = [modeKey characterAtIndex:0];
+
+			if (mode < _lookupTableSize) {
+				_channelModeClass[mode] = [_channelModes integerForKey:modeKey];
+			}
+		}
+	}
 }
 
 - (void)update:(NSString *)configData client:(IRCClient *)client
@@ -125,6 +198,8 @@ NSString * const IRCISupportRawSuffix = @"are supported by this server";
 				self.channelNamePrefixes = value;
 			} else if ([vakey isEqualIgnoringCase:@"ZNCPREFIX"]) {
 				self.privateMessageNicknamePrefix = value;
+			} else if ([vakey isEqualIgnoringCase:@"CASEMAPPING"]) {
+				[self parseCaseMapping:value];
 			}
 		}
 
@@ -279,7 +354,15 @@ NSString * const IRCISupportRawSuffix = @"are supported by this server";
 	// C = Only has a paramater when set.	Index: 3
 	// D = Never has a paramater.			Index: 4
 
-	NSInteger modeIndex = [self.channelModes integerForKey:m];
+	NSInteger modeIndex = 0;
+
+	if ([m length] == 1) {
+		unichar mode = [m characterAtIndex:0];
+
+		if (mode < _lookupTableSize) {
+			modeIndex = _channelModeClass[mode];
+		}
+	}
 
 	if (modeIndex == 1 || modeIndex == 2 || modeIndex == _channelUserModeValue) {
 		return YES;
@@ -316,19 +399,117 @@ NSString * const IRCISupportRawSuffix = @"are supported by this server";
 	self.channelModes = channelModes;
 }
 
-- (NSString *)userModePrefixSymbolWithMode:(NSString *)mode
+- (void)parseCaseMapping:(NSString *)value
 {
-	__block NSString *charr = nil;
+	/* Anything we do not recognize (such as rfc7613) is treated as rfc1459
+	 which folds the largest set of characters of the three we know. */
+	if ([value isEqualIgnoringCase:@"ascii"]) {
+		self.caseMapping = IRCISupportASCIICaseMapping;
+	} else if ([value isEqualIgnoringCase:@"strict-rfc1459"]) {
+		self.caseMapping = IRCISupportStrictRFC1459CaseMapping;
+	} else {
+		self.caseMapping = IRCISupportRFC1459CaseMapping;
+	}
+}
+
+- (NSString *)caseMappedNickname:(NSString *)nickname
+{
+#define _stackBufferLength			64
+
+	NSObjectIsEmptyAssertReturn(nickname, nickname);
+
+	NSUInteger nicknameLength = [nickname length];
+
+	unichar stackBuffer[_stackBufferLength];
+
+	unichar *characters = stackBuffer;
 
-	[self.userModePrefixes enumerateObjectsUsingBlock:^(NSArray *obj, NSUInteger idx, BOOL *stop) {
-		if (NSObjectsAreEqual(obj[0], mode)) {
-			charr = [obj[1] copy];
+	if (nicknameLength > _stackBufferLength) {
+		characters = malloc(sizeof(unichar) * nicknameLength);
+	}
 
-			*stop = YES;
+	[nickname getCharacters:characters range:NSMakeRange(0, nicknameLength)];
+
+	IRCISupportCaseMapping caseMapping = self.caseMapping;
+
+	BOOL containsNonASCII = NO;
+
+	for (NSUInteger i = 0; i < nicknameLength; i++) {
+		unichar c = characters[i];
+
+		if (c >= 'A' && c <= 'Z') {
+			characters[i] = (c + ('a' - 'A'));
+		} else if (c > 0x7F) {
+			containsNonASCII = YES;
+		} else if (caseMapping == IRCISupportASCIICaseMapping) {
+			continue;
+		} else if (c == '[') {
+			characters[i] = '{';
+		} else if (c == ']') {
+			characters[i] = '}';
+		} else if (c == '\\') {
+			characters[i] = '|';
+		} else if (c == '^' && caseMapping == IRCISupportRFC1459CaseMapping) {
+			characters[i] = '~';
 		}
-	}];
+	}
+
+	NSString *mappedNickname = [NSString stringWithCharacters:characters length:nicknameLength];
+
+	if (characters != stackBuffer) {
+		free(characters);
+	}
+
+#undef _stackBufferLength
 
-	return charr;
+	/* Some servers allow nicknames outside of ASCII. None of the mappings
+	 define folding for those so fall back to Unicode lowercasing which is
+	 what comparisons throughout Textual did before casemapping was known. */
+	if (containsNonASCII) {
+		return [mappedNickname lowercaseString];
+	} else {
+		return mappedNickname;
+	}
+}
+
+- (unichar)userPrefixCharacterWithModeCharacter:(unichar)mode
+{
+	if (mode < _lookupTableSize) {
+		return _userPrefixModeToSymbol[mode];
+	} else {
+		return 0;
+	}
+}
+
+- (unichar)modeCharacterFromUserPrefixCharacter:(unichar)symbol
+{
+	if (symbol < _lookupTableSize) {
+		return _userPrefixSymbolToMode[symbol];
+	} else {
+		return 0;
+	}
+}
+
+- (NSInteger)rankForUserPrefixModeCharacter:(unichar)mode
+{
+	if (mode < _lookupTableSize) {
+		return _userPrefixModeRank[mode];
+	} else {
+		return 0;
+	}
+}
+
+- (NSString *)userModePrefixSymbolWithMode:(NSString *)mode
+{
+	NSAssertReturnR(([mode length] == 1), nil);
+
+	unichar symbol = [self userPrefixCharacterWithModeCharacter:[mode characterAtIndex:0]];
+
+	if (symbol == 0) {
+		return nil;
+	} else {
+		return [NSString stringWithCharacters:&symbol length:1];
+	}
 }
 
 - (BOOL)modeIsSupportedUserPrefix:(NSString *)mode
@@ -340,17 +521,15 @@ NSString * const IRCISupportRawSuffix = @"are supported by this server";
 
 - (NSString *)modeCharacterFromUserPrefixSymbol:(NSString *)symbol
 {
-	__block NSString *mode = nil;
+	NSAssertReturnR(([symbol length] == 1), nil);
 
-	[self.userModePrefixes enumerateObjectsUsingBlock:^(NSArray *obj, NSUInteger idx, BOOL *stop) {
-		if (NSObjectsAreEqual(obj[1], symbol)) {
-			mode = [obj[0] copy];
-
-			*stop = YES;
-		}
-	}];
+	unichar mode = [self modeCharacterFromUserPrefixCharacter:[symbol characterAtIndex:0]];
 
-	return mode;
+	if (mode == 0) {
+		return nil;
+	} else {
+		return [NSString stringWithCharacters:&mode length:1];
+	}
 }
 
 - (BOOL)symbolIsUserPrefixCharacter:(NSString *)symbol
@@ -362,28 +541,10 @@ NSString * const IRCISupportRawSuffix = @"are supported by this server";
 
 - (NSInteger)rankForUserPrefixWithMode:(NSString *)mode
 {
-#define _defaultStart			100
-
-	NSObjectIsEmptyAssertReturn(mode, _defaultStart);
-
-	__block BOOL foundResult = NO;
-
-	__block NSInteger rankValue = _defaultStart;
-
-	[self.userModePrefixes enumerateObjectsUsingBlock:^(NSArray *obj, NSUInteger idx, BOOL *stop) {
-		if (NSObjectsAreEqual(obj[0], mode)) {
-			*stop = YES;
-
-			foundResult = YES;
-		} else {
-			rankValue -= 1;
-		}
-	}];
-
-#undef _defaultStart
+	NSObjectIsEmptyAssertReturn(mode, _channelUserModeValue);
 
-	if (foundResult) {
-		return rankValue;
+	if ([mode length] == 1) {
+		return [self rankForUserPrefixModeCharacter:[mode characterAtIndex:0]];
 	} else {
 		return 0; // Nothing was found at all for input.
 	}
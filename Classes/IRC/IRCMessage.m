@@ -38,6 +38,36 @@
 
 #import "TextualApplication.h"
 
+#define _maximumParameterRangeCount			32
+
+@interface IRCMessage ()
+{
+	IRCPrefix *_sender;
+	NSString *_command;
+	NSArray *_params;
+
+	/* The line occupies _backingRange of _backingData. Lines read together
+	 from the socket share one backing buffer. rawData is only carved out
+	 of it when something asks for it. */
+	NSData *_backingData;
+	NSRange _backingRange;
+	NSData *_rawData;
+
+	NSRange _senderRange;
+	NSRange _commandRange;
+	NSRange _parameterRanges[_maximumParameterRangeCount];
+	NSUInteger _parameterRangeCount;
+	BOOL _parameterRangesIncludeTrailing;
+
+	IRCMessageParseOptions _parseOptions;
+
+	NSStringEncoding _primaryEncoding;
+	NSStringEncoding _fallbackEncoding;
+
+	BOOL _stripFormatting;
+}
+@end
+
 @implementation IRCMessage
 
 - (instancetype)initWithLine:(NSString *)line
@@ -54,10 +84,32 @@
 	[self parseLine:line forClient:nil];
 }
 
+- (void)resetLazyParsingState
+{
+	_backingData = nil;
+	_backingRange = NSMakeRange(0, 0);
+
+	_rawData = nil;
+
+	_senderRange = NSMakeRange(NSNotFound, 0);
+	_commandRange = NSMakeRange(NSNotFound, 0);
+
+	_parameterRangeCount = 0;
+	_parameterRangesIncludeTrailing = NO;
+}
+
 - (void)parseLine:(NSString *)line forClient:(IRCClient *)client
+{
+	[self parseLine:line parsesServerTime:[client isCapacityEnabled:ClientIRCv3SupportedCapacityServerTime]];
+}
+
+- (void)parseLine:(NSString *)line parsesServerTime:(BOOL)parsesServerTime
 {
 	/* Establish base pair. */
+	[self resetLazyParsingState];
+
 	self.command = nil;
+	self.params = nil;
 
 	self.isHistoric = NO;
 
@@ -109,7 +161,7 @@
 		}
 		
 		/* Now that we have values, we can check against our capacities. */
-		if ([client isCapacityEnabled:ClientIRCv3SupportedCapacityServerTime]) {
+		if (parsesServerTime) {
 			/* We support two time extensions. The time= value is the date and
 			 time in the format as defined by ISO 8601:2004(E) 4.3.2. */
 			/* The t= value is a legacy value in a epoch time. We always favor
@@ -163,24 +215,7 @@
 		
 		NSString *t = [userInfo substringFromIndex:1];
 
-		NSString *nicknameInt = nil;
-		NSString *usernameInt = nil;
-		NSString *addressInt = nil;
-
-		[sender setHostmask:t]; // Declare entire section as host.
-		
-		[sender setIsServer:NO]; // Do not set as server until host is parsed...
-		
-		/* Parse the user info into their appropriate sections or return NO if we can't. */
-		if ([t hostmaskComponents:&nicknameInt username:&usernameInt address:&addressInt]) {
-			[sender setNickname:nicknameInt];
-			[sender setUsername:usernameInt];
-			[sender setAddress:addressInt];
-        } else {
-			[sender setNickname:t];
-			
-			[sender setIsServer:YES];
-		}
+		[self populatePrefix:sender withHostmask:t];
 	}
 	
 	self.sender = sender;
@@ -222,6 +257,434 @@
 	params = nil;
 }
 
+#pragma mark -
+#pragma mark Byte Level Parser
+
+NS_INLINE NSUInteger _skipSpaces(const char *bytes, NSUInteger offset, NSUInteger length)
+{
+	while (offset < length && bytes[offset] == ' ') {
+		offset += 1;
+	}
+
+	return offset;
+}
+
+NS_INLINE NSRange _nextToken(const char *bytes, NSUInteger *offset, NSUInteger length)
+{
+	/* Mirrors the behavior of -getToken: the token ends at the first space and
+	 any run of spaces that follows the token is consumed along with it. */
+	NSUInteger tokenStart = *offset;
+
+	const char *space = memchr((bytes + tokenStart), ' ', (length - tokenStart));
+
+	NSUInteger tokenEnd = ((space) ? (space - bytes) : length);
+
+	*offset = _skipSpaces(bytes, tokenEnd, length);
+
+	return NSMakeRange(tokenStart, (tokenEnd - tokenStart));
+}
+
+- (void)parseData:(NSData *)data forClient:(IRCClient *)client
+{
+	IRCMessageParseOptions options;
+
+	if (client) {
+		options = [client receivedLineParseOptions];
+	} else {
+		options.primaryEncoding = NSUTF8StringEncoding;
+		options.fallbackEncoding = NSISOLatin1StringEncoding;
+
+		options.stripFormatting = [TPCPreferences removeAllFormatting];
+
+		options.parseServerTime = NO;
+	}
+
+	[self parseData:data options:options];
+}
+
+- (IRCMessageParseOptions)parseOptions
+{
+	return _parseOptions;
+}
+
+- (void)parseData:(NSData *)data options:(IRCMessageParseOptions)options
+{
+	/* The data given to this method may reference a buffer that is reused
+	 once parsing is finished so the bytes are always copied. A plain -copy
+	 would retain a buffer that was created without copying its bytes. */
+	NSData *lineData = [NSData dataWithBytes:[data bytes] length:[data length]];
+
+	[self parseData:lineData range:NSMakeRange(0, [lineData length]) options:options];
+}
+
+- (void)parseAgainWithOptions:(IRCMessageParseOptions)options
+{
+	NSData *backingData = _backingData;
+
+	PointerIsEmptyAssert(backingData);
+
+	[self parseData:backingData range:_backingRange options:options];
+}
+
+- (void)parseData:(NSData *)data range:(NSRange)range options:(IRCMessageParseOptions)options
+{
+	/* Establish base pair. */
+	[self resetLazyParsingState];
+
+	_sender = nil;
+	_command = nil;
+	_params = nil;
+
+	self.numericReply = 0;
+
+	self.isHistoric = NO;
+
+	_backingData = data;
+	_backingRange = range;
+
+	_parseOptions = options;
+
+	_primaryEncoding = options.primaryEncoding;
+	_fallbackEncoding = options.fallbackEncoding;
+
+	_stripFormatting = options.stripFormatting;
+
+	const char *bytes = [self lineBytes];
+
+	NSUInteger length = range.length;
+
+	NSUInteger offset = 0;
+
+	/* Begin parsing. */
+	if (length > 0 && bytes[0] == '@') {
+		NSRange tagsRange = _nextToken(bytes, &offset, length);
+
+		/* Check for malformed message. */
+		if (tagsRange.length <= 1) {
+			return; // Do not continue as message is malformed.
+		}
+
+		if (options.parseServerTime) {
+			[self parseTagsInRange:NSMakeRange((tagsRange.location + 1), (tagsRange.length - 1)) ofBytes:bytes];
+		}
+	}
+
+	/* Set a date if there is none already set. */
+	if (self.receivedAt == nil) {
+		self.receivedAt = [NSDate date];
+	}
+
+	if (offset < length && bytes[offset] == ':') {
+		NSRange senderRange = _nextToken(bytes, &offset, length);
+
+		/* Check that the input is valid. */
+		if (senderRange.length <= 1) {
+			return; // Current input is malformed, do nothing with it.
+		}
+
+		_senderRange = NSMakeRange((senderRange.location + 1), (senderRange.length - 1));
+	}
+
+	if (offset >= length) {
+		return; // Current input is malformed, do nothing with it.
+	}
+
+	_commandRange = _nextToken(bytes, &offset, length);
+
+	/* Check that the input is valid. */
+	if (_commandRange.length <= 1) {
+		return; // Current input is malformed, do nothing with it.
+	}
+
+	/* Numerics are computed from the bytes so that they do not
+	 require the command to be turned into a string. */
+	NSInteger numericReply = 0;
+
+	for (NSUInteger i = _commandRange.location; i < NSMaxRange(_commandRange); i++) {
+		if (bytes[i] < '0' || bytes[i] > '9') {
+			numericReply = 0;
+
+			break;
+		}
+
+		numericReply = ((numericReply * 10) + (bytes[i] - '0'));
+	}
+
+	self.numericReply = numericReply;
+
+	/* Record the location of each parameter. */
+	while (offset < length) {
+		if (_parameterRangeCount == _maximumParameterRangeCount) {
+			/* An absurd number of parameters were sent. Let the string
+			 parser deal with it instead of growing the range storage. */
+			NSString *line = [self stringFromBytesInRange:NSMakeRange(0, length)];
+
+			if (_stripFormatting) {
+				line = [line stripIRCEffects];
+			}
+
+			[self parseLine:line parsesServerTime:options.parseServerTime];
+
+			_backingData = data;
+			_backingRange = range;
+
+			return;
+		}
+
+		if (bytes[offset] == ':') {
+			_parameterRanges[_parameterRangeCount] = NSMakeRange((offset + 1), (length - offset - 1));
+
+			_parameterRangesIncludeTrailing = YES;
+		} else {
+			_parameterRanges[_parameterRangeCount] = _nextToken(bytes, &offset, length);
+		}
+
+		_parameterRangeCount += 1;
+
+		if (_parameterRangesIncludeTrailing) {
+			break;
+		}
+	}
+
+	/* An empty array marks the message as well formed. It is
+	 replaced with the actual parameters when they are accessed. */
+	_params = @[];
+}
+
+- (void)parseTagsInRange:(NSRange)range ofBytes:(const char *)bytes
+{
+	/* Only the tags used for server-time are of interest so the tags are
+	 scanned in place and only the value of the time tag becomes a string. */
+	NSRange timeRange = NSMakeRange(NSNotFound, 0);
+	NSRange legacyTimeRange = NSMakeRange(NSNotFound, 0);
+
+	NSUInteger tagStart = range.location;
+
+	NSUInteger tagsEnd = NSMaxRange(range);
+
+	while (tagStart < tagsEnd) {
+		const char *semicolon = memchr((bytes + tagStart), ';', (tagsEnd - tagStart));
+
+		NSUInteger tagEnd = ((semicolon) ? (semicolon - bytes) : tagsEnd);
+
+		const char *equalSign = memchr((bytes + tagStart), '=', (tagEnd - tagStart));
+
+		/* A tag without a value, or with more than one equal sign,
+		 is ignored just as it is by the string based parser. */
+		if (equalSign) {
+			NSUInteger keyLength = (equalSign - (bytes + tagStart));
+
+			NSUInteger valueStart = (keyLength + tagStart + 1);
+
+			if (memchr((bytes + valueStart), '=', (tagEnd - valueStart)) == NULL) {
+				NSRange valueRange = NSMakeRange(valueStart, (tagEnd - valueStart));
+
+				if (keyLength == 4 && memcmp((bytes + tagStart), "time", 4) == 0) {
+					timeRange = valueRange;
+				} else if (keyLength == 1 && bytes[tagStart] == 't') {
+					legacyTimeRange = valueRange;
+				}
+			}
+		}
+
+		tagStart = (tagEnd + 1);
+	}
+
+	/* We always favor the new time= format over the old. */
+	NSDate *date = nil;
+
+	if (timeRange.location != NSNotFound) {
+		date = [TXSharedISOStandardDateFormatter() dateFromString:[self stringFromBytesInRange:timeRange]];
+	} else if (legacyTimeRange.location != NSNotFound) {
+		date = [NSDate dateWithTimeIntervalSince1970:[[self stringFromBytesInRange:legacyTimeRange] doubleValue]];
+	}
+
+	if (date) {
+		self.receivedAt = date;
+
+		self.isHistoric = YES;
+	}
+}
+
+- (NSString *)stringFromBytesInRange:(NSRange)range
+{
+	const char *bytes = ([self lineBytes] + range.location);
+
+	NSString *s = [THOUnicodeHelper stringWithBytes:bytes length:range.length primaryEncoding:_primaryEncoding fallbackEncoding:_fallbackEncoding];
+
+	if (s == nil) {
+		return NSStringEmptyPlaceholder;
+	}
+
+	return s;
+}
+
+#pragma mark -
+#pragma mark Lazy Materialization
+
+- (const char *)lineBytes
+{
+	return ((const char *)[_backingData bytes] + _backingRange.location);
+}
+
+- (NSData *)rawData
+{
+	@synchronized(self) {
+		if (_rawData == nil && _backingData) {
+			if (_backingRange.location == 0 && _backingRange.length == [_backingData length]) {
+				_rawData = _backingData;
+			} else {
+				_rawData = [_backingData subdataWithRange:_backingRange];
+			}
+		}
+
+		return _rawData;
+	}
+}
+
+- (NSUInteger)rawDataLength
+{
+	if (_backingData) {
+		return _backingRange.length;
+	} else {
+		return 0;
+	}
+}
+
+- (BOOL)hasUnmaterializedParams
+{
+	return (_backingData && _parameterRangeCount > 0 && [_params count] == 0);
+}
+
+- (NSArray *)params
+{
+	@synchronized(self) {
+		if ([self hasUnmaterializedParams]) {
+			NSMutableArray *params = [NSMutableArray arrayWithCapacity:_parameterRangeCount];
+
+			for (NSUInteger i = 0; i < _parameterRangeCount; i++) {
+				NSString *param = [self stringFromBytesInRange:_parameterRanges[i]];
+
+				if (_stripFormatting) {
+					param = [param stripIRCEffects];
+				}
+
+				[params addObject:param];
+			}
+
+			_params = [params copy];
+
+			_parameterRangeCount = 0;
+		}
+
+		return _params;
+	}
+}
+
+- (void)setParams:(NSArray *)params
+{
+	@synchronized(self) {
+		_parameterRangeCount = 0;
+
+		_params = [params copy];
+	}
+}
+
+- (NSString *)command
+{
+	@synchronized(self) {
+		if (_command == nil && _commandRange.location != NSNotFound && _backingData) {
+			const char *bytes = [self lineBytes];
+
+			/* Known commands map straight to a shared instance. */
+			NSString *command = [IRCCommandIndex commandWithBytes:(bytes + _commandRange.location) length:_commandRange.length];
+
+			if (command) {
+				_command = command;
+
+				return _command;
+			}
+
+			command = [self stringFromBytesInRange:_commandRange];
+
+			/* Only pay for -uppercaseString when there is something to change. */
+			for (NSUInteger i = _commandRange.location; i < NSMaxRange(_commandRange); i++) {
+				if (bytes[i] >= 'a' && bytes[i] <= 'z') {
+					command = [command uppercaseString];
+
+					break;
+				}
+			}
+
+			_command = command;
+		}
+
+		return _command;
+	}
+}
+
+- (void)setCommand:(NSString *)command
+{
+	@synchronized(self) {
+		_commandRange = NSMakeRange(NSNotFound, 0);
+
+		_command = [command copy];
+	}
+}
+
+- (IRCPrefix *)sender
+{
+	@synchronized(self) {
+		if (_sender == nil && _backingData) {
+			IRCPrefix *sender = [IRCPrefix new];
+
+			if (_senderRange.location != NSNotFound) {
+				NSString *t = [self stringFromBytesInRange:_senderRange];
+
+				[self populatePrefix:sender withHostmask:t];
+			}
+
+			_sender = sender;
+		}
+
+		return _sender;
+	}
+}
+
+- (void)setSender:(IRCPrefix *)sender
+{
+	@synchronized(self) {
+		_senderRange = NSMakeRange(NSNotFound, 0);
+
+		_sender = [sender copy];
+	}
+}
+
+- (void)populatePrefix:(IRCPrefix *)sender withHostmask:(NSString *)t
+{
+	NSString *nicknameInt = nil;
+	NSString *usernameInt = nil;
+	NSString *addressInt = nil;
+
+	[sender setHostmask:t]; // Declare entire section as host.
+
+	[sender setIsServer:NO]; // Do not set as server until host is parsed...
+
+	/* Parse the user info into their appropriate sections or return NO if we can't. */
+	if ([t hostmaskComponents:&nicknameInt username:&usernameInt address:&addressInt]) {
+		[sender setNickname:nicknameInt];
+		[sender setUsername:usernameInt];
+		[sender setAddress:addressInt];
+	} else {
+		[sender setNickname:t];
+
+		[sender setIsServer:YES];
+	}
+}
+
+#pragma mark -
+#pragma mark Accessors
+
 - (NSInteger)paramsCount
 {
 	return [self.params count];
@@ -262,28 +725,57 @@
 	return s;
 }
 
+- (BOOL)hasEmptySender
+{
+	/* Lines parsed from data which do not have a prefix do not
+	 need an empty prefix object to answer the accessors below. */
+	@synchronized(self) {
+		return (_backingData && _sender == nil && _senderRange.location == NSNotFound);
+	}
+}
+
 - (NSString *)senderNickname
 {
+	if ([self hasEmptySender]) {
+		return nil;
+	}
+
 	return self.sender.nickname;
 }
 
 - (NSString *)senderUsername
 {
+	if ([self hasEmptySender]) {
+		return nil;
+	}
+
 	return self.sender.username;
 }
 
 - (NSString *)senderAddress
 {
+	if ([self hasEmptySender]) {
+		return nil;
+	}
+
 	return self.sender.address;
 }
 
 - (NSString *)senderHostmask
 {
+	if ([self hasEmptySender]) {
+		return nil;
+	}
+
 	return self.sender.hostmask;
 }
 
 - (BOOL)senderIsServer
 {
+	if ([self hasEmptySender]) {
+		return NO;
+	}
+
 	return self.sender.isServer;
 }
 
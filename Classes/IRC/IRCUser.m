@@ -40,8 +40,30 @@
 
 #define _colorNumberMax				 30
 
+#define _userRankLookupTableSize	128
+
+/* +Y/+y is used by InspIRCd-2.0 to represent an IRCop
+   +O is used by binircd-1.0.0 for channel owner */
+static const IRCUserRank IRCUserRankForModeCharacter[_userRankLookupTableSize] = {
+	['y'] = IRCUserIRCopByModeRank,
+	['Y'] = IRCUserIRCopByModeRank,
+	['q'] = IRCUserChannelOwnerRank,
+	['O'] = IRCUserChannelOwnerRank,
+	['a'] = IRCUserSuperOperatorRank,
+	['o'] = IRCUserNormalOperatorRank,
+	['h'] = IRCUserHalfOperatorRank,
+	['v'] = IRCUserVoicedRank,
+};
+
 @interface IRCUser ()
+{
+	/* Bitmask of every rank in -modes; refreshed by -setModes: so that
+	 rank checks and member sorting never have to scan the mode string. */
+	IRCUserRank _cachedRanks;
+}
+
 @property (nonatomic, weak) IRCISupportInfo *supportInfo;
+@property (nonatomic, strong) IRCUserIdentity *identity;
 @end
 
 @implementation IRCUser
@@ -50,6 +72,10 @@
 {
 	if ((self = [super init])) {
 		self.colorNumber = -1;
+
+		self.identity = [IRCUserIdentity new];
+
+		_cachedRanks = IRCUserNoRank;
 		
 		self.lastWeightFade = CFAbsoluteTimeGetCurrent();
 	}
@@ -60,6 +86,10 @@
 - (instancetype)initWithUser:(IRCUser *)otherUser
 {
 	if ((self = [super init])) {
+		self.identity = [IRCUserIdentity new];
+
+		_cachedRanks = IRCUserNoRank;
+
 		[self migrate:otherUser];
 	}
 	
@@ -77,6 +107,72 @@
 	return newUser;
 }
 
+#pragma mark -
+#pragma mark Identity
+
+- (void)shareIdentity:(IRCUserIdentity *)identity
+{
+	PointerIsEmptyAssert(identity);
+
+	/* Whatever this user learned before joining the shared identity
+	 (such as the hostmask of a JOIN) is newer than what it holds. */
+	[identity mergeIdentity:self.identity];
+
+	self.identity = identity;
+}
+
+- (NSString *)username
+{
+	return [self.identity username];
+}
+
+- (void)setUsername:(NSString *)username
+{
+	[self.identity setUsername:username];
+}
+
+- (NSString *)address
+{
+	return [self.identity address];
+}
+
+- (void)setAddress:(NSString *)address
+{
+	[self.identity setAddress:address];
+}
+
+- (NSString *)realname
+{
+	return [self.identity realname];
+}
+
+- (void)setRealname:(NSString *)realname
+{
+	[self.identity setRealname:realname];
+}
+
+- (BOOL)isCop
+{
+	return [self.identity isCop];
+}
+
+- (void)setIsCop:(BOOL)isCop
+{
+	[self.identity setIsCop:isCop];
+}
+
+- (BOOL)isAway
+{
+	return [self.identity isAway];
+}
+
+- (void)setIsAway:(BOOL)isAway
+{
+	[self.identity setIsAway:isAway];
+}
+
+#pragma mark -
+
 - (NSString *)hostmask
 {
 	NSObjectIsEmptyAssertReturn(self.nickname, nil);
@@ -106,6 +202,26 @@
 	return nil;
 }
 
+- (void)setModes:(NSString *)modes
+{
+	_modes = [modes copy];
+
+	IRCUserRank ranks = 0;
+
+	NSInteger modesLength = [_modes length];
+
+	for (NSInteger i = 0; i < modesLength; i++) {
+		ranks |= [self rankWithModeCharacter:[_modes characterAtIndex:i]];
+	}
+
+	/* IRCUserNoRank only stands alone. */
+	if (ranks == 0 || ranks == IRCUserNoRank) {
+		_cachedRanks = IRCUserNoRank;
+	} else {
+		_cachedRanks = (ranks & ~IRCUserNoRank);
+	}
+}
+
 - (BOOL)userModesContainsMode:(NSString *)mode
 {
 	NSParameterAssert(([mode length] == 1));
@@ -139,31 +255,21 @@
 
 - (NSInteger)channelRank
 {
-	NSString *highestRank = [self highestRankedUserMode];
-
-	if (highestRank) {
-		return [self.supportInfo rankForUserPrefixWithMode:highestRank];
-	} else {
+	if (NSObjectIsEmpty(self.modes)) {
 		return 0; // Furthest that can be gone down.
+	} else {
+		return [self.supportInfo rankForUserPrefixModeCharacter:[self.modes characterAtIndex:0]];
 	}
 }
 
 - (BOOL)isOp
 {
-	if (NSObjectIsEmpty(self.modes)) {
-		return NO;
-	} else {
-		return [self.modes containsCharacters:@"qOao"];
-	}
+	return ((_cachedRanks & (IRCUserChannelOwnerRank | IRCUserSuperOperatorRank | IRCUserNormalOperatorRank)) > 0);
 }
 
 - (BOOL)isHalfOp 
 {
-	if (NSObjectIsEmpty(self.modes)) {
-		return NO;
-	} else {
-		return [self.modes containsCharacters:@"qOaoh"];
-	}
+	return ((_cachedRanks & (IRCUserChannelOwnerRank | IRCUserSuperOperatorRank | IRCUserNormalOperatorRank | IRCUserHalfOperatorRank)) > 0);
 }
 
 - (BOOL)q
@@ -193,61 +299,40 @@
 
 - (IRCUserRank)rank
 {
-	NSString *highestMark = [self highestRankedUserMode];
-
-	return [self rankWithMark:highestMark];
+	if (NSObjectIsEmpty(self.modes)) {
+		return IRCUserNoRank; // Furthest that can be gone down.
+	} else {
+		return [self rankWithModeCharacter:[self.modes characterAtIndex:0]];
+	}
 }
 
 - (IRCUserRank)ranks
 {
-	IRCUserRank ranks = 0;
-
-	if (NSObjectIsEmpty(self.modes) == NO) {
-		for (NSInteger i = 0; i < [self.modes length]; i++) {
-			NSString *cc = [self.modes stringCharacterAtIndex:i];
+	return _cachedRanks;
+}
 
-			IRCUserRank rank = [self rankWithMark:cc];
+- (IRCUserRank)rankWithModeCharacter:(unichar)mode
+{
+	IRCUserRank rank = 0;
 
-			if (NSDissimilarObjects(rank, IRCUserNoRank)) {
-				ranks |= rank;
-			}
-		}
+	if (mode < _userRankLookupTableSize) {
+		rank = IRCUserRankForModeCharacter[mode];
 	}
 
-	if (ranks == 0) {
-		ranks |= IRCUserNoRank;
+	if (rank == 0) {
+		return IRCUserNoRank;
+	} else {
+		return rank;
 	}
-
-	return ranks;
 }
 
 - (IRCUserRank)rankWithMark:(NSString *)mark
 {
-	if (mark == nil) {
-		return IRCUserNoRank; // Furthest that can be gone down.
-	}
-
-#define _mm(mode)			NSObjectsAreEqual(mark, (mode))
-
-	// +Y/+y is used by InspIRCd-2.0 to represent an IRCop
-	// +O is used by binircd-1.0.0 for channel owner
-	if (_mm(@"y") || _mm(@"Y")) {
-		return IRCUserIRCopByModeRank;
-	} else if (_mm(@"q") || _mm(@"O")) {
-		return IRCUserChannelOwnerRank;
-	} else if (_mm(@"a")) {
-		return IRCUserSuperOperatorRank;
-	} else if (_mm(@"o")) {
-		return IRCUserNormalOperatorRank;
-	} else if (_mm(@"h")) {
-		return IRCUserHalfOperatorRank;
-	} else if (_mm(@"v")) {
-		return IRCUserVoicedRank;
+	if ([mark length] == 1) {
+		return [self rankWithModeCharacter:[mark characterAtIndex:0]];
 	} else {
-		return IRCUserNoRank;
+		return IRCUserNoRank; // Furthest that can be gone down.
 	}
-
-#undef _mm
 }
 
 - (NSInteger)colorNumber
@@ -359,13 +444,18 @@
 	if ([other isKindOfClass:[IRCUser class]] == NO) {
 		return NSOrderedSame;
 	} else {
-		NSNumber *localRank = [NSNumber numberWithInteger:[self channelRank]];
+		NSInteger localRank = [self channelRank];
 
-		NSNumber *remoteRank = [NSNumber numberWithInteger:[other channelRank]];
+		NSInteger remoteRank = [other channelRank];
 
-		NSComparisonResult normalRank = [localRank compare:remoteRank];
+		/* Higher ranks sort first. */
+		NSComparisonResult invertedRank = NSOrderedSame;
 
-		NSComparisonResult invertedRank = NSInvertedComparisonResult(normalRank);
+		if (localRank > remoteRank) {
+			invertedRank = NSOrderedAscending;
+		} else if (localRank < remoteRank) {
+			invertedRank = NSOrderedDescending;
+		}
 
 		BOOL favorIRCop = [TPCPreferences memberListSortFavorsServerStaff];
 
@@ -383,9 +473,19 @@
 
 + (NSComparator)nicknameLengthComparator
 {
-	return [^(IRCUser *obj1, IRCUser *obj2){
-		return ([[obj1 nickname] length] <=
-				[[obj2 nickname] length]);
+	/* Longest nickname first. Nicknames of equal length are ordered
+	 alphabetically so that the order is total and can be searched. */
+	return [^NSComparisonResult(IRCUser *obj1, IRCUser *obj2){
+		NSUInteger length1 = [[obj1 nickname] length];
+		NSUInteger length2 = [[obj2 nickname] length];
+
+		if (length1 > length2) {
+			return NSOrderedAscending;
+		} else if (length1 < length2) {
+			return NSOrderedDescending;
+		} else {
+			return [[obj1 nickname] caseInsensitiveCompare:[obj2 nickname]];
+		}
 	} copy];
 }
 
@@ -394,17 +494,13 @@
 	self.supportInfo = [from supportInfo];
 	
 	self.nickname = [from nickname];
-	self.username = [from username];
-	self.address = [from address];
-
-	self.realname = [from realname];
 
 	self.colorNumber = [from colorNumber];
 
 	self.modes = [from modes];
 
-	self.isCop = [from isCop];
-	self.isAway = [from isAway];
+	/* Users that share an identity already agree on everything in it. */
+	[self.identity mergeIdentity:[from identity]];
 }
 
 - (NSString *)description
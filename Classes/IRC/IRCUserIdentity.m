@@ -0,0 +1,88 @@
+/* ********************************************************************* 
+                  _____         _               _
+                 |_   _|____  _| |_ _   _  __ _| |
+                   | |/ _ \ \/ / __| | | |/ _` | |
+                   | |  __/>  <| |_| |_| | (_| | |
+                   |_|\___/_/\_\\__|\__,_|\__,_|_|
+
+ Copyright (c) 2010 - 2015 Codeux Software, LLC & respective contributors.
+        Please see Acknowledgements.pdf for additional information.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Textual and/or "Codeux Software, LLC", nor the 
+      names of its contributors may be used to endorse or promote products 
+      derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+ *********************************************************************** */
+
+#import "TextualApplication.h"
+
+@interface IRCUserIdentity ()
+@property (nonatomic, assign) BOOL isCopKnown;
+@property (nonatomic, assign) BOOL isAwayKnown;
+@end
+
+@implementation IRCUserIdentity
+
+- (void)setIsCop:(BOOL)isCop
+{
+	_isCop = isCop;
+
+	self.isCopKnown = YES;
+}
+
+- (void)setIsAway:(BOOL)isAway
+{
+	_isAway = isAway;
+
+	self.isAwayKnown = YES;
+}
+
+- (void)mergeIdentity:(IRCUserIdentity *)otherIdentity
+{
+	PointerIsEmptyAssert(otherIdentity);
+
+	NSAssertReturn(NSDissimilarObjects(self, otherIdentity));
+
+	if ([otherIdentity username]) {
+		self.username = [otherIdentity username];
+	}
+
+	if ([otherIdentity address]) {
+		self.address = [otherIdentity address];
+	}
+
+	if ([otherIdentity realname]) {
+		self.realname = [otherIdentity realname];
+	}
+
+	if ([otherIdentity isCopKnown]) {
+		self.isCop = [otherIdentity isCop];
+	}
+
+	if ([otherIdentity isAwayKnown]) {
+		self.isAway = [otherIdentity isAway];
+	}
+}
+
+@end
@@ -323,6 +323,8 @@ NSString * const IRCWorldControllerClientListDefaultsStorageKey = @"clients";
 
 - (void)preferencesChanged
 {
+	[TPCPreferences rebuildPreferencesSnapshot];
+
 	[menuController() preferencesChanged];
 	
 	@synchronized(self.clients) {
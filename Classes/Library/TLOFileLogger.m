@@ -49,13 +49,144 @@ NSString * const TLOFileLoggerNoticeNicknameFormat		= @"-%n-";
 NSString * const TLOFileLoggerISOStandardClockFormat		= @"[%Y-%m-%dT%H:%M:%S%z]"; // 2008-07-09T16:13:30+12:00
 NSString * const TLOFileLoggerTwentyFourHourClockFormat		= @"[%H:%M:%S]";
 
+/* All transcript writes happen on one serial queue shared by every logger. Lines are
+ rendered by the caller then appended to a buffer belonging to their logger on that
+ queue. A buffer is written out once it reaches the size threshold, or by a flush
+ scheduled shortly after the first line enters an empty buffer. */
+#define _writeBufferFlushThreshold			(32 * 1024)
+#define _writeBufferFlushInterval			1.0
+
+static void *_writerQueueSpecificKey = &_writerQueueSpecificKey;
+
+@interface TLOFileLogger ()
+/* Only accessed on the writer queue. */
+@property (nonatomic, strong) NSMutableData *writeBuffer;
+@property (nonatomic, copy) NSURL *writeFolder; // Folder of the lines in writeBuffer
+@property (nonatomic, copy) NSURL *fileFolder; // Folder of the open file
+@property (nonatomic, copy) NSString *fileDayIdentifier;
+
+/* Only accessed on the main thread. */
+@property (nonatomic, copy) NSURL *resolvedWriteFolder;
+@property (nonatomic, strong) NSURL *resolvedWriteFolderBase;
+@property (nonatomic, copy) NSString *resolvedWriteFolderServerName;
+@property (nonatomic, copy) NSString *resolvedWriteFolderChannelName;
+@end
+
+static BOOL _namesAreEqual(NSString *name1, NSString *name2)
+{
+	return (name1 == name2 || [name1 isEqualToString:name2]);
+}
+
 @implementation TLOFileLogger
 
+#pragma mark -
+#pragma mark Writer Queue
+
++ (dispatch_queue_t)writerQueue
+{
+	static dispatch_queue_t writerQueue = NULL;
+
+	static dispatch_once_t onceToken;
+
+	dispatch_once(&onceToken, ^{
+		writerQueue = dispatch_queue_create("TLOFileLogger.writerQueue", DISPATCH_QUEUE_SERIAL);
+
+		dispatch_queue_set_specific(writerQueue, _writerQueueSpecificKey, _writerQueueSpecificKey, NULL);
+	});
+
+	return writerQueue;
+}
+
++ (NSMutableSet *)loggersWithPendingWrites
+{
+	/* Only accessed on the writer queue. The set holds a strong reference
+	 so a logger cannot go away while it still has data buffered. */
+	static NSMutableSet *pendingLoggers = nil;
+
+	static dispatch_once_t onceToken;
+
+	dispatch_once(&onceToken, ^{
+		pendingLoggers = [NSMutableSet new];
+	});
+
+	return pendingLoggers;
+}
+
++ (void)performBlockOnWriterQueue:(dispatch_block_t)block synchronously:(BOOL)synchronously
+{
+	if (dispatch_get_specific(_writerQueueSpecificKey)) {
+		block();
+	} else if (synchronously) {
+		dispatch_sync([self writerQueue], block);
+	} else {
+		dispatch_async([self writerQueue], block);
+	}
+}
+
++ (NSString *)currentDayIdentifier
+{
+	/* Only accessed on the writer queue. The name of today's file is worked out
+	 once then reused until the cached end of the day has passed. */
+	static NSString *dayIdentifier = nil;
+
+	static CFAbsoluteTime dayEndsAt = 0;
+
+	CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+
+	if (dayIdentifier == nil || now >= dayEndsAt) {
+		NSDate *currentDate = [NSDate dateWithTimeIntervalSinceReferenceDate:now];
+
+		NSDate *startOfDay = nil;
+
+		NSTimeInterval lengthOfDay = 0;
+
+		[[NSCalendar currentCalendar] rangeOfUnit:NSDayCalendarUnit startDate:&startOfDay interval:&lengthOfDay forDate:currentDate];
+
+		dayEndsAt = ([startOfDay timeIntervalSinceReferenceDate] + lengthOfDay);
+
+		dayIdentifier = TXFormattedTimestamp(currentDate, @"%Y-%m-%d");
+	}
+
+	return dayIdentifier;
+}
+
++ (void)flushAllPendingWrites
+{
+	[self performBlockOnWriterQueue:^{
+		NSArray *pendingLoggers = [[self loggersWithPendingWrites] allObjects];
+
+		for (TLOFileLogger *logger in pendingLoggers) {
+			[logger flushWriteBuffer];
+		}
+	} synchronously:YES];
+}
+
++ (void)schedulePendingWritesFlush
+{
+	static BOOL flushScheduled = NO;
+
+	NSAssertReturn(flushScheduled == NO);
+
+	flushScheduled = YES;
+
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_writeBufferFlushInterval * NSEC_PER_SEC)), [self writerQueue], ^{
+		flushScheduled = NO;
+
+		[self flushAllPendingWrites];
+	});
+}
+
 #pragma mark -
 #pragma mark Plain Text API
 
 - (void)writeLine:(TVCLogLine *)logLine
 {
+	PointerIsEmptyAssert(logLine);
+
+	/* The transcript body is rendered on the calling thread. It looks up the
+	 member who sent the line and reads preferences and theme settings which
+	 are not safe to touch from the writer queue. Rendering it now also means
+	 the mode symbol of the member is the one they had when the line came in. */
 	NSString *lineString = [logLine renderedBodyForTranscriptLogInChannel:self.channel];
 
 	[self writePlainTextLine:lineString];
@@ -63,17 +194,75 @@ NSString * const TLOFileLoggerTwentyFourHourClockFormat		= @"[%H:%M:%S]";
 
 - (void)writePlainTextLine:(NSString *)s
 {
-	[self reopenIfNeeded];
+	NSObjectIsEmptyAssert(s);
+
+	NSString *lineString = [s copy];
+
+	/* The folder is resolved with the line so that a line printed after
+	 a query, channel, or server was renamed goes to the new transcript. */
+	NSURL *writeFolder = [self resolveWriteFolder];
+
+	PointerIsEmptyAssert(writeFolder);
+
+	[TLOFileLogger performBlockOnWriterQueue:^{
+		[self appendPlainTextLine:lineString toFolder:writeFolder];
+	} synchronously:NO];
+}
+
+- (void)appendPlainTextLine:(NSString *)s toFolder:(NSURL *)writeFolder
+{
+	NSObjectIsEmptyAssert(s);
+
+	/* Lines already buffered are written to the folder they were meant
+	 for before a line for a different folder is added to the buffer. */
+	if ([writeFolder isEqual:self.writeFolder] == NO) {
+		[self flushWriteBuffer];
+
+		self.writeFolder = writeFolder;
+	}
+
+	if (self.writeBuffer == nil) {
+		self.writeBuffer = [NSMutableData dataWithCapacity:_writeBufferFlushThreshold];
+	}
+
+	NSString *writeString = [s stringByAppendingString:NSStringNewlinePlaceholder];
+
+	NSData *writeData = [writeString dataUsingEncoding:NSUTF8StringEncoding allowLossyConversion:YES];
+
+	NSObjectIsEmptyAssert(writeData);
+
+	[self.writeBuffer appendData:writeData];
+
+	if ([self.writeBuffer length] >= _writeBufferFlushThreshold) {
+		[self flushWriteBuffer];
+	} else {
+		[[TLOFileLogger loggersWithPendingWrites] addObject:self];
+
+		[TLOFileLogger schedulePendingWritesFlush];
+	}
+}
+
+- (void)flushWriteBuffer
+{
+	/* Only called on the writer queue. */
+	[[TLOFileLogger loggersWithPendingWrites] removeObject:self];
+
+	NSObjectIsEmptyAssert(self.writeBuffer);
+
+	[self reopenFileIfDayOrFolderChanged];
 
 	if (self.file) {
-		NSString *writeString = [NSString stringWithFormat:@"%@%@", s, NSStringNewlinePlaceholder];
-		
-		NSData *writeData = [writeString dataUsingEncoding:NSUTF8StringEncoding allowLossyConversion:YES];
+		@try {
+			[self.file writeData:self.writeBuffer];
+		}
+		@catch (NSException *exception) {
+			DebugLogToConsole(@"Error Writing File: %@", [exception reason]);
 
-		if (writeData) {
-			[self.file writeData:writeData];
+			[self closeFile];
 		}
 	}
+
+	[self.writeBuffer setLength:0];
 }
 
 #pragma mark -
@@ -81,12 +270,28 @@ NSString * const TLOFileLoggerTwentyFourHourClockFormat		= @"[%H:%M:%S]";
 
 - (void)reset
 {
-	if ( self.file) {
-		[self.file truncateFileAtOffset:0];
-	}
+	[TLOFileLogger performBlockOnWriterQueue:^{
+		[self.writeBuffer setLength:0];
+
+		[[TLOFileLogger loggersWithPendingWrites] removeObject:self];
+
+		if ( self.file) {
+			[self.file truncateFileAtOffset:0];
+		}
+	} synchronously:YES];
 }
 
 - (void)close
+{
+	/* Anything still buffered is written out before the file is closed. */
+	[TLOFileLogger performBlockOnWriterQueue:^{
+		[self flushWriteBuffer];
+
+		[self closeFile];
+	} synchronously:YES];
+}
+
+- (void)closeFile
 {
 	if ( self.file) {
 		[self.file closeFile];
@@ -94,34 +299,75 @@ NSString * const TLOFileLoggerTwentyFourHourClockFormat		= @"[%H:%M:%S]";
 	}
 
 	self.filename = nil;
+
+	self.fileFolder = nil;
+
+	self.fileDayIdentifier = nil;
 }
 
 - (void)reopenIfNeeded
 {
-	/* This call is designed to reopen the file pointer when using 
-	 the date as the filename. When the date changes, the log path
-	 will have to change as well. This handles that. */
+	/* This call is designed to reopen the file pointer when the
+	 location of the transcripts changes. Changes of the date and
+	 of names are picked up by the next line written. */
+	NSURL *writeFolder = [self resolveWriteFolder];
+
+	[TLOFileLogger performBlockOnWriterQueue:^{
+		NSAssertReturn(self.file);
+
+		if ([writeFolder isEqual:self.fileFolder] == NO) {
+			[self flushWriteBuffer];
+
+			self.writeFolder = writeFolder;
+
+			[self openFile];
+		}
+	} synchronously:NO];
+}
 
-	if ([[self buildFileName] isEqual:self.filename] == NO) {
-		[self open];
+- (void)reopenFileIfDayOrFolderChanged
+{
+	if (self.file == nil ||
+		[self.writeFolder isEqual:self.fileFolder] == NO ||
+		[[TLOFileLogger currentDayIdentifier] isEqualToString:self.fileDayIdentifier] == NO)
+	{
+		[self openFile];
 	}
 }
 
 - (void)open
+{
+	NSURL *writeFolder = [self resolveWriteFolder];
+
+	[TLOFileLogger performBlockOnWriterQueue:^{
+		[self flushWriteBuffer];
+
+		self.writeFolder = writeFolder;
+
+		[self openFile];
+	} synchronously:YES];
+}
+
+- (void)openFile
 {
 	/* Reset everything. */
-	[self close];
+	[self closeFile];
 
-	/* Where are we writing to? */
-	NSURL *path = [self fileWritePath];
+	/* Where are we writing to? The folder is resolved on the
+	 main thread by whoever handed us the lines to write. */
+	NSURL *writeFolder = self.writeFolder;
 
-	if (path == nil) {
+	if (writeFolder == nil) {
 		return; // Some type of error occured...
 	}
 
 	/* What will the filename be? The filename
 	 includes the folder being written to. */
-	self.filename = [self buildFileName];
+	self.fileDayIdentifier = [TLOFileLogger currentDayIdentifier];
+
+	self.fileFolder = writeFolder;
+
+	self.filename = [self fileNameInFolder:writeFolder];
 
 	/* Make sure the folder being written to exists. */
 	/* We extract the folder from self.filename for this
@@ -138,7 +384,7 @@ NSString * const TLOFileLoggerTwentyFourHourClockFormat		= @"[%H:%M:%S]";
 		if (fmerr) {
 			DebugLogToConsole(@"Error Creating Folder: %@", [fmerr localizedDescription]);
 
-			[self close]; // We couldn't create the folder. Destroy everything.
+			[self closeFile]; // We couldn't create the folder. Destroy everything.
 
 			return;
 		}
@@ -153,7 +399,7 @@ NSString * const TLOFileLoggerTwentyFourHourClockFormat		= @"[%H:%M:%S]";
 		if (fcerr) {
 			DebugLogToConsole(@"Error Creating File: %@", [fcerr localizedDescription]);
 
-			[self close]; // We couldn't create the file. Destroy everything.
+			[self closeFile]; // We couldn't create the file. Destroy everything.
 
 			return;
 		}
@@ -224,19 +470,38 @@ NSString * const TLOFileLoggerTwentyFourHourClockFormat		= @"[%H:%M:%S]";
 	return nil;
 }
 
-- (NSURL *)buildFileName
+- (NSURL *)resolveWriteFolder
 {
-	NSURL *buildPath = [self buildPath];
-	
-	if (buildPath) {
-		NSString *datetime = TXFormattedTimestamp([NSDate date], @"%Y-%m-%d");
+	/* Only called on the main thread which owns the names of the client and
+	 channel and the preferences read by -buildPath. The folder is cached and
+	 only built again when one of the names or the base location changes. */
+	NSURL *base = [self fileWritePath];
+
+	NSString *serverName = [self.client name];
+	NSString *channelName = [self.channel name];
+
+	if (self.resolvedWriteFolder == nil ||
+		self.resolvedWriteFolderBase != base ||
+		_namesAreEqual(self.resolvedWriteFolderServerName, serverName) == NO ||
+		_namesAreEqual(self.resolvedWriteFolderChannelName, channelName) == NO)
+	{
+		self.resolvedWriteFolder = [self buildPath];
+
+		self.resolvedWriteFolderBase = base;
 
-		NSString *filename = [NSString stringWithFormat:@"%@.txt", datetime];
-		
-		return [buildPath URLByAppendingPathComponent:filename isDirectory:NO];
+		self.resolvedWriteFolderServerName = serverName;
+		self.resolvedWriteFolderChannelName = channelName;
 	}
-	
-	return nil;
+
+	return self.resolvedWriteFolder;
+}
+
+- (NSURL *)fileNameInFolder:(NSURL *)writeFolder
+{
+	/* Only called on the writer queue. */
+	NSString *filename = [NSString stringWithFormat:@"%@.txt", [TLOFileLogger currentDayIdentifier]];
+
+	return [writeFolder URLByAppendingPathComponent:filename isDirectory:NO];
 }
 
 #pragma mark -
@@ -244,7 +509,9 @@ NSString * const TLOFileLoggerTwentyFourHourClockFormat		= @"[%H:%M:%S]";
 
 - (void)dealloc
 {
-	[self close];
+	/* Loggers with buffered data are retained by the writer queue
+	 until it is written so there is nothing left to flush here. */
+	[self closeFile];
 }
 
 @end
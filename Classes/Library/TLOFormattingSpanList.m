@@ -0,0 +1,319 @@
+/* ********************************************************************* 
+                  _____         _               _
+                 |_   _|____  _| |_ _   _  __ _| |
+                   | |/ _ \ \/ / __| | | |/ _` | |
+                   | |  __/>  <| |_| |_| | (_| | |
+                   |_|\___/_/\_\\__|\__,_|\__,_|_|
+
+ Copyright (c) 2010 - 2015 Codeux Software, LLC & respective contributors.
+        Please see Acknowledgements.pdf for additional information.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Textual and/or "Codeux Software, LLC", nor the 
+      names of its contributors may be used to endorse or promote products 
+      derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+ *********************************************************************** */
+
+
+#import "TextualApplication.h"
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+/* Strings up to this length are copied to the stack while being scanned. */
+#define _maximumStackBufferLength		512
+
+@interface TLOFormattingSpanList ()
+@property (nonatomic, copy) NSString *string;
+@property (nonatomic, copy) NSString *cachedStrippedString;
+@end
+
+@implementation TLOFormattingSpanList
+{
+	TLOFormattingSpan *_spans;
+
+	NSUInteger _count;
+	NSUInteger _capacity;
+}
+
+static BOOL TLOFormattingCharacterIsEffect(UniChar c)
+{
+	switch (c) {
+		case IRCTextFormatterBoldEffectCharacter:
+		case IRCTextFormatterColorEffectCharacter:
+		case IRCTextFormatterItalicEffectCharacter:
+		case 0x16: // Old character used for italic text
+		case IRCTextFormatterUnderlineEffectCharacter:
+		case IRCTextFormatterTerminatingCharacter:
+		{
+			return YES;
+		}
+		default:
+		{
+			return NO;
+		}
+	}
+}
+
+/* Returns the index of the first formatting character at or after
+ offset, or length if there is none. */
+static NSUInteger TLOFormattingNextEffectCharacter(const UniChar *characters, NSUInteger offset, NSUInteger length)
+{
+#if defined(__SSE2__)
+	const __m128i threshold = _mm_set1_epi16(0x1F);
+	const __m128i zero = _mm_setzero_si128();
+
+	while ((offset + 8) <= length) {
+		__m128i chunk = _mm_loadu_si128((const __m128i *)(characters + offset));
+
+		/* A saturated subtraction leaves zero for every character at or below 0x1F. */
+		__m128i controlCharacters = _mm_cmpeq_epi16(_mm_subs_epu16(chunk, threshold), zero);
+
+		int mask = _mm_movemask_epi8(controlCharacters);
+
+		while (mask) {
+			NSUInteger index = (offset + (__builtin_ctz(mask) / 2));
+
+			if (TLOFormattingCharacterIsEffect(characters[index])) {
+				return index;
+			}
+
+			/* Each character sets two bits of the mask. */
+			mask &= ~(3 << (__builtin_ctz(mask) & ~1));
+		}
+
+		offset += 8;
+	}
+#endif
+
+	while (offset < length) {
+		UniChar c = characters[offset];
+
+		if (c < 0x20 && TLOFormattingCharacterIsEffect(c)) {
+			return offset;
+		}
+
+		offset += 1;
+	}
+
+	return length;
+}
+
++ (TLOFormattingSpanList *)spanListForString:(NSString *)string
+{
+	NSObjectIsEmptyAssertReturn(string, nil);
+
+	NSUInteger length = [string length];
+
+	UniChar stackBuffer[_maximumStackBufferLength];
+
+	UniChar *heapBuffer = NULL;
+
+	const UniChar *characters = CFStringGetCharactersPtr((__bridge CFStringRef)string);
+
+	if (characters == NULL) {
+		if (length <= _maximumStackBufferLength) {
+			CFStringGetCharacters((__bridge CFStringRef)string, CFRangeMake(0, length), stackBuffer);
+
+			characters = stackBuffer;
+		} else {
+			heapBuffer = malloc(length * sizeof(UniChar));
+
+			CFStringGetCharacters((__bridge CFStringRef)string, CFRangeMake(0, length), heapBuffer);
+
+			characters = heapBuffer;
+		}
+	}
+
+	TLOFormattingSpanList *spanList = nil;
+
+	NSUInteger i = TLOFormattingNextEffectCharacter(characters, 0, length);
+
+	if (i < length) {
+		spanList = [TLOFormattingSpanList new];
+
+		[spanList setString:string];
+
+		while (i < length) {
+			[spanList appendSpanAtIndex:&i ofCharacters:characters length:length];
+
+			i = TLOFormattingNextEffectCharacter(characters, (i + 1), length);
+		}
+	}
+
+	if (heapBuffer) {
+		free(heapBuffer);
+	}
+
+	return spanList;
+}
+
+- (void)dealloc
+{
+	if (_spans) {
+		free(_spans);
+	}
+}
+
+- (void)appendSpanAtIndex:(NSUInteger *)index ofCharacters:(const UniChar *)characters length:(NSUInteger)length
+{
+	NSUInteger i = *index;
+
+	TLOFormattingSpan span;
+
+	span.foregroundColor = -1;
+	span.backgroundColor = -1;
+
+	switch (characters[i]) {
+		case IRCTextFormatterBoldEffectCharacter:
+		{
+			span.type = TLOFormattingBoldSpanType;
+
+			break;
+		}
+		case IRCTextFormatterItalicEffectCharacter:
+		case 0x16: // Old character used for italic text
+		{
+			span.type = TLOFormattingItalicSpanType;
+
+			break;
+		}
+		case IRCTextFormatterUnderlineEffectCharacter:
+		{
+			span.type = TLOFormattingUnderlineSpanType;
+
+			break;
+		}
+		case IRCTextFormatterTerminatingCharacter:
+		{
+			span.type = TLOFormattingTerminatingSpanType;
+
+			break;
+		}
+		default:
+		{
+			span.type = TLOFormattingColorSpanType;
+
+			/* Up to two digits of foreground color, optionally followed by
+			 a comma and up to two digits of background color. A comma that
+			 is not followed by a digit is left in place. */
+			if ((i + 1) < length && CSCEF_StringIsBase10Numeric(characters[(i + 1)])) {
+				i += 1;
+
+				span.foregroundColor = (characters[i] - '0');
+
+				if ((i + 1) < length && CSCEF_StringIsBase10Numeric(characters[(i + 1)])) {
+					i += 1;
+
+					span.foregroundColor = ((span.foregroundColor * 10) + (characters[i] - '0'));
+				}
+
+				if ((i + 1) < length && characters[(i + 1)] == ',') {
+					if ((i + 2) >= length) {
+						i += 1; // A trailing comma is consumed.
+					} else if (CSCEF_StringIsBase10Numeric(characters[(i + 2)])) {
+						i += 2;
+
+						span.backgroundColor = (characters[i] - '0');
+
+						if ((i + 1) < length && CSCEF_StringIsBase10Numeric(characters[(i + 1)])) {
+							i += 1;
+
+							span.backgroundColor = ((span.backgroundColor * 10) + (characters[i] - '0'));
+						}
+					}
+				}
+			}
+
+			break;
+		}
+	}
+
+	span.range = NSMakeRange(*index, (i - *index + 1));
+
+	if (_count == _capacity) {
+		_capacity = ((_capacity == 0) ? 8 : (_capacity * 2));
+
+		_spans = realloc(_spans, (_capacity * sizeof(TLOFormattingSpan)));
+	}
+
+	_spans[_count] = span;
+
+	_count += 1;
+
+	*index = i;
+}
+
+- (NSUInteger)count
+{
+	return _count;
+}
+
+- (TLOFormattingSpan)spanAtIndex:(NSUInteger)index
+{
+	NSAssert((index < _count), @"Index out of bounds");
+
+	return _spans[index];
+}
+
+- (NSString *)strippedString
+{
+	@synchronized(self) {
+		if (self.cachedStrippedString == nil) {
+			NSUInteger length = [self.string length];
+
+			UniChar *characters = malloc(length * sizeof(UniChar));
+
+			[self.string getCharacters:characters range:NSMakeRange(0, length)];
+
+			/* Text between spans is moved down over the removed formatting. */
+			NSUInteger strippedLength = 0;
+
+			NSUInteger segmentStart = 0;
+
+			for (NSUInteger i = 0; i <= _count; i++) {
+				NSUInteger segmentEnd = ((i < _count) ? _spans[i].range.location : length);
+
+				NSUInteger segmentLength = (segmentEnd - segmentStart);
+
+				if (segmentLength > 0) {
+					memmove((characters + strippedLength), (characters + segmentStart), (segmentLength * sizeof(UniChar)));
+
+					strippedLength += segmentLength;
+				}
+
+				if (i < _count) {
+					segmentStart = NSMaxRange(_spans[i].range);
+				}
+			}
+
+			self.cachedStrippedString = [[NSString alloc] initWithCharactersNoCopy:characters length:strippedLength freeWhenDone:YES];
+		}
+
+		return self.cachedStrippedString;
+	}
+}
+
+@end
@@ -0,0 +1,462 @@
+/* ********************************************************************* 
+                  _____         _               _
+                 |_   _|____  _| |_ _   _  __ _| |
+                   | |/ _ \ \/ / __| | | |/ _` | |
+                   | |  __/>  <| |_| |_| | (_| | |
+                   |_|\___/_/\_\\__|\__,_|\__,_|_|
+
+ Copyright (c) 2010 - 2015 Codeux Software, LLC & respective contributors.
+        Please see Acknowledgements.pdf for additional information.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Textual and/or "Codeux Software, LLC", nor the 
+      names of its contributors may be used to endorse or promote products 
+      derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+ *********************************************************************** */
+
+#import "TextualApplication.h"
+
+#define _rootTransitionTableLength			128
+#define _foldStackBufferLength				1024
+
+typedef struct TLOMultiPatternScannerNode {
+	unichar character;
+	NSUInteger depth;
+	NSUInteger parent;
+	NSUInteger firstChild; // 0 = none (the root is never a child)
+	NSUInteger nextSibling; // 0 = none
+	NSUInteger failure; // Longest proper suffix which is also in the trie
+	NSUInteger output; // Nearest terminal node along the failure links; 0 = none
+	BOOL isTerminal;
+} TLOMultiPatternScannerNode;
+
+static unichar *_copyFoldedCharacters(NSString *string, unichar *stackBuffer, NSUInteger stackBufferLength)
+{
+	/* ASCII is folded in place. Anything else goes through -lowercaseString
+	 as long as that does not change the length of the string, otherwise
+	 ranges reported would no longer line up with the original string. */
+	NSUInteger stringLength = [string length];
+
+	unichar *characters = stackBuffer;
+
+	if (stringLength > stackBufferLength) {
+		characters = malloc(sizeof(unichar) * stringLength);
+	}
+
+	[string getCharacters:characters range:NSMakeRange(0, stringLength)];
+
+	BOOL containsNonASCII = NO;
+
+	for (NSUInteger i = 0; i < stringLength; i++) {
+		unichar c = characters[i];
+
+		if (c >= 'A' && c <= 'Z') {
+			characters[i] = (c + ('a' - 'A'));
+		} else if (c > 0x7F) {
+			containsNonASCII = YES;
+		}
+	}
+
+	if (containsNonASCII) {
+		NSString *lowercaseString = [string lowercaseString];
+
+		if ([lowercaseString length] == stringLength) {
+			[lowercaseString getCharacters:characters range:NSMakeRange(0, stringLength)];
+		}
+	}
+
+	return characters;
+}
+
+@implementation TLOMultiPatternScanner
+{
+	TLOMultiPatternScannerNode *_nodes;
+	NSUInteger _nodeCount;
+	NSUInteger _nodeCapacity;
+
+	NSUInteger _rootTransitions[_rootTransitionTableLength];
+
+	NSMutableDictionary *_objectsForNodes; // Node index -> object
+	NSMapTable *_nodesForObjects; // Object (by pointer) -> node index
+
+	NSUInteger _removedObjectCount;
+
+	BOOL _failureLinksAreStale;
+}
+
+- (instancetype)init
+{
+	if ((self = [super init])) {
+		_objectsForNodes = [NSMutableDictionary dictionary];
+
+		_nodesForObjects = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+												 valueOptions:NSPointerFunctionsStrongMemory];
+
+		[self resetAutomaton];
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	free(_nodes);
+}
+
+#pragma mark -
+#pragma mark Trie
+
+- (void)resetAutomaton
+{
+	free(_nodes);
+
+	_nodes = NULL;
+	_nodeCount = 0;
+	_nodeCapacity = 0;
+
+	memset(_rootTransitions, 0, sizeof(_rootTransitions));
+
+	[_objectsForNodes removeAllObjects];
+	[_nodesForObjects removeAllObjects];
+
+	_removedObjectCount = 0;
+
+	_failureLinksAreStale = NO;
+
+	(void)[self addNodeWithCharacter:0 parent:0 depth:0]; // Root
+}
+
+- (NSUInteger)addNodeWithCharacter:(unichar)character parent:(NSUInteger)parent depth:(NSUInteger)depth
+{
+	if (_nodeCount == _nodeCapacity) {
+		_nodeCapacity = MAX(256, (_nodeCapacity * 2));
+
+		_nodes = realloc(_nodes, (sizeof(TLOMultiPatternScannerNode) * _nodeCapacity));
+	}
+
+	_nodes[_nodeCount] = (TLOMultiPatternScannerNode){character, depth, parent, 0, 0, 0, 0, NO};
+
+	return _nodeCount++;
+}
+
+- (NSUInteger)transitionFromNode:(NSUInteger)nodeIndex withCharacter:(unichar)c
+{
+	if (nodeIndex == 0 && c < _rootTransitionTableLength) {
+		return _rootTransitions[c];
+	}
+
+	NSUInteger childIndex = _nodes[nodeIndex].firstChild;
+
+	while (childIndex > 0 && _nodes[childIndex].character != c) {
+		childIndex = _nodes[childIndex].nextSibling;
+	}
+
+	return childIndex;
+}
+
+- (void)insertPattern:(NSString *)pattern withObject:(id)object
+{
+	NSUInteger patternLength = [pattern length];
+
+	unichar stackBuffer[_foldStackBufferLength];
+
+	unichar *characters = _copyFoldedCharacters(pattern, stackBuffer, _foldStackBufferLength);
+
+	NSUInteger nodeIndex = 0;
+
+	for (NSUInteger i = 0; i < patternLength; i++) {
+		unichar c = characters[i];
+
+		NSUInteger childIndex = [self transitionFromNode:nodeIndex withCharacter:c];
+
+		if (childIndex == 0) {
+			childIndex = [self addNodeWithCharacter:c parent:nodeIndex depth:(i + 1)];
+
+			_nodes[childIndex].nextSibling = _nodes[nodeIndex].firstChild;
+
+			_nodes[nodeIndex].firstChild = childIndex;
+
+			if (nodeIndex == 0 && c < _rootTransitionTableLength) {
+				_rootTransitions[c] = childIndex;
+			}
+
+			_failureLinksAreStale = YES;
+		}
+
+		nodeIndex = childIndex;
+	}
+
+	if (characters != stackBuffer) {
+		free(characters);
+	}
+
+	/* Two objects with patterns that fold the same cannot share a
+	 node. The one added last wins. */
+	NSNumber *nodeKey = @(nodeIndex);
+
+	id replacedObject = _objectsForNodes[nodeKey];
+
+	if (replacedObject) {
+		[_nodesForObjects removeObjectForKey:replacedObject];
+	}
+
+	_objectsForNodes[nodeKey] = object;
+
+	[_nodesForObjects setObject:nodeKey forKey:object];
+
+	if (_nodes[nodeIndex].isTerminal == NO) {
+		_nodes[nodeIndex].isTerminal = YES;
+
+		/* A node which became terminal changes the output
+		 links of every node whose failure chain reaches it. */
+		_failureLinksAreStale = YES;
+	}
+}
+
+- (void)rebuildFailureLinks
+{
+	/* Breadth first so that the failure link of a node is always
+	 computed before those of its children. */
+	NSUInteger *queue = malloc(sizeof(NSUInteger) * _nodeCount);
+
+	NSUInteger queueHead = 0;
+	NSUInteger queueTail = 0;
+
+	for (NSUInteger childIndex = _nodes[0].firstChild; childIndex > 0; childIndex = _nodes[childIndex].nextSibling) {
+		_nodes[childIndex].failure = 0;
+		_nodes[childIndex].output = 0;
+
+		queue[queueTail++] = childIndex;
+	}
+
+	while (queueHead < queueTail) {
+		NSUInteger nodeIndex = queue[queueHead++];
+
+		for (NSUInteger childIndex = _nodes[nodeIndex].firstChild; childIndex > 0; childIndex = _nodes[childIndex].nextSibling) {
+			unichar c = _nodes[childIndex].character;
+
+			NSUInteger failureIndex = _nodes[nodeIndex].failure;
+
+			NSUInteger transitionIndex = [self transitionFromNode:failureIndex withCharacter:c];
+
+			while (transitionIndex == 0 && failureIndex > 0) {
+				failureIndex = _nodes[failureIndex].failure;
+
+				transitionIndex = [self transitionFromNode:failureIndex withCharacter:c];
+			}
+
+			_nodes[childIndex].failure = transitionIndex;
+
+			if (_nodes[transitionIndex].isTerminal) {
+				_nodes[childIndex].output = transitionIndex;
+			} else {
+				_nodes[childIndex].output = _nodes[transitionIndex].output;
+			}
+
+			queue[queueTail++] = childIndex;
+		}
+	}
+
+	free(queue);
+
+	_failureLinksAreStale = NO;
+}
+
+- (void)compactAutomaton
+{
+	/* Removing an object only unmarks its node. Once more objects have been
+	 removed than are left, the trie is rebuilt from the remaining ones. */
+	NSMutableArray *patterns = [NSMutableArray array];
+	NSMutableArray *objects = [NSMutableArray array];
+
+	for (NSNumber *nodeKey in _objectsForNodes) {
+		[patterns addObject:[self patternForNodeAtIndex:[nodeKey unsignedIntegerValue]]];
+
+		[objects addObject:_objectsForNodes[nodeKey]];
+	}
+
+	[self resetAutomaton];
+
+	for (NSUInteger i = 0; i < [objects count]; i++) {
+		[self insertPattern:patterns[i] withObject:objects[i]];
+	}
+}
+
+- (NSString *)patternForNodeAtIndex:(NSUInteger)nodeIndex
+{
+	/* Walk back up from a node using the parent of each node. The
+	 folded form of the pattern is all that is needed to reinsert it. */
+	NSUInteger depth = _nodes[nodeIndex].depth;
+
+	unichar *characters = malloc(sizeof(unichar) * MAX(depth, 1));
+
+	for (NSUInteger i = depth; i > 0; i--) {
+		characters[(i - 1)] = _nodes[nodeIndex].character;
+
+		nodeIndex = _nodes[nodeIndex].parent;
+	}
+
+	return [[NSString alloc] initWithCharactersNoCopy:characters length:depth freeWhenDone:YES];
+}
+
+#pragma mark -
+#pragma mark Public API
+
+- (void)addPattern:(NSString *)pattern withObject:(id)object
+{
+	NSObjectIsEmptyAssert(pattern);
+
+	PointerIsEmptyAssert(object);
+
+	@synchronized(self) {
+		NSNumber *nodeKey = [_nodesForObjects objectForKey:object];
+
+		if (nodeKey) {
+			[self removeObjectAtNode:nodeKey];
+		}
+
+		[self insertPattern:pattern withObject:object];
+	}
+}
+
+- (void)removeObjectAtNode:(NSNumber *)nodeKey
+{
+	id object = _objectsForNodes[nodeKey];
+
+	[_objectsForNodes removeObjectForKey:nodeKey];
+
+	if (object) {
+		[_nodesForObjects removeObjectForKey:object];
+	}
+
+	_nodes[[nodeKey unsignedIntegerValue]].isTerminal = NO;
+
+	_removedObjectCount += 1;
+}
+
+- (void)removeObject:(id)object
+{
+	PointerIsEmptyAssert(object);
+
+	@synchronized(self) {
+		NSNumber *nodeKey = [_nodesForObjects objectForKey:object];
+
+		PointerIsEmptyAssert(nodeKey);
+
+		[self removeObjectAtNode:nodeKey];
+
+		if (_removedObjectCount > 64 && _removedObjectCount > [_objectsForNodes count]) {
+			[self compactAutomaton];
+		}
+	}
+}
+
+- (void)removeAllObjects
+{
+	@synchronized(self) {
+		[self resetAutomaton];
+	}
+}
+
+- (NSUInteger)count
+{
+	@synchronized(self) {
+		return [_objectsForNodes count];
+	}
+}
+
+- (void)enumerateMatchesInString:(NSString *)string usingBlock:(void (^)(id object, NSRange range, BOOL *stop))block
+{
+	NSObjectIsEmptyAssert(string);
+
+	PointerIsEmptyAssert(block);
+
+	NSUInteger stringLength = [string length];
+
+	unichar stackBuffer[_foldStackBufferLength];
+
+	unichar *characters = _copyFoldedCharacters(string, stackBuffer, _foldStackBufferLength);
+
+	/* Matches are collected while the automaton is locked and only handed
+	 to the block once it is unlocked. The block is free to do work of any
+	 length, or to call back into the scanner, without holding it up. */
+	NSMutableArray *matchedObjects = [NSMutableArray array];
+	NSMutableArray *matchedRanges = [NSMutableArray array];
+
+	@synchronized(self) {
+		if ([_objectsForNodes count] > 0) {
+			if (_failureLinksAreStale) {
+				[self rebuildFailureLinks];
+			}
+
+			NSUInteger nodeIndex = 0;
+
+			for (NSUInteger i = 0; i < stringLength; i++) {
+				unichar c = characters[i];
+
+				NSUInteger transitionIndex = [self transitionFromNode:nodeIndex withCharacter:c];
+
+				while (transitionIndex == 0 && nodeIndex > 0) {
+					nodeIndex = _nodes[nodeIndex].failure;
+
+					transitionIndex = [self transitionFromNode:nodeIndex withCharacter:c];
+				}
+
+				nodeIndex = transitionIndex;
+
+				/* Report the node itself and every terminal along its failure chain.
+				 Nodes unmarked by a removal can still appear in the chain. */
+				NSUInteger outputIndex = nodeIndex;
+
+				if (_nodes[outputIndex].isTerminal == NO) {
+					outputIndex = _nodes[outputIndex].output;
+				}
+
+				while (outputIndex > 0) {
+					if (_nodes[outputIndex].isTerminal) {
+						NSUInteger matchLength = _nodes[outputIndex].depth;
+
+						[matchedObjects addObject:_objectsForNodes[@(outputIndex)]];
+
+						[matchedRanges addObject:[NSValue valueWithRange:NSMakeRange(((i + 1) - matchLength), matchLength)]];
+					}
+
+					outputIndex = _nodes[outputIndex].output;
+				}
+			}
+		}
+	}
+
+	if (characters != stackBuffer) {
+		free(characters);
+	}
+
+	BOOL stop = NO;
+
+	for (NSUInteger i = 0; i < [matchedObjects count] && stop == NO; i++) {
+		block(matchedObjects[i], [matchedRanges[i] rangeValue], &stop);
+	}
+}
+
+@end
@@ -46,6 +46,67 @@ NSString * const TXDefaultTextualChannelViewFont				= @"Lucida Grande";
 NSString * const TPCPreferencesThemeNameDefaultsKey				= @"Theme -> Name";
 NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name";
 
+/* Preferences read for every line are copied into an immutable snapshot. The snapshot
+ is replaced whenever user defaults change so readers on any thread only need to load a
+ pointer. The atomic property guarantees the pointer is retained before it is released. */
+@interface TPCPreferencesSnapshotStorage : NSObject
+@property (strong) TPCPreferencesSnapshot *snapshot;
+@end
+
+@implementation TPCPreferencesSnapshotStorage
+@end
+
+@interface TPCPreferencesSnapshot ()
+@property (readwrite) BOOL showJoinLeave;
+@property (readwrite) BOOL showInlineImages;
+@property (readwrite) BOOL removeAllFormatting;
+@property (readwrite) BOOL rightToLeftFormatting;
+@property (readwrite) BOOL automaticallyDetectHighlightSpam;
+@property (readwrite) BOOL automaticallyFilterUnicodeTextSpam;
+@property (readwrite) BOOL conversationTrackingIncludesUserModeSymbol;
+@property (readwrite) BOOL disableNicknameColorHashing;
+@property (readwrite) BOOL memberListSortFavorsServerStaff;
+@property (readwrite) BOOL highlightCurrentNickname;
+@property (readwrite) BOOL logHighlights;
+@property (readwrite) TXNicknameHighlightMatchType highlightMatchingMethod;
+@property (readwrite) NSInteger trackUserAwayStatusMaximumChannelSize;
+@property (readwrite) NSInteger inlineImagesMaxWidth;
+@property (readwrite) NSInteger inlineImagesMaxHeight;
+@property (readwrite, copy) NSString *themeNicknameFormat;
+@property (readwrite, copy) NSString *themeTimestampFormat;
+@end
+
+@implementation TPCPreferencesSnapshot
+
+- (instancetype)init
+{
+	if ((self = [super init])) {
+		self.showJoinLeave = [RZUserDefaults() boolForKey:@"DisplayEventInLogView -> Join, Part, Quit"];
+		self.showInlineImages = [RZUserDefaults() boolForKey:@"DisplayEventInLogView -> Inline Media"];
+		self.removeAllFormatting = [RZUserDefaults() boolForKey:@"RemoveIRCTextFormatting"];
+		self.rightToLeftFormatting = [RZUserDefaults() boolForKey:@"RightToLeftTextFormatting"];
+		self.automaticallyDetectHighlightSpam = [RZUserDefaults() boolForKey:@"AutomaticallyDetectHighlightSpam"];
+		self.automaticallyFilterUnicodeTextSpam = [RZUserDefaults() boolForKey:@"AutomaticallyFilterUnicodeTextSpam"];
+		self.conversationTrackingIncludesUserModeSymbol = [RZUserDefaults() boolForKey:@"ConversationTrackingIncludesUserModeSymbol"];
+		self.disableNicknameColorHashing = [RZUserDefaults() boolForKey:@"DisableRemoteNicknameColorHashing"];
+		self.memberListSortFavorsServerStaff = [RZUserDefaults() boolForKey:@"MemberListSortFavorsServerStaff"];
+		self.highlightCurrentNickname = [RZUserDefaults() boolForKey:@"TrackNicknameHighlightsOfLocalUser"];
+		self.logHighlights = [RZUserDefaults() boolForKey:@"LogHighlights"];
+		self.highlightMatchingMethod = (TXNicknameHighlightMatchType)[RZUserDefaults() integerForKey:@"NicknameHighlightMatchingType"];
+		self.trackUserAwayStatusMaximumChannelSize = [RZUserDefaults() integerForKey:@"TrackUserAwayStatusMaximumChannelSize"];
+		self.inlineImagesMaxWidth = [RZUserDefaults() integerForKey:@"InlineMediaScalingWidth"];
+		self.inlineImagesMaxHeight = [RZUserDefaults() integerForKey:@"InlineMediaMaximumHeight"];
+		self.themeNicknameFormat = [RZUserDefaults() objectForKey:@"Theme -> Nickname Format"];
+		self.themeTimestampFormat = [RZUserDefaults() objectForKey:@"Theme -> Timestamp Format"];
+
+		return self;
+	}
+
+	return nil;
+}
+
+@end
+
 @implementation TPCPreferences
 
 #pragma mark -
@@ -148,7 +209,7 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 
 + (BOOL)logHighlights
 {
-	return [RZUserDefaults() boolForKey:@"LogHighlights"];
+	return [[TPCPreferences preferencesSnapshot] logHighlights];
 }
 
 + (BOOL)clearAllOnlyOnActiveServer
@@ -190,27 +251,27 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 
 + (BOOL)removeAllFormatting
 {
-	return [RZUserDefaults() boolForKey:@"RemoveIRCTextFormatting"];
+	return [[TPCPreferences preferencesSnapshot] removeAllFormatting];
 }
 
 + (BOOL)automaticallyDetectHighlightSpam
 {
-	return [RZUserDefaults() boolForKey:@"AutomaticallyDetectHighlightSpam"];
+	return [[TPCPreferences preferencesSnapshot] automaticallyDetectHighlightSpam];
 }
 
 + (BOOL)disableNicknameColorHashing
 {
-	return [RZUserDefaults() boolForKey:@"DisableRemoteNicknameColorHashing"];
+	return [[TPCPreferences preferencesSnapshot] disableNicknameColorHashing];
 }
 
 + (BOOL)conversationTrackingIncludesUserModeSymbol
 {
-	return [RZUserDefaults() boolForKey:@"ConversationTrackingIncludesUserModeSymbol"];
+	return [[TPCPreferences preferencesSnapshot] conversationTrackingIncludesUserModeSymbol];
 }
 
 + (BOOL)rightToLeftFormatting
 {
-	return [RZUserDefaults() boolForKey:@"RightToLeftTextFormatting"];
+	return [[TPCPreferences preferencesSnapshot] rightToLeftFormatting];
 }
 
 + (BOOL)displayDockBadge
@@ -235,7 +296,7 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 
 + (BOOL)memberListSortFavorsServerStaff
 {
-	return [RZUserDefaults() boolForKey:@"MemberListSortFavorsServerStaff"];
+	return [[TPCPreferences preferencesSnapshot] memberListSortFavorsServerStaff];
 }
 
 + (BOOL)memberListUpdatesUserInfoPopoverOnScroll
@@ -250,7 +311,7 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 
 + (BOOL)automaticallyFilterUnicodeTextSpam
 {
-	return [RZUserDefaults() boolForKey:@"AutomaticallyFilterUnicodeTextSpam"];
+	return [[TPCPreferences preferencesSnapshot] automaticallyFilterUnicodeTextSpam];
 }
 
 + (BOOL)nickAllConnections
@@ -320,12 +381,12 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 
 + (BOOL)showInlineImages
 {
-	return [RZUserDefaults() boolForKey:@"DisplayEventInLogView -> Inline Media"];
+	return [[TPCPreferences preferencesSnapshot] showInlineImages];
 }
 
 + (BOOL)showJoinLeave
 {
-	return [RZUserDefaults() boolForKey:@"DisplayEventInLogView -> Join, Part, Quit"];
+	return [[TPCPreferences preferencesSnapshot] showJoinLeave];
 }
 
 + (BOOL)commandReturnSendsMessageAsAction
@@ -345,7 +406,7 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 
 + (BOOL)highlightCurrentNickname
 {
-	return [RZUserDefaults() boolForKey:@"TrackNicknameHighlightsOfLocalUser"];
+	return [[TPCPreferences preferencesSnapshot] highlightCurrentNickname];
 }
 
 + (BOOL)inputHistoryIsChannelSpecific
@@ -360,7 +421,7 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 
 + (NSInteger)trackUserAwayStatusMaximumChannelSize
 {
-    return [RZUserDefaults() integerForKey:@"TrackUserAwayStatusMaximumChannelSize"];
+	return [[TPCPreferences preferencesSnapshot] trackUserAwayStatusMaximumChannelSize];
 }
 
 + (TXTabKeyAction)tabKeyAction
@@ -370,7 +431,7 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 
 + (TXNicknameHighlightMatchType)highlightMatchingMethod
 {
-	return (TXNicknameHighlightMatchType)[RZUserDefaults() integerForKey:@"NicknameHighlightMatchingType"];
+	return [[TPCPreferences preferencesSnapshot] highlightMatchingMethod];
 }
 
 + (TXUserDoubleClickAction)userDoubleClickOption
@@ -462,12 +523,12 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 
 + (NSString *)themeNicknameFormat
 {
-	return [RZUserDefaults() objectForKey:@"Theme -> Nickname Format"];
+	return [[TPCPreferences preferencesSnapshot] themeNicknameFormat];
 }
 
 + (NSString *)themeTimestampFormat
 {
-	return [RZUserDefaults() objectForKey:@"Theme -> Timestamp Format"];
+	return [[TPCPreferences preferencesSnapshot] themeTimestampFormat];
 }
 
 + (double)themeTransparency
@@ -517,12 +578,12 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 
 + (NSInteger)inlineImagesMaxWidth
 {
-	return [RZUserDefaults() integerForKey:@"InlineMediaScalingWidth"];
+	return [[TPCPreferences preferencesSnapshot] inlineImagesMaxWidth];
 }
 
 + (NSInteger)inlineImagesMaxHeight
 {
-	return [RZUserDefaults() integerForKey:@"InlineMediaMaximumHeight"];
+	return [[TPCPreferences preferencesSnapshot] inlineImagesMaxHeight];
 }
 
 + (void)setInlineImagesMaxWidth:(NSInteger)value
@@ -583,6 +644,11 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 	return [RZUserDefaults() objectForKey:@"File Transfers -> File Transfer Manually Entered IP Address"];
 }
 
++ (TXUnsignedLongLong)fileTransferMaximumTransferRate
+{
+	return [RZUserDefaults() integerForKey:@"File Transfers -> Maximum Transfer Rate"];
+}
+
 #pragma mark -
 #pragma mark Max Log Lines
 
@@ -750,16 +816,15 @@ NSString * const TPCPreferencesThemeFontNameDefaultsKey			= @"Theme -> Font Name
 #pragma mark -
 #pragma mark Keywords
 
-static NSMutableArray *matchKeywords = nil;
-static NSMutableArray *excludeKeywords = nil;
+/* The keyword lists are replaced, never modified, when they are reloaded. 
+ The same instance is returned until the preferences change which is what
+ TVCLogRenderer relies on to know when to recompile its keyword matcher. */
+static NSArray *matchKeywords = nil;
+static NSArray *excludeKeywords = nil;
 
 + (void)loadMatchKeywords
 {
-	if (matchKeywords) {
-		[matchKeywords removeAllObjects];
-	} else {
-		matchKeywords = [NSMutableArray new];
-	}
+	NSMutableArray *keywords = [NSMutableArray array];
 
 	NSArray *ary = [RZUserDefaults() objectForKey:@"Highlight List -> Primary Matches"];
 
@@ -768,17 +833,15 @@ static NSMutableArray *excludeKeywords = nil;
 
 		NSObjectIsEmptyAssertLoopContinue(s);
 
-		[matchKeywords addObject:s];
+		[keywords addObject:s];
 	}
+
+	matchKeywords = [keywords copy];
 }
 
 + (void)loadExcludeKeywords
 {
-	if (excludeKeywords) {
-		[excludeKeywords removeAllObjects];
-	} else {
-		excludeKeywords = [NSMutableArray new];
-	}
+	NSMutableArray *keywords = [NSMutableArray array];
 
 	NSArray *ary = [RZUserDefaults() objectForKey:@"Highlight List -> Excluded Matches"];
 
@@ -787,8 +850,10 @@ static NSMutableArray *excludeKeywords = nil;
 
 		NSObjectIsEmptyAssertLoopContinue(s);
 
-		[excludeKeywords addObject:s];
+		[keywords addObject:s];
 	}
+
+	excludeKeywords = [keywords copy];
 }
 
 + (void)cleanUpKeywords:(NSString *)key
@@ -832,6 +897,47 @@ static NSMutableArray *excludeKeywords = nil;
 	return excludeKeywords;
 }
 
+#pragma mark -
+#pragma mark Snapshot
+
++ (TPCPreferencesSnapshotStorage *)preferencesSnapshotStorage
+{
+	static id sharedSelf = nil;
+
+	static dispatch_once_t onceToken;
+
+	dispatch_once(&onceToken, ^{
+		sharedSelf = [TPCPreferencesSnapshotStorage new];
+	});
+
+	return sharedSelf;
+}
+
++ (TPCPreferencesSnapshot *)preferencesSnapshot
+{
+	TPCPreferencesSnapshotStorage *storage = [TPCPreferences preferencesSnapshotStorage];
+
+	TPCPreferencesSnapshot *snapshot = [storage snapshot];
+
+	if (snapshot == nil) {
+		snapshot = [TPCPreferencesSnapshot new];
+
+		[storage setSnapshot:snapshot];
+	}
+
+	return snapshot;
+}
+
++ (void)rebuildPreferencesSnapshot
+{
+	[[TPCPreferences preferencesSnapshotStorage] setSnapshot:[TPCPreferencesSnapshot new]];
+}
+
++ (void)userDefaultsDidChange:(NSNotification *)notification
+{
+	[TPCPreferences rebuildPreferencesSnapshot];
+}
+
 #pragma mark -
 #pragma mark Key-Value Observing
 
@@ -874,6 +980,10 @@ static NSMutableArray *excludeKeywords = nil;
 
 	[TPCPreferences populateDefaultNickname];
 
+	[TPCPreferences rebuildPreferencesSnapshot];
+
+	[RZNotificationCenter() addObserver:(id)self selector:@selector(userDefaultsDidChange:) name:TPCPreferencesUserDefaultsDidChangeNotification object:nil];
+
 	[RZUserDefaults() addObserver:(id)self forKeyPath:@"Highlight List -> Primary Matches"  options:NSKeyValueObservingOptionNew context:NULL];
 	[RZUserDefaults() addObserver:(id)self forKeyPath:@"Highlight List -> Excluded Matches" options:NSKeyValueObservingOptionNew context:NULL];
 
@@ -37,19 +37,33 @@
 
 #import "TextualApplication.h"
 
-#warning FIXME: This file requires a significant overhaul.
+/* The archive for a view is a folder of numbered segments. Each segment is an
+ append-only data file of length prefixed entries paired with an index file
+ holding the byte offset of every entry as a 64-bit integer. The number of
+ entries in a segment is therefore the size of its index divided by eight.
+ Entries are binary TVCLogLine records. The string table they refer to is
+ kept beside them in a third file which is also append-only.
+
+ Reading the last N entries only touches the segments that hold them: one
+ seek into an index then one read from that offset to the end of the data.
+ Trimming the archive deletes the oldest segments whole. */
+#define _maximumRowCountPerClient			1000
 
-#define _usesBackgroundActivityTask			0
+#define _maximumEntriesPerSegment			250
 
-#define _maximumRowCountPerClient			1000
+#define _segmentDataFileExtension			@"segment"
+#define _segmentIndexFileExtension			@"index"
+#define _segmentStringTableFileExtension	@"strings"
 
 @interface TVCLogControllerHistoricLogFile ()
-#if _usesBackgroundActivityTask == 1
-@property (nonatomic, strong) id backgroundTimer;
-#endif
-
 @property (nonatomic, strong) NSFileHandle *fileHandle;
-@property (nonatomic, assign) BOOL truncationTimerScheduled;
+@property (nonatomic, strong) NSFileHandle *indexFileHandle;
+@property (nonatomic, strong) NSFileHandle *stringTableFileHandle;
+@property (nonatomic, strong) TVCLogLineStringTable *stringTable;
+@property (nonatomic, strong) NSMutableArray *segmentNumbers;
+@property (nonatomic, strong) NSMutableArray *segmentEntryCounts;
+@property (nonatomic, assign) unsigned long long writeOffset;
+@property (nonatomic, assign) BOOL segmentListLoaded;
 @end
 
 @implementation TVCLogControllerHistoricLogFile
@@ -57,269 +71,637 @@
 #pragma mark -
 #pragma mark Public API
 
-- (void)writeNewEntryWithRawData:(NSData *)jsondata
+- (void)writeNewEntryForLogLine:(TVCLogLine *)logLine
+{
+	PointerIsEmptyAssert(logLine);
+
+	[self writeNewEntriesForLogLines:@[logLine]];
+}
+
+- (BOOL)writeNewEntriesForLogLines:(NSArray *)logLines
 {
-	if (self.fileHandle == nil) {
-		[self open];
+	NSObjectIsEmptyAssertReturn(logLines, NO);
+
+	@synchronized(self) {
+		NSInteger entryIndex = 0;
+
+		while (entryIndex < [logLines count]) {
+			if (self.fileHandle == nil) {
+				[self open];
+			}
+
+			if ([self currentSegmentEntryCount] >= _maximumEntriesPerSegment) {
+				[self beginNewSegment];
+			}
+
+			if (self.fileHandle == nil) {
+				return NO; // -open or -beginNewSegment failed. They already logged why.
+			}
+
+			/* Entries are gathered into one write per file for each segment. */
+			NSMutableData *segmentData = [NSMutableData data];
+			NSMutableData *indexData = [NSMutableData data];
+
+			NSInteger segmentEntryCount = [self currentSegmentEntryCount];
+
+			unsigned long long entryOffset = self.writeOffset;
+
+			while (entryIndex < [logLines count] && segmentEntryCount < _maximumEntriesPerSegment) {
+				TVCLogLine *logLine = logLines[entryIndex];
+
+				entryIndex += 1;
+
+				NSData *entryData = [logLine binaryRepresentationWithStringTable:self.stringTable];
+
+				NSObjectIsEmptyAssertLoopContinue(entryData);
+
+				uint64_t indexValue = CFSwapInt64HostToBig(entryOffset);
+
+				uint32_t entryLength = CFSwapInt32HostToBig((uint32_t)[entryData length]);
+
+				[indexData appendBytes:&indexValue length:sizeof(indexValue)];
+
+				[segmentData appendBytes:&entryLength length:sizeof(entryLength)];
+				[segmentData appendData:entryData];
+
+				entryOffset += (sizeof(entryLength) + [entryData length]);
+
+				segmentEntryCount += 1;
+			}
+
+			NSObjectIsEmptyAssertLoopContinue(indexData);
+
+			NSData *stringTableData = [self.stringTable pendingDefinitions];
+
+			@try {
+				/* The string table is written before the data and the data before
+				 the index so nothing on disk refers to what is not there yet. */
+				if ([stringTableData length] > 0) {
+					[self.stringTableFileHandle writeData:stringTableData];
+				}
+
+				[self.fileHandle writeData:segmentData];
+				[self.indexFileHandle writeData:indexData];
+			}
+			@catch (NSException *exception) {
+				/* The definitions stay pending. Closing also drops the string
+				 table so it is read back from what actually made it to disk. */
+				[self close];
+
+				LogToConsole(@"An exception happened to a non-critical component of Textual.");
+
+				return NO;
+			}
+
+			[self.stringTable markPendingDefinitionsAsWritten];
+
+			self.writeOffset = entryOffset;
+
+			[self.segmentEntryCounts replaceObjectAtIndex:([self.segmentEntryCounts count] - 1)
+											   withObject:@(segmentEntryCount)];
+		}
+
+		return YES;
 	}
+}
 
-	if (self.fileHandle) {
-		@try {
-			[self.fileHandle writeData:jsondata];
+- (void)open
+{
+	@synchronized(self) {
+		/* Reset everything. */
+		[self close];
+
+		/* Make sure the folder being written to exists. */
+		if ([self createArchiveFolder] == NO) {
+			return;
+		}
+
+		[self loadSegmentList];
 
-			[self scheduleNextRandomFileTruncationEvent];
+		/* Migrating a legacy log file may have opened a segment already. */
+		if (self.fileHandle) {
+			return;
 		}
-		@catch (NSException *exception) {
-			[self close];
 
-			LogToConsole(@"An exception happened to a non-critical component of Textual.");
+		/* Open the newest segment or start the first one. */
+		if ([self.segmentNumbers count] == 0) {
+			[self beginNewSegment];
+		} else {
+			NSInteger segmentNumber = [[self.segmentNumbers lastObject] integerValue];
+
+			[self openSegment:segmentNumber];
 		}
 	}
 }
 
-- (void)writeNewEntryForLogLine:(TVCLogLine *)logLine
+- (void)close
+{
+	@synchronized(self) {
+		if ( self.fileHandle) {
+			[self.fileHandle synchronizeFile];
+			[self.fileHandle closeFile];
+			 self.fileHandle = nil;
+		}
+
+		if ( self.indexFileHandle) {
+			[self.indexFileHandle synchronizeFile];
+			[self.indexFileHandle closeFile];
+			 self.indexFileHandle = nil;
+		}
+
+		if ( self.stringTableFileHandle) {
+			[self.stringTableFileHandle synchronizeFile];
+			[self.stringTableFileHandle closeFile];
+			 self.stringTableFileHandle = nil;
+		}
+
+		self.stringTable = nil;
+	}
+}
+
+- (void)resetData
 {
-	NSData *jsondata = [logLine jsonDictionaryRepresentation];
+	@synchronized(self) {
+		/* Close anything already open. */
+		[self close];
+
+		/* Destroy archive at write path. */
+		/* error: is ignored because the archive may not exist at all
+		 so no reason to report that when we already know it. */
+		[RZFileManager() removeItemAtPath:[self writePath] error:NULL];
 
-	[self writeNewEntryWithRawData:jsondata];
-	[self writeNewEntryWithRawData:[NSData lineFeed]];
+		self.segmentNumbers = [NSMutableArray array];
+		self.segmentEntryCounts = [NSMutableArray array];
+
+		self.segmentListLoaded = YES;
+	}
 }
 
-- (void)open
+- (NSArray *)listEntriesWithFetchLimit:(NSUInteger)maxEntryCount
 {
-	/* Reset everything. */
-	[self close];
+	@synchronized(self) {
+		NSAssertReturnR((maxEntryCount > 0), nil);
+
+		[self loadSegmentList];
+
+		/* Walk back from the newest segment until enough entries are covered. */
+		NSInteger firstSegmentIndex = [self.segmentNumbers count];
+
+		NSUInteger coveredEntryCount = 0;
+
+		while (firstSegmentIndex > 0 && coveredEntryCount < maxEntryCount) {
+			firstSegmentIndex -= 1;
+
+			coveredEntryCount += [self.segmentEntryCounts integerAtIndex:firstSegmentIndex];
+		}
+
+		NSAssertReturnR((coveredEntryCount > 0), nil);
+
+		/* Read the covered segments oldest first. */
+		NSMutableArray *allEntries = [NSMutableArray arrayWithCapacity:MIN(coveredEntryCount, maxEntryCount)];
+
+		NSInteger entriesToSkip = 0;
+
+		if (coveredEntryCount > maxEntryCount) {
+			entriesToSkip = (coveredEntryCount - maxEntryCount);
+		}
+
+		for (NSInteger i = firstSegmentIndex; i < [self.segmentNumbers count]; i++) {
+			@autoreleasepool {
+				NSInteger segmentNumber = [self.segmentNumbers integerAtIndex:i];
+
+				[self readEntriesFromSegment:segmentNumber skippingEntries:entriesToSkip intoArray:allEntries];
+
+				entriesToSkip = 0;
+			}
+		}
 
-	/* Where are we writing to? */
-	NSString *rawpath = [self writePath];
+		return allEntries;
+	}
+}
 
-	NSURL *path = [NSURL fileURLWithPath:rawpath];
+#pragma mark -
+#pragma mark Segments
 
-	/* Make sure the folder being written to exists. */
-	NSURL *folder = [path URLByDeletingLastPathComponent];
+- (NSInteger)currentSegmentEntryCount
+{
+	return [[self.segmentEntryCounts lastObject] integerValue];
+}
 
-	if ([RZFileManager() fileExistsAtPath:[folder path] isDirectory:NULL] == NO) {
+- (BOOL)createArchiveFolder
+{
+	NSString *folder = [self writePath];
+
+	if ([RZFileManager() fileExistsAtPath:folder isDirectory:NULL] == NO) {
 		NSError *fmerr = nil;
 
-		[RZFileManager() createDirectoryAtURL:folder withIntermediateDirectories:YES attributes:nil error:&fmerr];
+		[RZFileManager() createDirectoryAtPath:folder withIntermediateDirectories:YES attributes:nil error:&fmerr];
 
 		if (fmerr) {
 			LogToConsole(@"Error Creating Folder: %@", [fmerr localizedDescription]);
 
-			[self close]; // We couldn't create the folder. Destroy everything.
-
-			return;
+			return NO;
 		}
 	}
 
-	/* Does the file exist? */
-	if ([RZFileManager() fileExistsAtPath:rawpath] == NO) {
-		NSError *fcerr = nil;
+	return YES;
+}
 
-		[NSStringEmptyPlaceholder writeToURL:path atomically:NO encoding:NSUTF8StringEncoding error:&fcerr];
+- (void)loadSegmentList
+{
+	/* The segment list is read from disk once then maintained in memory. */
+	NSAssertReturn(self.segmentListLoaded == NO);
 
-		if (fcerr) {
-			LogToConsole(@"Error Creating File: %@", [fcerr localizedDescription]);
+	self.segmentListLoaded = YES;
 
-			[self close]; // We couldn't create the file. Destroy everything.
+	self.segmentNumbers = [NSMutableArray array];
+	self.segmentEntryCounts = [NSMutableArray array];
 
-			return;
+	NSArray *folderContents = [RZFileManager() contentsOfDirectoryAtPath:[self writePath] error:NULL];
+
+	for (NSString *filename in folderContents) {
+		if ([[filename pathExtension] isEqualToString:_segmentIndexFileExtension]) {
+			[self.segmentNumbers addObject:@([[filename stringByDeletingPathExtension] integerValue])];
 		}
 	}
 
-	/* Open our file handle. */
-	self.fileHandle = [NSFileHandle fileHandleForUpdatingAtPath:rawpath];
+	[self.segmentNumbers sortUsingSelector:@selector(compare:)];
 
-	if ( self.fileHandle) {
-		[self.fileHandle seekToEndOfFile];
-	} else {
-		LogToConsole(@"Failed to open file handle at path \"%@\". Unkown reason.", rawpath);
-	}
-}
+	for (NSNumber *segmentNumber in self.segmentNumbers) {
+		NSString *indexPath = [self indexPathForSegment:[segmentNumber integerValue]];
 
-- (void)close
-{
-	if ( self.fileHandle) {
-		[self.fileHandle synchronizeFile];
-		[self.fileHandle closeFile];
-		 self.fileHandle = nil;
+		NSDictionary *attributes = [RZFileManager() attributesOfItemAtPath:indexPath error:NULL];
+
+		[self.segmentEntryCounts addObject:@([attributes fileSize] / sizeof(uint64_t))];
 	}
 
-	[self cancelAnyPreviouslyScheduledFileTruncationEvents];
+	[self migrateLegacyLogFile];
 }
 
-- (void)resetData
+- (void)beginNewSegment
 {
-	/* Close anything already open. */
 	[self close];
 
-	/* Destroy file at write path. */
-	/* error: is ignored because file may not exist at all so 
-	 no reason to report that when we already know it. */
-	[RZFileManager() removeItemAtPath:[self writePath] error:NULL];
+	NSInteger segmentNumber = ([[self.segmentNumbers lastObject] integerValue] + 1);
+
+	NSString *dataPath = [self dataPathForSegment:segmentNumber];
+	NSString *indexPath = [self indexPathForSegment:segmentNumber];
+	NSString *stringTablePath = [self stringTablePathForSegment:segmentNumber];
+
+	if ([RZFileManager() createFileAtPath:dataPath contents:nil attributes:nil] == NO ||
+		[RZFileManager() createFileAtPath:indexPath contents:nil attributes:nil] == NO ||
+		[RZFileManager() createFileAtPath:stringTablePath contents:nil attributes:nil] == NO)
+	{
+		LogToConsole(@"Error Creating File: Unable to create segment %ld", (long)segmentNumber);
+
+		return;
+	}
+
+	[self.segmentNumbers addObject:@(segmentNumber)];
+	[self.segmentEntryCounts addObject:@(0)];
+
+	[self openSegment:segmentNumber];
+
+	[self removeSegmentsExceedingMaximumLineCount];
 }
 
-- (void)cancelAnyPreviouslyScheduledFileTruncationEvents
+- (void)openSegment:(NSInteger)segmentNumber
 {
-	if (self.truncationTimerScheduled) {
-		[NSObject cancelPreviousPerformRequestsWithTarget:self];
+	NSString *dataPath = [self dataPathForSegment:segmentNumber];
+	NSString *indexPath = [self indexPathForSegment:segmentNumber];
+	NSString *stringTablePath = [self stringTablePathForSegment:segmentNumber];
+
+	if ([RZFileManager() fileExistsAtPath:stringTablePath] == NO) {
+		[RZFileManager() createFileAtPath:stringTablePath contents:nil attributes:nil];
+	}
+
+	self.fileHandle = [NSFileHandle fileHandleForUpdatingAtPath:dataPath];
+	self.indexFileHandle = [NSFileHandle fileHandleForUpdatingAtPath:indexPath];
+	self.stringTableFileHandle = [NSFileHandle fileHandleForUpdatingAtPath:stringTablePath];
+
+	if (self.fileHandle == nil || self.indexFileHandle == nil || self.stringTableFileHandle == nil) {
+		LogToConsole(@"Failed to open file handle at path \"%@\". Unkown reason.", dataPath);
+
+		[self close];
+
+		return;
+	}
+
+	self.writeOffset = [self.fileHandle seekToEndOfFile];
+
+	/* Continue the string table where the segment left off. A definition
+	 that could not be loaded, such as one cut short by a failed write,
+	 is cut off. Anything appended after it would never be loaded. */
+	NSUInteger stringTableLength = 0;
+
+	self.stringTable = [self stringTableForSegment:segmentNumber loadedLength:&stringTableLength];
+
+	unsigned long long stringTableFileLength = [self.stringTableFileHandle seekToEndOfFile];
+
+	if (stringTableFileLength > stringTableLength) {
+		[self.stringTableFileHandle truncateFileAtOffset:stringTableLength];
+	}
+
+	/* The index and the data are made to agree before anything is appended.
+	 An index entry that was cut short, or that points at an entry whose data
+	 never made it to disk in full, is dropped by truncating the index. Data
+	 past the end of the last indexed entry is dropped by truncating the data
+	 so the next entry is written at the offset the index will record. */
+	@try {
+		unsigned long long indexFileLength = [self.indexFileHandle seekToEndOfFile];
+
+		unsigned long long indexLength = (indexFileLength - (indexFileLength % sizeof(uint64_t)));
+
+		unsigned long long dataLength = self.writeOffset;
+
+		unsigned long long indexedDataLength = 0;
+
+		while (indexLength > 0) {
+			[self.indexFileHandle seekToFileOffset:(indexLength - sizeof(uint64_t))];
+
+			NSData *indexData = [self.indexFileHandle readDataOfLength:sizeof(uint64_t)];
+
+			uint64_t entryOffset = 0;
+
+			[indexData getBytes:&entryOffset length:sizeof(entryOffset)];
+
+			entryOffset = CFSwapInt64BigToHost(entryOffset);
+
+			if ((entryOffset + sizeof(uint32_t)) <= dataLength) {
+				[self.fileHandle seekToFileOffset:entryOffset];
+
+				NSData *lengthData = [self.fileHandle readDataOfLength:sizeof(uint32_t)];
+
+				uint32_t entryLength = 0;
+
+				[lengthData getBytes:&entryLength length:sizeof(entryLength)];
+
+				entryLength = CFSwapInt32BigToHost(entryLength);
 
-		self.truncationTimerScheduled = NO;
+				unsigned long long entryEnd = (entryOffset + sizeof(uint32_t) + entryLength);
+
+				if (entryEnd <= dataLength) {
+					indexedDataLength = entryEnd;
+
+					break;
+				}
+			}
+
+			indexLength -= sizeof(uint64_t);
+		}
+
+		if (indexLength < indexFileLength) {
+			[self.indexFileHandle truncateFileAtOffset:indexLength];
+
+			[self.segmentEntryCounts replaceObjectAtIndex:([self.segmentEntryCounts count] - 1)
+											   withObject:@(indexLength / sizeof(uint64_t))];
+		}
+
+		if (indexedDataLength < dataLength) {
+			[self.fileHandle truncateFileAtOffset:indexedDataLength];
+
+			self.writeOffset = indexedDataLength;
+		}
+
+		[self.indexFileHandle seekToEndOfFile];
+
+		[self.fileHandle seekToEndOfFile];
+	}
+	@catch (NSException *exception) {
+		[self close];
+
+		LogToConsole(@"An exception happened to a non-critical component of Textual.");
 	}
 }
 
-- (void)scheduleNextRandomFileTruncationEvent
+- (void)removeSegmentsExceedingMaximumLineCount
 {
-	/* File truncation events are scheduled to happen at random 
-	 intervals so they are all not running at one time. */
+	/* Whole segments are removed, oldest first, as long as the
+	 remaining segments still hold the maximum line count. */
+	NSInteger totalEntryCount = 0;
+
+	for (NSNumber *entryCount in self.segmentEntryCounts) {
+		totalEntryCount += [entryCount integerValue];
+	}
+
+	while ([self.segmentNumbers count] > 1) {
+		NSInteger oldestEntryCount = [self.segmentEntryCounts integerAtIndex:0];
+
+		if ((totalEntryCount - oldestEntryCount) < _maximumRowCountPerClient) {
+			break;
+		}
+
+		NSInteger segmentNumber = [self.segmentNumbers integerAtIndex:0];
 
-	if (self.truncationTimerScheduled == NO) {
-		NSInteger timeInterval = ((arc4random() % 951) + 950); // ~15 minutes
+		[RZFileManager() removeItemAtPath:[self dataPathForSegment:segmentNumber] error:NULL];
+		[RZFileManager() removeItemAtPath:[self indexPathForSegment:segmentNumber] error:NULL];
+		[RZFileManager() removeItemAtPath:[self stringTablePathForSegment:segmentNumber] error:NULL];
 
-		[self performSelector:@selector(truncateFileToMatchDefinedMaximumLineCount)
-				   withObject:nil
-				   afterDelay:timeInterval];
+		[self.segmentNumbers removeObjectAtIndex:0];
+		[self.segmentEntryCounts removeObjectAtIndex:0];
 
-		self.truncationTimerScheduled = YES;
+		totalEntryCount -= oldestEntryCount;
 	}
 }
 
-- (void)truncateFileToMatchDefinedMaximumLineCount
+- (void)readEntriesFromSegment:(NSInteger)segmentNumber skippingEntries:(NSInteger)entriesToSkip intoArray:(NSMutableArray *)entries
 {
-	DebugLogToConsole(@"Performing truncation on file to meet maximum line count of %i.", _maximumRowCountPerClient);
+	NSFileHandle *dataFile = [NSFileHandle fileHandleForReadingAtPath:[self dataPathForSegment:segmentNumber]];
 
-	if (self.fileHandle) {
-		@autoreleasepool {
-			/* Close the open file handle. */
-			[self close];
+	PointerIsEmptyAssert(dataFile);
 
-			/* Read contents of file. */
-			NSData *rawdata = [NSData dataWithContentsOfFile:[self writePath] options:NSDataReadingUncached error:NULL];
+	@try {
+		/* Find where the first wanted entry begins using the index. */
+		unsigned long long readOffset = 0;
 
-			NSObjectIsEmptyAssert(rawdata);
+		if (entriesToSkip > 0) {
+			NSFileHandle *indexFile = [NSFileHandle fileHandleForReadingAtPath:[self indexPathForSegment:segmentNumber]];
 
-			/* Discussion: Yes, I could simply convert this NSData chunk to 
-			 an NSString, split it, and be done with it... BUT, NSJSONSerialization
-			 which the data will ultimately be fed to only accepts NSData so
-			 the workload of converting this to NSString then converting the
-			 individual chunks back to NSData is a lot of overhead. That is
-			 why I implement such a messy while loop that gets the range of
-			 every newline and breaks it apart into smaller data. */
-			/* The same idea applies to the code for reading entries which
-			 is inherited from this codebase. */
-			/* Seek each newline, truncate to that, insert into array, then
-			 find the next one and repeat process until there are no more. */
-			NSMutableArray *alllines = [NSMutableArray array];
+			PointerIsEmptyAssert(indexFile);
 
-			NSMutableData *mutdata = [rawdata mutableCopy];
+			[indexFile seekToFileOffset:(entriesToSkip * sizeof(uint64_t))];
 
-			NSInteger startIndex = 0;
+			NSData *indexData = [indexFile readDataOfLength:sizeof(uint64_t)];
 
-			while (1 == 1) {
-				/* Our scan range is the range from last newline. */
-				NSRange scanrange = NSMakeRange(startIndex, ([mutdata length] - startIndex));
+			[indexFile closeFile];
 
-				NSRange nlrang = [mutdata rangeOfData:[NSData lineFeed] options:0 range:scanrange];
+			NSAssertReturn([indexData length] == sizeof(uint64_t));
 
-				/* If no more newlines are found, then there is nothing to do. */
-				if (nlrang.location == NSNotFound) {
-					break; // No newline was found.
-				} else {
-					[alllines addObject:@(nlrang.location)];
+			uint64_t indexValue = 0;
 
-					startIndex = (nlrang.location + 1);
-				}
-			}
+			[indexData getBytes:&indexValue length:sizeof(indexValue)];
 
-			/* Now that we have all lines, limit them based on fetch count. */
-			if ([alllines count] > _maximumRowCountPerClient) {
-				/* The last possible index is the line which will be truncated to. This line
-				 is calculated by taking the maximum number of clients and subtracting the
-				 file number of lines from it. That will give us a negative number, so we
-				 times it by -1. After that, we minus one so the only rows remaining are the
-				 number that we have defined as maximum. */
-				NSInteger lastPosIndex = (((_maximumRowCountPerClient - [alllines count]) * -(1)) - 1);
+			readOffset = CFSwapInt64BigToHost(indexValue);
+		}
 
-				/* Add 1 to not have first line a newline. */
-				NSInteger lastBytePos = ([alllines integerAtIndex:lastPosIndex] + 1);
+		[dataFile seekToFileOffset:readOffset];
 
-				NSRange cutRange = NSMakeRange(lastBytePos, ([rawdata length] - lastBytePos));
+		NSData *segmentData = [dataFile readDataToEndOfFile];
 
-				NSData *finalData = [rawdata subdataWithRange:cutRange];
+		[dataFile closeFile];
 
-				/* We completely clear out file, write the new data, then save it. */
-				NSError *writeError = nil;
+		TVCLogLineStringTable *stringTable = [self stringTableForSegment:segmentNumber];
 
-				if ([finalData writeToFile:[self writePath] options:NSDataWritingAtomic error:&writeError] == NO) {
-					LogToConsole(@"Failed to write file to disk: %@", [writeError localizedDescription]);
-				}
+		/* Split the data at each length prefix. A truncated
+		 entry at the end of the segment is ignored. */
+		const uint8_t *bytes = [segmentData bytes];
+
+		NSUInteger length = [segmentData length];
+
+		NSUInteger position = 0;
+
+		while ((position + sizeof(uint32_t)) <= length) {
+			uint32_t entryLength = 0;
+
+			memcpy(&entryLength, (bytes + position), sizeof(entryLength));
+
+			entryLength = CFSwapInt32BigToHost(entryLength);
+
+			position += sizeof(entryLength);
+
+			if ((position + entryLength) > length) {
+				break;
 			}
+
+			NSData *entryData = [segmentData subdataWithRange:NSMakeRange(position, entryLength)];
+
+			TVCLogLine *logLine = [[TVCLogLine alloc] initWithBinaryRepresentation:entryData stringTable:stringTable];
+
+			if (logLine) {
+				[entries addObject:logLine];
+			}
+
+			position += entryLength;
 		}
 	}
-
-	/* Reset timer. */
-	self.truncationTimerScheduled = NO;
+	@catch (NSException *exception) {
+		LogToConsole(@"An exception happened to a non-critical component of Textual.");
+	}
 }
 
-- (NSArray *)listEntriesWithFetchLimit:(NSUInteger)maxEntryCount
+#pragma mark -
+#pragma mark Legacy Format
+
+- (void)migrateLegacyLogFile
 {
-	@autoreleasepool {
-		/* Close the open file handle. */
-		[self close];
+	/* Earlier versions kept a single file of newline separated JSON.
+	 Its newest entries are carried over then the file is removed. The
+	 file is kept if they cannot be written so migration is tried again. */
+	NSString *legacyPath = [self legacyWritePath];
 
-		/* Read contents of file. */
-		NSData *rawdata = [NSData dataWithContentsOfFile:[self writePath] options:NSDataReadingUncached error:NULL];
+	NSAssertReturn([RZFileManager() fileExistsAtPath:legacyPath]);
 
-		NSObjectIsEmptyAssertReturn(rawdata, nil);
+	@autoreleasepool {
+		NSError *readError = nil;
 
-		/* Seek each newline, truncate to that, insert into array, then 
-		 find the next one and repeat process until there are no more. */
-		NSMutableArray *alllines = [NSMutableArray array];
+		NSData *rawdata = [NSData dataWithContentsOfFile:legacyPath options:NSDataReadingUncached error:&readError];
+
+		if (rawdata == nil) {
+			LogToConsole(@"Failed to read legacy log file: %@", [readError localizedDescription]);
 
-		NSMutableData *mutdata = [rawdata mutableCopy];
+			return;
+		}
 
-		while (1 == 1) {
-			NSRange scanrange = NSMakeRange(0, [mutdata length]);
+		NSMutableArray *alllines = [NSMutableArray array];
 
-			NSRange nlrang = [mutdata rangeOfData:[NSData lineFeed] options:0 range:scanrange];
+		const char *bytes = [rawdata bytes];
 
-			if (nlrang.location == NSNotFound) {
-				break; // No newline was found.
-			} else {
-				NSRange cutRange = NSMakeRange(0, (nlrang.location + 1));
+		NSUInteger length = [rawdata length];
 
-				NSData *chunkedData = [mutdata subdataWithRange:cutRange];
+		NSUInteger lineStart = 0;
 
-				[alllines addObject:chunkedData];
+		for (NSUInteger i = 0; i < length; i++) {
+			if (bytes[i] == '\n') {
+				if (i > lineStart) {
+					[alllines addObject:[NSValue valueWithRange:NSMakeRange(lineStart, (i - lineStart))]];
+				}
 
-				[mutdata replaceBytesInRange:cutRange withBytes:NULL length:0];
+				lineStart = (i + 1);
 			}
 		}
 
-		/* Now that we have all lines, limit them based on fetch count. */
-		if ([alllines count] > maxEntryCount) {
-			NSInteger finalCount = [alllines count];
+		if ([alllines count] > _maximumRowCountPerClient) {
+			[alllines removeObjectsInRange:NSMakeRange(0, ([alllines count] - _maximumRowCountPerClient))];
+		}
 
-			NSInteger startingIndex = ((maxEntryCount - finalCount) * -(1));
+		NSMutableArray *logLines = [NSMutableArray arrayWithCapacity:[alllines count]];
 
-			NSMutableArray *countedEntries = [NSMutableArray array];
+		for (NSValue *lineRange in alllines) {
+			NSData *jsondata = [rawdata subdataWithRange:[lineRange rangeValue]];
 
-			for (NSInteger i = startingIndex; i < finalCount; i++)
-			{
-				[countedEntries addObject:alllines[i]];
+			TVCLogLine *logLine = [[TVCLogLine alloc] initWithRawJSONData:jsondata];
+
+			if (logLine) {
+				[logLines addObject:logLine];
 			}
+		}
+
+		if ([logLines count] > 0) {
+			NSAssertReturn([self createArchiveFolder]);
 
-			return countedEntries;
+			NSAssertReturn([self writeNewEntriesForLogLines:logLines]);
 		}
 
-		/* Return found data. */
-		return alllines;
+		/* Nothing in the file could be used or all of it was carried over. */
+		[RZFileManager() removeItemAtPath:legacyPath error:NULL];
 	}
 }
 
+- (NSString *)legacyWritePath
+{
+	return [[self writePath] stringByAppendingPathExtension:@"json"];
+}
+
 #pragma mark -
 #pragma mark Private API
 
+- (NSString *)dataPathForSegment:(NSInteger)segmentNumber
+{
+	NSString *filename = [NSString stringWithFormat:@"%08ld.%@", (long)segmentNumber, _segmentDataFileExtension];
+
+	return [[self writePath] stringByAppendingPathComponent:filename];
+}
+
+- (NSString *)indexPathForSegment:(NSInteger)segmentNumber
+{
+	NSString *filename = [NSString stringWithFormat:@"%08ld.%@", (long)segmentNumber, _segmentIndexFileExtension];
+
+	return [[self writePath] stringByAppendingPathComponent:filename];
+}
+
+- (NSString *)stringTablePathForSegment:(NSInteger)segmentNumber
+{
+	NSString *filename = [NSString stringWithFormat:@"%08ld.%@", (long)segmentNumber, _segmentStringTableFileExtension];
+
+	return [[self writePath] stringByAppendingPathComponent:filename];
+}
+
+- (TVCLogLineStringTable *)stringTableForSegment:(NSInteger)segmentNumber
+{
+	return [self stringTableForSegment:segmentNumber loadedLength:NULL];
+}
+
+- (TVCLogLineStringTable *)stringTableForSegment:(NSInteger)segmentNumber loadedLength:(NSUInteger *)loadedLength
+{
+	TVCLogLineStringTable *stringTable = [TVCLogLineStringTable new];
+
+	NSData *definitions = [NSData dataWithContentsOfFile:[self stringTablePathForSegment:segmentNumber]
+												 options:NSDataReadingUncached
+												   error:NULL];
+
+	NSUInteger definitionsLength = 0;
+
+	if (definitions) {
+		definitionsLength = [stringTable loadDefinitions:definitions];
+	}
+
+	if (loadedLength) {
+		*loadedLength = definitionsLength;
+	}
+
+	return stringTable;
+}
+
 - (NSString *)writePath
 {
 	NSString *cachesFolder = [TPCPathInfo applicationCachesFolderPath];
@@ -330,9 +712,9 @@
 	NSString *combinedName = nil;
 
 	if (channel) {
-		combinedName = [NSString stringWithFormat:@"/MessageArchive/%@/historicLogFile-%@.json", [client uniqueIdentifier], [channel uniqueIdentifier]];
+		combinedName = [NSString stringWithFormat:@"/MessageArchive/%@/historicLogFile-%@", [client uniqueIdentifier], [channel uniqueIdentifier]];
 	} else {
-		combinedName = [NSString stringWithFormat:@"/MessageArchive/%@/historicLogFile-console.json", [client uniqueIdentifier]];
+		combinedName = [NSString stringWithFormat:@"/MessageArchive/%@/historicLogFile-console", [client uniqueIdentifier]];
 	}
 
 	return [cachesFolder stringByAppendingPathComponent:combinedName];
@@ -37,15 +37,41 @@
 
 #import "TextualApplication.h"
 
+/* Number of serial lanes in the shared worker pool. */
+#define _workerPoolLaneCount				6
+
+/* Number of operations a lane runs for one view before it yields
+ to other views sharing the same lane. */
+#define _workerPoolDrainBatchSize			25
+
 #pragma mark -
 #pragma mark Define Private Header
 
-@interface TVCLogControllerOperationItem : NSOperation
-@property (nonatomic, weak) TVCLogController *controller;
+@class TVCLogControllerOperationContext;
+
+@interface TVCLogControllerOperationItem : NSObject
+@property (nonatomic, weak) TVCLogControllerOperationContext *context;
 @property (nonatomic, copy) TVCLogControllerOperationBlock executionBlock;
-@property (nonatomic, assign) BOOL isStandalone;
+@property (nonatomic, assign) NSUInteger generation;
+@property (nonatomic, assign) CFAbsoluteTime enqueueTime;
+
+- (BOOL)isCancelled;
+@end
+
+@interface TVCLogControllerOperationContext : NSObject
+@property (nonatomic, weak) TVCLogController *controller;
+@property (nonatomic, strong) dispatch_queue_t lane;
+@property (nonatomic, strong) NSMutableArray *pendingItems;
+@property (nonatomic, strong) NSMutableArray *pendingStandaloneItems;
+@property (nonatomic, assign) NSUInteger generation;
+@property (nonatomic, assign) BOOL isDraining;
+@property (nonatomic, assign) NSInteger executedOperationCount;
+@property (nonatomic, assign) NSTimeInterval totalOperationLatency;
+@property (nonatomic, assign) NSTimeInterval maximumOperationLatency;
+@end
 
-- (NSInteger)dependencyCount;
+@interface TVCLogControllerOperationQueue ()
+@property (nonatomic, strong) NSMapTable *viewContexts;
 @end
 
 #pragma mark -
@@ -56,9 +82,7 @@
 - (instancetype)init
 {
 	if ((self = [super init])) {
-		[self setName:@"TVCLogControllerOperationQueue"];
-		
-		[self setMaxConcurrentOperationCount:6];
+		self.viewContexts = [NSMapTable weakToStrongObjectsMapTable];
 
 		return self;
 	}
@@ -66,6 +90,58 @@
 	return nil;
 }
 
+#pragma mark -
+#pragma mark Worker Pool
+
++ (dispatch_queue_t)nextWorkerPoolLane
+{
+	static dispatch_queue_t workerPoolLanes[_workerPoolLaneCount];
+
+	static NSUInteger nextLane = 0;
+
+	static dispatch_once_t onceToken;
+
+	dispatch_once(&onceToken, ^{
+		for (NSInteger i = 0; i < _workerPoolLaneCount; i++) {
+			NSString *laneName = [NSString stringWithFormat:@"TVCLogControllerOperationQueue.%ld", (long)i];
+
+			workerPoolLanes[i] = dispatch_queue_create([laneName UTF8String], DISPATCH_QUEUE_SERIAL);
+		}
+	});
+
+	/* Views are assigned a lane round robin when they are first seen. */
+	@synchronized(self) {
+		dispatch_queue_t lane = workerPoolLanes[nextLane];
+
+		nextLane = ((nextLane + 1) % _workerPoolLaneCount);
+
+		return lane;
+	}
+}
+
+- (TVCLogControllerOperationContext *)contextForViewController:(TVCLogController *)controller createIfMissing:(BOOL)createIfMissing
+{
+	PointerIsEmptyAssertReturn(controller, nil);
+
+	@synchronized(self.viewContexts) {
+		TVCLogControllerOperationContext *context = [self.viewContexts objectForKey:controller];
+
+		if (context == nil && createIfMissing) {
+			context = [TVCLogControllerOperationContext new];
+
+			[context setController:controller];
+			[context setLane:[TVCLogControllerOperationQueue nextWorkerPoolLane]];
+
+			[context setPendingItems:[NSMutableArray new]];
+			[context setPendingStandaloneItems:[NSMutableArray new]];
+
+			[self.viewContexts setObject:context forKey:controller];
+		}
+
+		return context;
+	}
+}
+
 #pragma mark -
 #pragma mark Queue Additions
 
@@ -76,39 +152,161 @@
 
 - (void)enqueueMessageBlock:(TVCLogControllerOperationBlock)callbackBlock for:(TVCLogController *)sender isStandalone:(BOOL)isStandalone
 {
-	[self performBlockOnMainThread:^{
-		PointerIsEmptyAssert(callbackBlock);
-		PointerIsEmptyAssert(sender);
+	PointerIsEmptyAssert(callbackBlock);
+	PointerIsEmptyAssert(sender);
 
-		/* Create operation. */
-		TVCLogControllerOperationItem *operation = [TVCLogControllerOperationItem new];
+	TVCLogControllerOperationContext *context = [self contextForViewController:sender createIfMissing:YES];
 
-		TVCLogControllerOperationItem *lastOp = (id)[self dependencyOfLastQueueItem:sender];
+	/* Create operation. */
+	TVCLogControllerOperationItem *operation = [TVCLogControllerOperationItem new];
 
-		if (lastOp) {
-			[operation addDependency:lastOp];
+	[operation setContext:context];
+	[operation setExecutionBlock:callbackBlock];
+	[operation setEnqueueTime:CFAbsoluteTimeGetCurrent()];
+
+	BOOL viewIsLoaded = [sender isLoaded];
+
+	@synchronized(context) {
+		[operation setGeneration:[context generation]];
+
+		if (isStandalone) {
+			/* Standalone operations do not wait on the queue
+			 for this view. They only wait on the view itself. */
+			if (viewIsLoaded == NO) {
+				[[context pendingStandaloneItems] addObject:operation];
+
+				return;
+			}
+		} else {
+			[[context pendingItems] addObject:operation];
 		}
+	}
 
-		[operation setController:sender];
-		[operation setIsStandalone:isStandalone];
-		[operation setExecutionBlock:callbackBlock];
+	if (isStandalone) {
+		[self performStandaloneOperation:operation];
+	} else if (viewIsLoaded) {
+		[self drainContext:context];
+	}
+}
 
-		/* Add the operations. */
-		[self addOperation:operation];
-	}];
+#pragma mark -
+#pragma mark Execution
+
+- (void)performStandaloneOperation:(TVCLogControllerOperationItem *)operation
+{
+	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+		[self performOperation:operation];
+	});
+}
+
+- (void)performOperation:(TVCLogControllerOperationItem *)operation
+{
+	TVCLogControllerOperationContext *context = [operation context];
+
+	PointerIsEmptyAssert(context);
+
+	/* An operation cancelled before it started is dropped. One
+	 cancelled while running finds out through -isCancelled. */
+	NSAssertReturn([operation isCancelled] == NO);
+
+	NSTimeInterval latency = (CFAbsoluteTimeGetCurrent() - [operation enqueueTime]);
+
+	@synchronized(context) {
+		[context setExecutedOperationCount:([context executedOperationCount] + 1)];
+
+		[context setTotalOperationLatency:([context totalOperationLatency] + latency)];
+
+		if (latency > [context maximumOperationLatency]) {
+			[context setMaximumOperationLatency:latency];
+		}
+	}
+
+	@autoreleasepool {
+		[operation executionBlock](operation);
+	}
+
+	/* Dereference everything associated with this operation. */
+	[operation setExecutionBlock:nil];
+}
+
+- (void)drainContext:(TVCLogControllerOperationContext *)context
+{
+	@synchronized(context) {
+		/* Only one drain per view is ever in flight. That
+		 is what keeps operations for a view in order. */
+		if ([context isDraining]) {
+			return;
+		}
+
+		NSObjectIsEmptyAssert([context pendingItems]);
+
+		[context setIsDraining:YES];
+	}
+
+	dispatch_async([context lane], ^{
+		for (NSInteger i = 0; i < _workerPoolDrainBatchSize; i++) {
+			TVCLogControllerOperationItem *operation = nil;
+
+			@synchronized(context) {
+				NSMutableArray *pendingItems = [context pendingItems];
+
+				if ([pendingItems count] == 0 || [[context controller] isLoaded] == NO) {
+					[context setIsDraining:NO];
+
+					return;
+				}
+
+				operation = pendingItems[0];
+
+				[pendingItems removeObjectAtIndex:0];
+			}
+
+			[self performOperation:operation];
+		}
+
+		/* Yield the lane to other views then continue. */
+		@synchronized(context) {
+			[context setIsDraining:NO];
+		}
+
+		[self drainContext:context];
+	});
 }
 
 #pragma mark -
 #pragma mark cancelAllOperations Substitue
 
-/* cancelOperationsForViewController should be called from the main queue. */
 - (void)cancelOperationsForViewController:(TVCLogController *)controller
 {
-	/* Cancel all. */
-	for (id operation in [self operations]) {
-		if ([operation controller] == controller) {
-			[operation cancel];
-		}
+	TVCLogControllerOperationContext *context = [self contextForViewController:controller createIfMissing:NO];
+
+	PointerIsEmptyAssert(context);
+
+	[self cancelOperationsInContext:context];
+}
+
+- (void)cancelOperationsInContext:(TVCLogControllerOperationContext *)context
+{
+	/* Bumping the generation cancels every operation enqueued before
+	 now, including one that is running, without visiting any of them. */
+	@synchronized(context) {
+		[context setGeneration:([context generation] + 1)];
+
+		[context setPendingItems:[NSMutableArray new]];
+		[context setPendingStandaloneItems:[NSMutableArray new]];
+	}
+}
+
+- (void)cancelAllOperations
+{
+	NSArray *contexts = nil;
+
+	@synchronized(self.viewContexts) {
+		contexts = [[self.viewContexts objectEnumerator] allObjects];
+	}
+
+	for (TVCLogControllerOperationContext *context in contexts) {
+		[self cancelOperationsInContext:context];
 	}
 }
 
@@ -127,99 +325,92 @@
 
 - (void)updateReadinessState:(TVCLogController *)controller
 {
-	[self performBlockOnMainThread:^{
-		/* Mark all objects part of this controller
-		 that are not cancelled and have no dependencies
-		 as ready or maybe is ready. */
-		PointerIsEmptyAssert(controller);
-
-		for (id operation in [self operations]) {
-			if ([operation controller] == controller) {
-				NSInteger depCount = [operation dependencyCount];
-
-				if ([operation isCancelled] == NO) {
-					if (depCount <= 0) {
-						[operation willChangeValueForKey:@"isReady"];
-						[operation didChangeValueForKey:@"isReady"];
-					}
-				}
-			}
-		}
-	}];
-}
+	/* Called once a view has loaded. Release anything that was waiting on it. */
+	TVCLogControllerOperationContext *context = [self contextForViewController:controller createIfMissing:NO];
 
-#pragma mark -
-#pragma mark Dependency
+	PointerIsEmptyAssert(context);
 
-- (NSOperation *)dependencyOfLastQueueItem:(TVCLogController *)controller
-{
-	/* This is called internally already from a method that is running on the
-	 main queue so we will not wrap this in it. */
-	for (id operation in [[self operations] reverseObjectEnumerator]) {
-		if ([operation controller] == controller) {
-			if ([operation isCancelled] == NO) {
-				if ([operation isStandalone] == NO) {
-					return operation;
-				}
-			}
-		}
+	NSArray *standaloneItems = nil;
+
+	@synchronized(context) {
+		standaloneItems = [context pendingStandaloneItems];
+
+		[context setPendingStandaloneItems:[NSMutableArray new]];
 	}
 
-	return nil;
-}
+	for (TVCLogControllerOperationItem *operation in standaloneItems) {
+		[self performStandaloneOperation:operation];
+	}
 
-@end
+	[self drainContext:context];
+}
 
 #pragma mark -
-#pragma mark Operation Queue Items
-
-@implementation TVCLogControllerOperationItem
+#pragma mark Statistics
 
-- (NSInteger)dependencyCount
+- (NSInteger)pendingOperationCountForViewController:(TVCLogController *)controller
 {
-	return [[self dependencies] count];
+	TVCLogControllerOperationContext *context = [self contextForViewController:controller createIfMissing:NO];
+
+	PointerIsEmptyAssertReturn(context, 0);
+
+	@synchronized(context) {
+		return ([[context pendingItems] count] + [[context pendingStandaloneItems] count]);
+	}
 }
 
-- (void)main
+- (NSTimeInterval)averageOperationLatencyForViewController:(TVCLogController *)controller
 {
-	/* Perform task. */
-	self.executionBlock(self);
+	TVCLogControllerOperationContext *context = [self contextForViewController:controller createIfMissing:NO];
 
-	/* Dereference everything associated with this operation. */
-	[self setController:nil];
-	[self setExecutionBlock:nil];
+	PointerIsEmptyAssertReturn(context, 0);
 
-	/* Kill existing dependency. */
-	/* Discussion: Normally NSOperationQueue removes all strong references to
-	 dependencies once all operations have completed. As this operation queue
-	 can have thousands of operations chained together, this is not a desired
-	 behavior as a pseudo infinite loop can be created. Therefore, once we
-	 have executed the block we wanted, we release any dependency assigned. */
-	NSArray *operations = [self dependencies];
+	@synchronized(context) {
+		NSInteger executedCount = [context executedOperationCount];
 
-	for (id operation in operations) {
-		[self removeDependency:operation];
+		if (executedCount == 0) {
+			return 0;
+		}
+
+		return ([context totalOperationLatency] / executedCount);
 	}
 }
 
-- (BOOL)isReady
+- (NSTimeInterval)maximumOperationLatencyForViewController:(TVCLogController *)controller
 {
-	NSInteger depCount = [self dependencyCount];
+	TVCLogControllerOperationContext *context = [self contextForViewController:controller createIfMissing:NO];
 
-	if (depCount < 1 || [self isStandalone]) {
-		return ([super isReady] && [[self controller] isLoaded]);
-	} else {
-		return  [super isReady];
+	PointerIsEmptyAssertReturn(context, 0);
+
+	@synchronized(context) {
+		return [context maximumOperationLatency];
 	}
 }
 
-+ (BOOL)automaticallyNotifiesObserversForKey:(NSString *)key
+@end
+
+#pragma mark -
+#pragma mark Operation Queue Items
+
+@implementation TVCLogControllerOperationItem
+
+- (BOOL)isCancelled
 {
-	if ([key isEqualToString:@"isReady"]) {
+	TVCLogControllerOperationContext *context = [self context];
+
+	if (context == nil) {
 		return YES;
 	}
 
-	return [super automaticallyNotifiesObserversForKey:key];
+	@synchronized(context) {
+		return NSDissimilarObjects([self generation], [context generation]);
+	}
 }
 
 @end
+
+#pragma mark -
+#pragma mark Operation Queue Contexts
+
+@implementation TVCLogControllerOperationContext
+@end
@@ -0,0 +1,347 @@
+/* ********************************************************************* 
+                  _____         _               _
+                 |_   _|____  _| |_ _   _  __ _| |
+                   | |/ _ \ \/ / __| | | |/ _` | |
+                   | |  __/>  <| |_| |_| | (_| | |
+                   |_|\___/_/\_\\__|\__,_|\__,_|_|
+
+ Copyright (c) 2010 - 2015 Codeux Software, LLC & respective contributors.
+        Please see Acknowledgements.pdf for additional information.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Textual and/or "Codeux Software, LLC", nor the 
+      names of its contributors may be used to endorse or promote products 
+      derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+ *********************************************************************** */
+
+#import "TextualApplication.h"
+
+#define _scrollbackModelInitialSlotCount		256
+
+@interface TVCLogControllerScrollbackEntry : NSObject
+@property (nonatomic, copy) NSString *lineNumber;
+@property (nonatomic, copy) NSString *html;
+@property (nonatomic, assign) BOOL highlighted;
+@end
+
+@interface TVCLogControllerScrollbackModel ()
+@property (nonatomic, assign) NSInteger slotCount;
+@property (nonatomic, assign) NSInteger firstSequence;
+@property (nonatomic, assign) NSInteger count;
+@property (nonatomic, assign) NSInteger headIndex;
+@property (nonatomic, strong) NSMutableArray *slots;
+@property (nonatomic, strong) NSMutableDictionary *sequenceIndex;
+@property (nonatomic, strong) NSMutableArray *highlightedLines;
+@end
+
+@implementation TVCLogControllerScrollbackModel
+
+- (instancetype)init
+{
+	return [self initWithCapacity:1000];
+}
+
+- (instancetype)initWithCapacity:(NSInteger)capacity
+{
+	if ((self = [super init])) {
+		_capacity = MAX(capacity, 0);
+
+		self.slots = [NSMutableArray array];
+
+		self.sequenceIndex = [NSMutableDictionary dictionary];
+
+		self.highlightedLines = [NSMutableArray array];
+
+		self.firstSequence = 0;
+		self.count = 0;
+		self.headIndex = 0;
+
+		[self resizeSlotsToCount:[self initialSlotCount]];
+
+		return self;
+	}
+
+	return nil;
+}
+
+#pragma mark -
+#pragma mark Ring Buffer
+
+- (NSInteger)endSequence
+{
+	return (self.firstSequence + self.count);
+}
+
+- (NSInteger)slotIndexForSequence:(NSInteger)sequence
+{
+	return ((self.headIndex + (sequence - self.firstSequence)) % self.slotCount);
+}
+
+- (BOOL)isUnbounded
+{
+	return (self.capacity == 0);
+}
+
+- (NSInteger)initialSlotCount
+{
+	if ([self isUnbounded]) {
+		return _scrollbackModelInitialSlotCount;
+	} else {
+		return MIN(self.capacity, _scrollbackModelInitialSlotCount);
+	}
+}
+
+- (BOOL)isFull
+{
+	return ([self isUnbounded] == NO && self.count >= self.capacity);
+}
+
+/* Slots are allocated as lines arrive so a large or unlimited
+ capacity costs nothing until the lines actually exist. */
+- (void)growSlotsIfNeeded
+{
+	if (self.count < self.slotCount) {
+		return;
+	}
+
+	NSInteger newSlotCount = (self.slotCount * 2);
+
+	if ([self isUnbounded] == NO) {
+		newSlotCount = MIN(newSlotCount, self.capacity);
+	}
+
+	[self resizeSlotsToCount:newSlotCount];
+}
+
+/* Lays the held lines out from the start of a slot array of the given size. */
+- (void)resizeSlotsToCount:(NSInteger)slotCount
+{
+	slotCount = MAX(slotCount, MAX(self.count, 1));
+
+	NSMutableArray *newSlots = [NSMutableArray arrayWithCapacity:slotCount];
+
+	for (NSInteger i = 0; i < self.count; i++) {
+		[newSlots addObject:self.slots[((self.headIndex + i) % self.slotCount)]];
+	}
+
+	for (NSInteger i = self.count; i < slotCount; i++) {
+		[newSlots addObject:[NSNull null]];
+	}
+
+	self.slots = newSlots;
+
+	self.slotCount = slotCount;
+
+	self.headIndex = 0;
+}
+
+- (void)discardOldestLine
+{
+	TVCLogControllerScrollbackEntry *oldestEntry = self.slots[self.headIndex];
+
+	[self.sequenceIndex removeObjectForKey:[oldestEntry lineNumber]];
+
+	if ([oldestEntry highlighted]) {
+		[self.highlightedLines removeObjectAtIndex:0];
+	}
+
+	self.slots[self.headIndex] = [NSNull null];
+
+	self.headIndex = ((self.headIndex + 1) % self.slotCount);
+
+	self.firstSequence += 1;
+	self.count -= 1;
+}
+
+- (void)setCapacity:(NSInteger)capacity
+{
+	capacity = MAX(capacity, 0);
+
+	@synchronized(self) {
+		_capacity = capacity;
+
+		if ([self isUnbounded]) {
+			return;
+		}
+
+		while (self.count > self.capacity) {
+			[self discardOldestLine];
+		}
+
+		if (self.slotCount > self.capacity) {
+			[self resizeSlotsToCount:self.capacity];
+		}
+	}
+}
+
+- (TVCLogControllerScrollbackEntry *)entryAtSequence:(NSInteger)sequence
+{
+	if (sequence < self.firstSequence || sequence >= [self endSequence]) {
+		return nil;
+	}
+
+	return self.slots[[self slotIndexForSequence:sequence]];
+}
+
+- (TVCLogControllerScrollbackEntry *)entryWithLineNumber:(NSString *)lineNumber html:(NSString *)html highlighted:(BOOL)highlighted
+{
+	TVCLogControllerScrollbackEntry *entry = [TVCLogControllerScrollbackEntry new];
+
+	[entry setLineNumber:lineNumber];
+	[entry setHtml:html];
+	[entry setHighlighted:highlighted];
+
+	return entry;
+}
+
+- (void)appendLineNumber:(NSString *)lineNumber html:(NSString *)html highlighted:(BOOL)highlighted
+{
+	NSObjectIsEmptyAssert(lineNumber);
+	NSObjectIsEmptyAssert(html);
+
+	@synchronized(self) {
+		/* Make room by discarding the oldest line. */
+		if ([self isFull]) {
+			[self discardOldestLine];
+		}
+
+		[self growSlotsIfNeeded];
+
+		NSInteger sequence = [self endSequence];
+
+		self.slots[[self slotIndexForSequence:sequence]] = [self entryWithLineNumber:lineNumber html:html highlighted:highlighted];
+
+		self.sequenceIndex[lineNumber] = @(sequence);
+
+		if (highlighted) {
+			[self.highlightedLines addObject:lineNumber];
+		}
+
+		self.count += 1;
+	}
+}
+
+- (BOOL)prependLineNumber:(NSString *)lineNumber html:(NSString *)html highlighted:(BOOL)highlighted
+{
+	NSObjectIsEmptyAssertReturn(lineNumber, NO);
+	NSObjectIsEmptyAssertReturn(html, NO);
+
+	@synchronized(self) {
+		NSAssertReturnR(([self isFull] == NO), NO);
+
+		[self growSlotsIfNeeded];
+
+		self.headIndex = (((self.headIndex - 1) + self.slotCount) % self.slotCount);
+
+		self.firstSequence -= 1;
+		self.count += 1;
+
+		self.slots[self.headIndex] = [self entryWithLineNumber:lineNumber html:html highlighted:highlighted];
+
+		self.sequenceIndex[lineNumber] = @(self.firstSequence);
+
+		if (highlighted) {
+			[self.highlightedLines insertObject:lineNumber atIndex:0];
+		}
+
+		return YES;
+	}
+}
+
+- (void)removeAllLines
+{
+	@synchronized(self) {
+		[self.sequenceIndex removeAllObjects];
+
+		[self.highlightedLines removeAllObjects];
+
+		/* Sequence numbers keep counting up so a line number
+		 held by a caller is never mistaken for a new line. */
+		self.firstSequence = [self endSequence];
+
+		self.count = 0;
+		self.headIndex = 0;
+
+		[self.slots removeAllObjects];
+
+		[self resizeSlotsToCount:[self initialSlotCount]];
+	}
+}
+
+#pragma mark -
+#pragma mark Lookup
+
+- (NSString *)lineNumberAtSequence:(NSInteger)sequence
+{
+	@synchronized(self) {
+		return [[self entryAtSequence:sequence] lineNumber];
+	}
+}
+
+- (NSInteger)sequenceForLineNumber:(NSString *)lineNumber
+{
+	PointerIsEmptyAssertReturn(lineNumber, NSNotFound);
+
+	@synchronized(self) {
+		NSNumber *sequence = self.sequenceIndex[lineNumber];
+
+		if (sequence == nil) {
+			return NSNotFound;
+		}
+
+		return [sequence integerValue];
+	}
+}
+
+- (NSString *)htmlFromSequence:(NSInteger)startSequence toSequence:(NSInteger)endSequence
+{
+	@synchronized(self) {
+		startSequence = MAX(startSequence, self.firstSequence);
+
+		endSequence = MIN(endSequence, [self endSequence]);
+
+		NSMutableString *html = [NSMutableString string];
+
+		for (NSInteger sequence = startSequence; sequence < endSequence; sequence++) {
+			[html appendString:[[self entryAtSequence:sequence] html]];
+		}
+
+		return html;
+	}
+}
+
+- (NSArray *)highlightedLineNumbers
+{
+	@synchronized(self) {
+		return [self.highlightedLines copy];
+	}
+}
+
+@end
+
+#pragma mark -
+#pragma mark Scrollback Entries
+
+@implementation TVCLogControllerScrollbackEntry
+@end
@@ -40,6 +40,27 @@
 
 #import <objc/objc-runtime.h>
 
+/* Lines rendered by the printing queue are not handed to WebKit one at a time.
+ They are collected into a batch which is flushed on the main thread once per
+ frame interval, or sooner when the batch grows past the maximum size. A flush
+ performs a single DOM append for every line in the batch. */
+#define _printBatchFlushInterval			(NSEC_PER_SEC / 60)
+#define _printBatchMaximumLineCount			50
+
+/* Number of lines paged back into the WebView each time the top is reached. */
+#define _scrollbackPageLineCount			100
+
+@interface TVCLogControllerPrintBatchEntry : NSObject
+@property (nonatomic, strong) TVCLogLine *logLine;
+@property (nonatomic, copy) NSString *html;
+@property (nonatomic, copy) NSString *lineNumber;
+@property (nonatomic, copy) NSDictionary *resultInfo;
+@property (nonatomic, copy) void (^completionBlock)(BOOL highlighted);
+@end
+
+@implementation TVCLogControllerPrintBatchEntry
+@end
+
 @interface TVCLogController ()
 @property (nonatomic, assign) BOOL historyLoaded;
 @property (nonatomic, assign) BOOL windowScriptObjectLoaded;
@@ -49,8 +70,12 @@
 @property (nonatomic, strong) TVCWebViewAutoScroll *webViewAutoScroller;
 @property (nonatomic, strong) TVCLogControllerHistoricLogFile *historicLogFile;
 @property (nonatomic, assign) BOOL needsLimitNumberOfLines;
-@property (nonatomic, assign) NSInteger activeLineCount;
-@property (strong) NSMutableArray *highlightedLineNumbers;
+@property (nonatomic, strong) TVCLogControllerScrollbackModel *scrollbackModel;
+@property (nonatomic, assign) NSInteger firstDisplayedSequence;
+@property (strong) NSMutableArray *pendingPrintBatch;
+@property (assign) BOOL pendingPrintBatchFlushScheduled;
+
+- (void)pageInOlderLinesFromSequence:(NSInteger)startSequence;
 @end
 
 @implementation TVCLogController
@@ -61,12 +86,14 @@
 - (instancetype)init
 {
 	if ((self = [super init])) {
-		self.highlightedLineNumbers	= [NSMutableArray new];
+		self.scrollbackModel = [[TVCLogControllerScrollbackModel alloc] initWithCapacity:0];
+
+		self.firstDisplayedSequence = [self.scrollbackModel firstSequence];
+
+		self.pendingPrintBatch = [NSMutableArray new];
 		
 		self.lastVisitedHighlight = nil;
 		
-		self.activeLineCount = 0;
-
 		self.isLoaded = NO;
 
 		self.reloadingBacklog = NO;
@@ -138,6 +165,7 @@
 	[self.webViewScriptSink setLogController:self];
 
 	self.webViewAutoScroller = [TVCWebViewAutoScroll new];
+	[self.webViewAutoScroller setLogController:self];
 
 	 self.webView = [[TVCLogView alloc] initWithFrame:NSZeroRect];
 	
@@ -238,9 +266,13 @@
 	if (NSDissimilarObjects(self.maximumLineCount, value)) {
 		_maximumLineCount = value;
 
+		/* The model keeps every line the limit allows, and every
+		 line at all when there is no limit. */
+		[self.scrollbackModel setCapacity:MAX(value, 0)];
+
 		NSAssertReturn(self.isLoaded);
 
-		if (self.maximumLineCount > 0 && self.activeLineCount > self.maximumLineCount) {
+		if (self.maximumLineCount > 0 && [self displayedLineCount] > self.maximumLineCount) {
 			[self setNeedsLimitNumberOfLines];
 		}
 	}
@@ -381,6 +413,10 @@
 			NSAssertReturn([operation isCancelled] == NO);
 			
 			[self performBlockOnMainThread:^{
+				/* Lines printed before this command was queued may still be
+				 waiting in the print batch. They must reach WebKit first. */
+				[self flushPendingPrintBatch];
+
 				[self executeQuickScriptCommand:command withArguments:args];
 			}];
 		};
@@ -519,6 +555,10 @@
 {
 	NSAssertReturn(self.isLoaded);
 
+	/* Lines waiting in the print batch were printed before the mark and
+	 have to be in the document before it is placed after them. */
+	[self flushPendingPrintBatch];
+
 	DOMDocument *doc = [self mainFrameDocument];
 	PointerIsEmptyAssert(doc);
 
@@ -541,6 +581,8 @@
 {
 	NSAssertReturn(self.isLoaded);
 
+	[self flushPendingPrintBatch];
+
 	DOMDocument *doc = [self mainFrameDocument];
 	PointerIsEmptyAssert(doc);
 
@@ -574,16 +616,10 @@
 	/* Misc. data. */
 	NSMutableArray *lineNumbers = [NSMutableArray array];
 
-	NSMutableString *patchedAppend = [NSMutableString string];
-
-	NSMutableData *newHistoricArchive = [NSMutableData data];
+	NSMutableArray *newHistoricArchive = [NSMutableArray array];
 
 	/* Begin processing. */
-	for (NSData *chunkedData in oldLines) {
-		TVCLogLine *line = (id)[[TVCLogLine alloc] initWithRawJSONData:chunkedData];
-
-		PointerIsEmptyAssertLoopContinue(line);
-
+	for (TVCLogLine *line in oldLines) {
 		if (markHistoric) {
 			[line setIsHistoric:YES];
 		}
@@ -598,39 +634,48 @@
 		/* Gather result information. */
 		NSString *lineNumber = resultInfo[@"lineNumber"];
 
-		[patchedAppend appendString:html];
+		[lineNumbers addObject:@[lineNumber, resultInfo, html]];
 
-		[lineNumbers addObject:@[lineNumber, resultInfo]];
+		/* Queue for the historic archive. */
+		[newHistoricArchive addObject:line];
+	}
 
-		/* Write to JSON data. */
-		NSData *jsondata = [line jsonDictionaryRepresentation];
+	/* Update historic archive. */
+	[self.historicLogFile writeNewEntriesForLogLines:newHistoricArchive];
 
-		[newHistoricArchive appendData:jsondata];
-		[newHistoricArchive appendData:[NSData lineFeed]];
+	/* Update WebKit. */
+	[self performBlockOnMainThread:^{
+		/* The reloaded lines are older than anything in the model. They are
+		 prepended newest first until the model is full. Only the lines it
+		 accepted are added to the document, otherwise the document would
+		 hold lines the model cannot page back in once they scroll out. */
+		NSUInteger acceptedLineCount = 0;
 
-		/* Was it a highlight? */
-		BOOL highlighted = [resultInfo boolForKey:TVCLogRendererResultsKeywordMatchFoundAttribute];
+		for (NSArray *lineInfo in [lineNumbers reverseObjectEnumerator]) {
+			BOOL highlighted = [lineInfo[1] boolForKey:TVCLogRendererResultsKeywordMatchFoundAttribute];
 
-		if (highlighted) {
-			@synchronized(self.highlightedLineNumbers) {
-				[self.highlightedLineNumbers addObject:lineNumber];
+			if ([self.scrollbackModel prependLineNumber:lineInfo[0] html:lineInfo[2] highlighted:highlighted] == NO) {
+				break;
 			}
+
+			acceptedLineCount += 1;
 		}
-	}
 
-	/* Update historic archive. */
-	[self.historicLogFile writeNewEntryWithRawData:newHistoricArchive];
+		NSArray *acceptedLines = [lineNumbers subarrayWithRange:NSMakeRange(([lineNumbers count] - acceptedLineCount), acceptedLineCount)];
+
+		NSMutableString *patchedAppend = [NSMutableString string];
+
+		for (NSArray *lineInfo in acceptedLines) {
+			[patchedAppend appendString:lineInfo[2]];
+		}
 
-	/* Update WebKit. */
-	[self performBlockOnMainThread:^{
 		[self prependToDocumentBody:patchedAppend];
 
 		[self mark];
 
-		for (NSArray *lineInfo in lineNumbers) {
-			/* Update count. */
-			self.activeLineCount += 1;
+		self.firstDisplayedSequence = [self.scrollbackModel firstSequence];
 
+		for (NSArray *lineInfo in acceptedLines) {
 			/* Line info. */
 			NSString *lineNumber = lineInfo[0];
 
@@ -729,6 +774,13 @@
 
 - (void)jumpToLine:(NSString *)line
 {
+	/* The line may have been paged out of the WebView. */
+	NSInteger sequence = [self.scrollbackModel sequenceForLineNumber:line];
+
+	if (NSDissimilarObjects(sequence, NSNotFound) && sequence < self.firstDisplayedSequence) {
+		[self pageInOlderLinesFromSequence:sequence];
+	}
+
 	NSString *lid = [NSString stringWithFormat:@"line-%@", line];
 
 	if ([self jumpToElementID:lid]) {
@@ -779,31 +831,31 @@
 {
 	NSAssertReturnR(self.isLoaded, NO);
 
-	@synchronized(self.highlightedLineNumbers) {
-		NSObjectIsEmptyAssertReturn(self.highlightedLineNumbers, NO);
+	NSArray *highlightedLineNumbers = [self.scrollbackModel highlightedLineNumbers];
 
-		NSUInteger lastHighlightIndex = NSNotFound;
+	NSObjectIsEmptyAssertReturn(highlightedLineNumbers, NO);
 
-		if ([self.highlightedLineNumbers containsObject:self.lastVisitedHighlight]) {
-			lastHighlightIndex = [self.highlightedLineNumbers indexOfObject:self.lastVisitedHighlight];
-		}
+	NSUInteger lastHighlightIndex = NSNotFound;
 
-		if (previous == NO) {
-			if (lastHighlightIndex == ([self.highlightedLineNumbers count] - 1)) {
-				return NO;
-			} else {
-				return YES;
-			}
+	if (self.lastVisitedHighlight) {
+		lastHighlightIndex = [highlightedLineNumbers indexOfObject:self.lastVisitedHighlight];
+	}
+
+	if (previous == NO) {
+		if (lastHighlightIndex == ([highlightedLineNumbers count] - 1)) {
+			return NO;
 		} else {
-			if (lastHighlightIndex == 0) {
-				return NO;
-			} else {
-				return YES;
-			}
+			return YES;
+		}
+	} else {
+		if (lastHighlightIndex == 0) {
+			return NO;
+		} else {
+			return YES;
 		}
-
-		return NO;
 	}
+
+	return NO;
 }
 
 - (void)nextHighlight
@@ -812,27 +864,33 @@
 
 	DOMDocument *doc = [self mainFrameDocument];
 	PointerIsEmptyAssert(doc);
-	
-	@synchronized(self.highlightedLineNumbers) {
-		NSObjectIsEmptyAssert(self.highlightedLineNumbers);
 
-		if ([self.highlightedLineNumbers containsObject:self.lastVisitedHighlight]) {
-			NSUInteger hli_ci = [self.highlightedLineNumbers indexOfObject:self.lastVisitedHighlight];
+	/* Highlights are tracked by the scrollback model so those
+	 paged out of the WebView can still be navigated to. */
+	NSArray *highlightedLineNumbers = [self.scrollbackModel highlightedLineNumbers];
 
-			if (hli_ci == ([self.highlightedLineNumbers count] - 1)) {
-				// Return method since the last highlight we
-				// visited was the end of array. Nothing ahead.
+	NSObjectIsEmptyAssert(highlightedLineNumbers);
 
-				return;
-			} else {
-				self.lastVisitedHighlight = self.highlightedLineNumbers[(hli_ci + 1)];
-			}
+	NSUInteger hli_ci = NSNotFound;
+
+	if (self.lastVisitedHighlight) {
+		hli_ci = [highlightedLineNumbers indexOfObject:self.lastVisitedHighlight];
+	}
+
+	if (NSDissimilarObjects(hli_ci, NSNotFound)) {
+		if (hli_ci == ([highlightedLineNumbers count] - 1)) {
+			// Return method since the last highlight we
+			// visited was the end of array. Nothing ahead.
+
+			return;
 		} else {
-			self.lastVisitedHighlight = self.highlightedLineNumbers[0];
+			self.lastVisitedHighlight = highlightedLineNumbers[(hli_ci + 1)];
 		}
-
-		[self jumpToLine:self.lastVisitedHighlight];
+	} else {
+		self.lastVisitedHighlight = highlightedLineNumbers[0];
 	}
+
+	[self jumpToLine:self.lastVisitedHighlight];
 }
 
 - (void)previousHighlight
@@ -841,83 +899,162 @@
 
 	DOMDocument *doc = [self mainFrameDocument];
 	PointerIsEmptyAssert(doc);
-	
-	@synchronized(self.highlightedLineNumbers) {
-		NSObjectIsEmptyAssert(self.highlightedLineNumbers);
 
-		if ([self.highlightedLineNumbers containsObject:self.lastVisitedHighlight]) {
-			NSInteger hli_ci = [self.highlightedLineNumbers indexOfObject:self.lastVisitedHighlight];
+	NSArray *highlightedLineNumbers = [self.scrollbackModel highlightedLineNumbers];
 
-			if (hli_ci == 0) {
-				// Return method since the last highlight we
-				// visited was the start of array. Nothing ahead.
+	NSObjectIsEmptyAssert(highlightedLineNumbers);
 
-				return;
-			} else {
-				self.lastVisitedHighlight = self.highlightedLineNumbers[(hli_ci - 1)];
-			}
+	NSUInteger hli_ci = NSNotFound;
+
+	if (self.lastVisitedHighlight) {
+		hli_ci = [highlightedLineNumbers indexOfObject:self.lastVisitedHighlight];
+	}
+
+	if (NSDissimilarObjects(hli_ci, NSNotFound)) {
+		if (hli_ci == 0) {
+			// Return method since the last highlight we
+			// visited was the start of array. Nothing ahead.
+
+			return;
 		} else {
-			self.lastVisitedHighlight = self.highlightedLineNumbers[0];
+			self.lastVisitedHighlight = highlightedLineNumbers[(hli_ci - 1)];
 		}
-
-		[self jumpToLine:self.lastVisitedHighlight];
+	} else {
+		self.lastVisitedHighlight = highlightedLineNumbers[0];
 	}
+
+	[self jumpToLine:self.lastVisitedHighlight];
 }
 
 #pragma mark -
 #pragma mark Manage Scrollback Size
 
+- (NSInteger)displayedLineCount
+{
+	return ([self.scrollbackModel endSequence] - self.firstDisplayedSequence);
+}
+
 - (void)limitNumberOfLines
 {
 	self.needsLimitNumberOfLines = NO;
 
-	NSInteger n = (self.activeLineCount - self.maximumLineCount);
+	NSAssertReturn(self.isLoaded);
 
-	if (self.isLoaded == NO || n <= 0 || self.activeLineCount <= 0) {
-		return;
+	/* Lines that leave the WebView stay in the scrollback model so
+	 trimming never has to look anything up in the document. */
+	NSInteger newFirstSequence = ([self.scrollbackModel endSequence] - self.maximumLineCount);
+
+	if (self.maximumLineCount <= 0) {
+		newFirstSequence = [self.scrollbackModel firstSequence];
 	}
 
+	/* Never point before the oldest line the model still holds. */
+	newFirstSequence = MAX(newFirstSequence, [self.scrollbackModel firstSequence]);
+
+	NSAssertReturn(newFirstSequence > self.firstDisplayedSequence);
+
 	DOMDocument *doc = [self mainFrameDocument];
 	PointerIsEmptyAssert(doc);
 
 	DOMElement *body = [self documentBody];
 	PointerIsEmptyAssert(body);
 
-	DOMNodeList *nodeList = [body childNodes];
-	PointerIsEmptyAssert(nodeList);
+	DOMNode *firstNode = [body firstChild];
+	PointerIsEmptyAssert(firstNode);
 
-	n = (nodeList.length - self.maximumLineCount);
+	/* Everything before the first line to keep goes in one removal. */
+	NSString *lineNumber = [self.scrollbackModel lineNumberAtSequence:newFirstSequence];
 
-	/* Remove old lines. */
-	for (NSInteger i = (n - 1); i >= 0; --i) {
-		[body removeChild:[nodeList item:(unsigned)i]];
+	DOMElement *firstKeptLine = nil;
+
+	if (lineNumber) {
+		firstKeptLine = [doc getElementById:[NSString stringWithFormat:@"line-%@", lineNumber]];
 	}
 
-	self.activeLineCount -= n;
+	DOMRange *range = [doc createRange];
+
+	[range setStartBefore:firstNode];
 
-	if (self.activeLineCount < 0) {
-		self.activeLineCount = 0;
+	if (firstKeptLine) {
+		[range setEndBefore:firstKeptLine];
+	} else {
+		[range setEndAfter:[body lastChild]];
 	}
 
-	/* Update highlight index. */
-	@synchronized(self.highlightedLineNumbers) {
-		NSObjectIsEmptyAssert(self.highlightedLineNumbers);
+	/* Trimming also happens while scrolled up so the WebView never grows
+	 past the line limit. What the user is reading is kept in place as the
+	 content above it is removed, and scrolling to the top pages it back in. */
+	BOOL viewingBottom = [self viewingBottom];
 
-		NSMutableArray *newList = [NSMutableArray array];
+	NSView *documentView = [[self webFrameView] documentView];
 
-		for (NSString *lineNumber in self.highlightedLineNumbers) {
-			NSString *lid = [NSString stringWithFormat:@"line-%@", lineNumber];
+	NSClipView *clipView = [[documentView enclosingScrollView] contentView];
 
-			DOMElement *e = [doc getElementById:lid];
+	CGFloat oldDocumentHeight = NSHeight([documentView frame]);
 
-			/* If the element does not exist, then it means
-			 that we removed it up above. */
-			if (e) {
-				[newList addObject:lineNumber];
-			}
-		}
+	[range deleteContents];
+
+	self.firstDisplayedSequence = newFirstSequence;
+
+	NSAssertReturn(viewingBottom == NO);
+
+	[documentView layoutSubtreeIfNeeded];
+
+	CGFloat heightDifference = (oldDocumentHeight - NSHeight([documentView frame]));
+
+	if (clipView && heightDifference > 0) {
+		NSPoint scrollPoint = [clipView bounds].origin;
+
+		scrollPoint.y = MAX((scrollPoint.y - heightDifference), 0);
+
+		[clipView scrollToPoint:scrollPoint];
+
+		[[documentView enclosingScrollView] reflectScrolledClipView:clipView];
+	}
+}
+
+- (void)pageInOlderLines
+{
+	NSAssertReturn(self.isLoaded);
+
+	NSInteger startSequence = (self.firstDisplayedSequence - _scrollbackPageLineCount);
+
+	[self pageInOlderLinesFromSequence:startSequence];
+}
+
+- (void)pageInOlderLinesFromSequence:(NSInteger)startSequence
+{
+	startSequence = MAX(startSequence, [self.scrollbackModel firstSequence]);
+
+	NSAssertReturn(startSequence < self.firstDisplayedSequence);
+
+	NSString *html = [self.scrollbackModel htmlFromSequence:startSequence toSequence:self.firstDisplayedSequence];
+
+	NSObjectIsEmptyAssert(html);
+
+	/* Keep what the user is looking at in place as content is added above it. */
+	NSView *documentView = [[self webFrameView] documentView];
+
+	NSClipView *clipView = [[documentView enclosingScrollView] contentView];
 
-		self.highlightedLineNumbers = [newList mutableCopy];
+	CGFloat oldDocumentHeight = NSHeight([documentView frame]);
+
+	[self prependToDocumentBody:html];
+
+	self.firstDisplayedSequence = startSequence;
+
+	[documentView layoutSubtreeIfNeeded];
+
+	CGFloat heightDifference = (NSHeight([documentView frame]) - oldDocumentHeight);
+
+	if (clipView && heightDifference > 0) {
+		NSPoint scrollPoint = [clipView bounds].origin;
+
+		scrollPoint.y += heightDifference;
+
+		[clipView scrollToPoint:scrollPoint];
+
+		[[documentView enclosingScrollView] reflectScrolledClipView:clipView];
 	}
 }
 
@@ -937,15 +1074,19 @@
 	[self performBlockOnMainThread:^{
 		[[self printingQueue] cancelOperationsForViewController:self];
 
+		/* Anything still waiting in the print batch belongs to the old document. */
+		@synchronized(self.pendingPrintBatch) {
+			[self.pendingPrintBatch removeAllObjects];
+		}
+
 		if (resetQueue) {
 			[self.historicLogFile resetData];
 		}
 		
-		@synchronized(self.highlightedLineNumbers) {
-			[self.highlightedLineNumbers removeAllObjects];
-		}
-		
-		self.activeLineCount = 0;
+		[self.scrollbackModel removeAllLines];
+
+		self.firstDisplayedSequence = [self.scrollbackModel firstSequence];
+
 		self.lastVisitedHighlight = nil;
 
 		self.windowFrameObjectLoaded = NO;
@@ -1015,91 +1156,157 @@
 		NSString *html = [self renderLogLine:logLine resultInfo:&resultInfo];
 
 		if (html) {
-			/* Increment by one. */
-			self.activeLineCount += 1;
+			/* Queue the result for the next flush. */
+			TVCLogControllerPrintBatchEntry *entry = [TVCLogControllerPrintBatchEntry new];
 
-			/* Gather result information. */
-			BOOL highlighted = [resultInfo boolForKey:TVCLogRendererResultsKeywordMatchFoundAttribute];
+			[entry setLogLine:logLine];
+			[entry setHtml:html];
+			[entry setLineNumber:resultInfo[@"lineNumber"]];
+			[entry setResultInfo:resultInfo];
+			[entry setCompletionBlock:completionBlock];
 
-			NSString *lineNumber = resultInfo[@"lineNumber"];
-		  //NSString *renderTime = [resultInfo objectForKey:@"lineRenderTime"];
+			[self enqueuePrintBatchEntry:entry];
+		}
+	};
 
-			NSArray *mentionedUsers = [resultInfo arrayForKey:TVCLogRendererResultsListOfUsersFoundAttribute];
+	[[self printingQueue] enqueueMessageBlock:printBlock for:self];
+}
 
-			NSDictionary *inlineImageMatches = [resultInfo dictionaryForKey:@"InlineImagesToValidate"];
-			
-			[self performBlockOnMainThread:^{
-				/* Record highlights. */
-				if (highlighted) {
-					@synchronized(self.highlightedLineNumbers) {
-						[self.highlightedLineNumbers addObject:lineNumber];
-					}
-					
-					[self.associatedClient addHighlightInChannel:self.associatedChannel withLogLine:logLine];
-				}
+- (void)enqueuePrintBatchEntry:(TVCLogControllerPrintBatchEntry *)entry
+{
+	BOOL flushNow = NO;
+	BOOL scheduleFlush = NO;
 
-				/* Do the actual append to WebKit. */
-				[self appendToDocumentBody:html];
-
-				/* Inform the style of the new append. */
-				[self executeQuickScriptCommand:@"newMessagePostedToView" withArguments:@[lineNumber]];
-				
-				/* Inform plugins. */
-				[sharedPluginManager() postNewMessageEventForViewController:self
-																messageInfo:resultInfo[@"pluginDictionary"]
-															  isThemeReload:NO
-															isHistoryReload:NO];
-
-				/* Limit lines. */
-				if (self.maximumLineCount > 0 && (self.activeLineCount - 10) > self.maximumLineCount) {
-					/* Only cut lines if our number is divisible by 5. This makes it so every
-					 line is not using resources. */
-					
-					if ((self.activeLineCount % 5) == 0) {
-						[self setNeedsLimitNumberOfLines];
-					}
-				}
+	@synchronized(self.pendingPrintBatch) {
+		[self.pendingPrintBatch addObject:entry];
 
-				/* Begin processing inline images. */
-				/* We go through the inline image list here and pass to the loader now so that
-				 we know the links have hit the webview before we even try loading them. */
-				for (NSString *uniqueKey in inlineImageMatches) {
-					TVCImageURLoader *loader = [TVCImageURLoader new];
+		if ([self.pendingPrintBatch count] >= _printBatchMaximumLineCount) {
+			flushNow = YES;
+		} else if (self.pendingPrintBatchFlushScheduled == NO) {
+			self.pendingPrintBatchFlushScheduled = YES;
 
-					[loader assesURL:inlineImageMatches[uniqueKey] withID:uniqueKey forController:self];
-				}
-				
-				/* Log this log line. */
-				/* If the channel is encrypted, then we refuse to write to
-				 the actual historic log so there is no trace of the chatter
-				 on the disk in the form of an unencrypted cache file. */
-				/* Doing it this way does break the ability to reload chatter
-				 in the view as well as playback on restart, but the added
-				 security can be seen as a bonus. */
-				if (self.viewIsEncrypted == NO) {
-					[self.historicLogFile writeNewEntryForLogLine:logLine];
-				}
+			scheduleFlush = YES;
+		}
+	}
 
-				/* Using informationi provided by conversation tracking we can update our internal
-				 array of favored nicknames for nick completion. */
-				if ([logLine memberType] == TVCLogLineMemberLocalUserType) {
-					[mentionedUsers makeObjectsPerformSelector:@selector(outgoingConversation)];
-				} else {
-					[mentionedUsers makeObjectsPerformSelector:@selector(conversation)];
-				}
+	if (flushNow) {
+		/* A full batch is flushed synchronously so that a flood of incoming
+		 lines applies back pressure to the printing queue instead of growing
+		 the batch without limit. */
+		[self performBlockOnMainThread:^{
+			[self flushPendingPrintBatch];
+		}];
+	} else if (scheduleFlush) {
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, _printBatchFlushInterval), dispatch_get_main_queue(), ^{
+			[self flushPendingPrintBatch];
+		});
+	}
+}
 
-				/* Maybe redraw our frame. */
-				[self maybeRedrawFrame];
+- (void)flushPendingPrintBatch
+{
+	NSArray *batch = nil;
 
-				/* Finish up. */
-				PointerIsEmptyAssert(completionBlock);
+	@synchronized(self.pendingPrintBatch) {
+		self.pendingPrintBatchFlushScheduled = NO;
 
-				completionBlock(highlighted);
-			}];
+		NSObjectIsEmptyAssert(self.pendingPrintBatch);
+
+		batch = [self.pendingPrintBatch copy];
+
+		[self.pendingPrintBatch removeAllObjects];
+	}
+
+	/* Do the actual append to WebKit. One fragment is parsed and
+	 appended for the entire batch. */
+	NSMutableString *patchedAppend = [NSMutableString string];
+
+	NSMutableArray *lineNumbers = [NSMutableArray arrayWithCapacity:[batch count]];
+
+	for (TVCLogControllerPrintBatchEntry *entry in batch) {
+		[patchedAppend appendString:[entry html]];
+
+		[lineNumbers addObject:[entry lineNumber]];
+	}
+
+	[self appendToDocumentBody:patchedAppend];
+
+	/* Inform the style of the new append. */
+	[self executeQuickScriptCommand:@"newMessagesPostedToView" withArguments:@[lineNumbers]];
+
+	NSMutableArray *newHistoricArchive = [NSMutableArray arrayWithCapacity:[batch count]];
+
+	for (TVCLogControllerPrintBatchEntry *entry in batch) {
+		TVCLogLine *logLine = [entry logLine];
+
+		NSDictionary *resultInfo = [entry resultInfo];
+
+		/* Gather result information. */
+		BOOL highlighted = [resultInfo boolForKey:TVCLogRendererResultsKeywordMatchFoundAttribute];
+
+		NSArray *mentionedUsers = [resultInfo arrayForKey:TVCLogRendererResultsListOfUsersFoundAttribute];
+
+		NSDictionary *inlineImageMatches = [resultInfo dictionaryForKey:@"InlineImagesToValidate"];
+
+		/* Record the line in the scrollback model. */
+		[self.scrollbackModel appendLineNumber:[entry lineNumber] html:[entry html] highlighted:highlighted];
+
+		/* Record highlights. */
+		if (highlighted) {
+			[self.associatedClient addHighlightInChannel:self.associatedChannel withLogLine:logLine];
 		}
-	};
 
-	[[self printingQueue] enqueueMessageBlock:printBlock for:self];
+		/* Inform plugins. */
+		[sharedPluginManager() postNewMessageEventForViewController:self
+														messageInfo:resultInfo[@"pluginDictionary"]
+													  isThemeReload:NO
+													isHistoryReload:NO];
+
+		/* Begin processing inline images. */
+		/* We go through the inline image list here and pass to the loader now so that
+		 we know the links have hit the webview before we even try loading them. */
+		for (NSString *uniqueKey in inlineImageMatches) {
+			TVCImageURLoader *loader = [TVCImageURLoader new];
+
+			[loader assesURL:inlineImageMatches[uniqueKey] withID:uniqueKey forController:self];
+		}
+		
+		/* Queue for the historic archive. */
+		[newHistoricArchive addObject:logLine];
+
+		/* Using informationi provided by conversation tracking we can update our internal
+		 array of favored nicknames for nick completion. */
+		if ([logLine memberType] == TVCLogLineMemberLocalUserType) {
+			[mentionedUsers makeObjectsPerformSelector:@selector(outgoingConversation)];
+		} else {
+			[mentionedUsers makeObjectsPerformSelector:@selector(conversation)];
+		}
+
+		/* Finish up. */
+		if ([entry completionBlock]) {
+			[entry completionBlock](highlighted);
+		}
+	}
+
+	/* Log the lines of the batch in a single write. */
+	/* If the channel is encrypted, then we refuse to write to
+	 the actual historic log so there is no trace of the chatter
+	 on the disk in the form of an unencrypted cache file. */
+	/* Doing it this way does break the ability to reload chatter
+	 in the view as well as playback on restart, but the added
+	 security can be seen as a bonus. */
+	if (self.viewIsEncrypted == NO) {
+		[self.historicLogFile writeNewEntriesForLogLines:newHistoricArchive];
+	}
+
+	/* Limit lines. The batch itself takes the place of the old "every
+	 fifth line" throttle so it is checked once per flush. */
+	if (self.maximumLineCount > 0 && ([self displayedLineCount] - 10) > self.maximumLineCount) {
+		[self setNeedsLimitNumberOfLines];
+	}
+
+	/* Maybe redraw our frame. */
+	[self maybeRedrawFrame];
 }
 
 - (NSString *)renderLogLine:(TVCLogLine *)line resultInfo:(NSDictionary * __autoreleasing *)resultInfo
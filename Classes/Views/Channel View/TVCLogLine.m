@@ -46,6 +46,58 @@ NSString * const TVCLogLineSpecialNoticeMessageFormat		= @"[%@]: %@";
 
 NSString * const TVCLogLineDefaultRawCommandValue			= @"-100";
 
+/* Layout of a version 1 binary record. All integers are big endian.
+
+	 uint8		version
+	 uint8		flags (1 = encrypted, 2 = historic)
+	 uint8		line type
+	 uint8		member type
+	 float64	received at (seconds since 1970)
+	 int32		nickname color number
+	 uint32		nickname (string table identifier)
+	 uint32		raw command (string table identifier)
+	 uint32		highlight keywords (string table identifier)
+	 uint32		exclude keywords (string table identifier)
+	 uint32		message body length
+	 ...		message body (UTF-8) */
+#define _binaryRecordVersion				1
+#define _binaryRecordHeaderLength			36
+
+#define _binaryRecordEncryptedFlag			1
+#define _binaryRecordHistoricFlag			2
+
+/* Layout of a string table definition.
+
+	 uint8		kind (1 = string, 2 = array of string identifiers)
+	 uint32		identifier
+	 uint32		payload length
+	 ...		payload */
+#define _stringTableStringKind				1
+#define _stringTableArrayKind				2
+
+#define _stringTableDefinitionHeaderLength	9
+
+static void _appendUInt8(NSMutableData *data, uint8_t value)
+{
+	[data appendBytes:&value length:sizeof(value)];
+}
+
+static void _appendUInt32(NSMutableData *data, uint32_t value)
+{
+	value = CFSwapInt32HostToBig(value);
+
+	[data appendBytes:&value length:sizeof(value)];
+}
+
+static uint32_t _readUInt32(const uint8_t *bytes)
+{
+	uint32_t value = 0;
+
+	memcpy(&value, bytes, sizeof(value));
+
+	return CFSwapInt32BigToHost(value);
+}
+
 @implementation TVCLogLine
 
 - (instancetype)init
@@ -252,6 +304,127 @@ NSString * const TVCLogLineDefaultRawCommandValue			= @"-100";
 	return jsondata;
 }
 
+- (NSData *)binaryRepresentationWithStringTable:(TVCLogLineStringTable *)stringTable
+{
+	PointerIsEmptyAssertReturn(stringTable, nil);
+
+	NSData *messageBody = [self.messageBody dataUsingEncoding:NSUTF8StringEncoding];
+
+	NSMutableData *record = [NSMutableData dataWithCapacity:(_binaryRecordHeaderLength + [messageBody length])];
+
+	uint8_t flags = 0;
+
+	if (self.isEncrypted) {
+		flags |= _binaryRecordEncryptedFlag;
+	}
+
+	if (self.isHistoric) {
+		flags |= _binaryRecordHistoricFlag;
+	}
+
+	_appendUInt8(record, _binaryRecordVersion);
+	_appendUInt8(record, flags);
+	_appendUInt8(record, (uint8_t)self.lineType);
+	_appendUInt8(record, (uint8_t)self.memberType);
+
+	CFSwappedFloat64 receivedAt = CFConvertDoubleHostToSwapped([self.receivedAt timeIntervalSince1970]);
+
+	[record appendBytes:&receivedAt length:sizeof(receivedAt)];
+
+	_appendUInt32(record, (uint32_t)((int32_t)self.nicknameColorNumber));
+
+	_appendUInt32(record, [stringTable identifierForString:self.nickname]);
+	_appendUInt32(record, [stringTable identifierForString:self.rawCommand]);
+
+	_appendUInt32(record, [stringTable identifierForStringArray:self.highlightKeywords]);
+	_appendUInt32(record, [stringTable identifierForStringArray:self.excludeKeywords]);
+
+	_appendUInt32(record, (uint32_t)[messageBody length]);
+
+	[record appendData:messageBody];
+
+	return record;
+}
+
+- (TVCLogLine *)initWithBinaryRepresentation:(NSData *)input stringTable:(TVCLogLineStringTable *)stringTable
+{
+	NSObjectIsEmptyAssertReturn(input, nil);
+
+	const uint8_t *bytes = [input bytes];
+
+	NSUInteger length = [input length];
+
+	/* Records written before the binary format existed are JSON objects. */
+	if (bytes[0] == '{') {
+		return [self initWithRawJSONData:input];
+	}
+
+	if (bytes[0] != _binaryRecordVersion || length < _binaryRecordHeaderLength) {
+		LogToConsole(@"Unsupported or truncated binary log line record.");
+
+		return nil;
+	}
+
+	uint32_t messageBodyLength = _readUInt32(bytes + 32);
+
+	if ((_binaryRecordHeaderLength + messageBodyLength) > length) {
+		LogToConsole(@"Unsupported or truncated binary log line record.");
+
+		return nil;
+	}
+
+	if ((self = [self init])) {
+		self.isEncrypted = ((bytes[1] & _binaryRecordEncryptedFlag) == _binaryRecordEncryptedFlag);
+		self.isHistoric = ((bytes[1] & _binaryRecordHistoricFlag) == _binaryRecordHistoricFlag);
+
+		self.lineType = bytes[2];
+		self.memberType = bytes[3];
+
+		CFSwappedFloat64 receivedAt;
+
+		memcpy(&receivedAt, (bytes + 4), sizeof(receivedAt));
+
+		self.receivedAt = [NSDate dateWithTimeIntervalSince1970:CFConvertDoubleSwappedToHost(receivedAt)];
+
+		self.nicknameColorNumber = (int32_t)_readUInt32(bytes + 12);
+
+		/* Identifiers missing from the table leave the value set by -init. */
+		NSString *nickname = [stringTable stringForIdentifier:_readUInt32(bytes + 16)];
+		NSString *rawCommand = [stringTable stringForIdentifier:_readUInt32(bytes + 20)];
+
+		NSArray *highlightKeywords = [stringTable stringArrayForIdentifier:_readUInt32(bytes + 24)];
+		NSArray *excludeKeywords = [stringTable stringArrayForIdentifier:_readUInt32(bytes + 28)];
+
+		if (nickname) {
+			_nickname = nickname;
+		}
+
+		if (rawCommand) {
+			_rawCommand = rawCommand;
+		}
+
+		if (highlightKeywords) {
+			_highlightKeywords = highlightKeywords;
+		}
+
+		if (excludeKeywords) {
+			_excludeKeywords = excludeKeywords;
+		}
+
+		NSString *messageBody = [[NSString alloc] initWithBytes:(bytes + _binaryRecordHeaderLength)
+														 length:messageBodyLength
+													   encoding:NSUTF8StringEncoding];
+
+		if (messageBody) {
+			_messageBody = messageBody;
+		}
+
+		return self;
+	}
+
+	return nil;
+}
+
 - (TVCLogLine *)initWithRawJSONData:(NSData *)input
 {
 	NSError *jsonconverr = nil;
@@ -298,3 +471,208 @@ NSString * const TVCLogLineDefaultRawCommandValue			= @"-100";
 }
 
 @end
+
+#pragma mark -
+#pragma mark String Table
+
+@interface TVCLogLineStringTable ()
+@property (nonatomic, strong) NSMutableArray *definedValues;
+@property (nonatomic, strong) NSMutableDictionary *stringIdentifiers;
+@property (nonatomic, strong) NSMutableDictionary *stringArrayIdentifiers;
+@property (nonatomic, strong) NSMutableData *pendingDefinitionData;
+@end
+
+@implementation TVCLogLineStringTable
+
+- (instancetype)init
+{
+	if ((self = [super init])) {
+		self.definedValues = [NSMutableArray array];
+
+		self.stringIdentifiers = [NSMutableDictionary dictionary];
+		self.stringArrayIdentifiers = [NSMutableDictionary dictionary];
+
+		self.pendingDefinitionData = [NSMutableData data];
+
+		return self;
+	}
+
+	return nil;
+}
+
+- (NSData *)pendingDefinitions
+{
+	return [self.pendingDefinitionData copy];
+}
+
+- (void)markPendingDefinitionsAsWritten
+{
+	[self.pendingDefinitionData setLength:0];
+}
+
+- (NSUInteger)loadDefinitions:(NSData *)definitions
+{
+	const uint8_t *bytes = [definitions bytes];
+
+	NSUInteger length = [definitions length];
+
+	NSUInteger position = 0;
+
+	NSUInteger loadedLength = 0;
+
+	/* Identifiers are handed out in order so a definition that does not
+	 follow the last one means the remainder of the data is unusable. */
+	while ((position + _stringTableDefinitionHeaderLength) <= length) {
+		uint8_t kind = bytes[position];
+
+		uint32_t identifier = _readUInt32(bytes + position + 1);
+		uint32_t payloadLength = _readUInt32(bytes + position + 5);
+
+		position += _stringTableDefinitionHeaderLength;
+
+		if ((position + payloadLength) > length || identifier != ([self.definedValues count] + 1)) {
+			break;
+		}
+
+		if (kind != _stringTableStringKind && kind != _stringTableArrayKind) {
+			break;
+		}
+
+		if (kind == _stringTableStringKind) {
+			NSString *string = [[NSString alloc] initWithBytes:(bytes + position) length:payloadLength encoding:NSUTF8StringEncoding];
+
+			if (string == nil) {
+				string = NSStringEmptyPlaceholder;
+			}
+
+			[self.definedValues addObject:string];
+
+			self.stringIdentifiers[string] = @(identifier);
+		} else if (kind == _stringTableArrayKind) {
+			NSMutableArray *stringArray = [NSMutableArray arrayWithCapacity:(payloadLength / sizeof(uint32_t))];
+
+			for (NSUInteger i = 0; (i + sizeof(uint32_t)) <= payloadLength; i += sizeof(uint32_t)) {
+				NSString *string = [self stringForIdentifier:_readUInt32(bytes + position + i)];
+
+				if (string) {
+					[stringArray addObject:string];
+				}
+			}
+
+			NSArray *immutableArray = [stringArray copy];
+
+			[self.definedValues addObject:immutableArray];
+
+			self.stringArrayIdentifiers[immutableArray] = @(identifier);
+		}
+
+		position += payloadLength;
+
+		loadedLength = position;
+	}
+
+	return loadedLength;
+}
+
+- (uint32_t)defineValue:(id)value ofKind:(uint8_t)kind withPayload:(NSData *)payload
+{
+	[self.definedValues addObject:value];
+
+	uint32_t identifier = (uint32_t)[self.definedValues count];
+
+	_appendUInt8(self.pendingDefinitionData, kind);
+	_appendUInt32(self.pendingDefinitionData, identifier);
+	_appendUInt32(self.pendingDefinitionData, (uint32_t)[payload length]);
+
+	[self.pendingDefinitionData appendData:payload];
+
+	return identifier;
+}
+
+- (uint32_t)identifierForString:(NSString *)string
+{
+	/* Zero stands for no value. */
+	NSObjectIsEmptyAssertReturn(string, 0);
+
+	NSNumber *identifier = self.stringIdentifiers[string];
+
+	if (identifier) {
+		return [identifier unsignedIntValue];
+	}
+
+	NSString *immutableString = [string copy];
+
+	uint32_t newIdentifier = [self defineValue:immutableString
+										ofKind:_stringTableStringKind
+								   withPayload:[immutableString dataUsingEncoding:NSUTF8StringEncoding]];
+
+	self.stringIdentifiers[immutableString] = @(newIdentifier);
+
+	return newIdentifier;
+}
+
+- (uint32_t)identifierForStringArray:(NSArray *)stringArray
+{
+	NSObjectIsEmptyAssertReturn(stringArray, 0);
+
+	NSNumber *identifier = self.stringArrayIdentifiers[stringArray];
+
+	if (identifier) {
+		return [identifier unsignedIntValue];
+	}
+
+	/* Members are defined first so the array only refers backwards. */
+	NSMutableData *payload = [NSMutableData dataWithCapacity:([stringArray count] * sizeof(uint32_t))];
+
+	for (NSString *string in stringArray) {
+		_appendUInt32(payload, [self identifierForString:string]);
+	}
+
+	NSArray *immutableArray = [stringArray copy];
+
+	uint32_t newIdentifier = [self defineValue:immutableArray ofKind:_stringTableArrayKind withPayload:payload];
+
+	self.stringArrayIdentifiers[immutableArray] = @(newIdentifier);
+
+	return newIdentifier;
+}
+
+- (NSString *)stringForIdentifier:(uint32_t)identifier
+{
+	if (identifier == 0) {
+		return NSStringEmptyPlaceholder;
+	}
+
+	if (identifier > [self.definedValues count]) {
+		return nil;
+	}
+
+	id value = self.definedValues[(identifier - 1)];
+
+	if ([value isKindOfClass:[NSString class]]) {
+		return value;
+	}
+
+	return nil;
+}
+
+- (NSArray *)stringArrayForIdentifier:(uint32_t)identifier
+{
+	if (identifier == 0) {
+		return @[];
+	}
+
+	if (identifier > [self.definedValues count]) {
+		return nil;
+	}
+
+	id value = self.definedValues[(identifier - 1)];
+
+	if ([value isKindOfClass:[NSArray class]]) {
+		return value;
+	}
+
+	return nil;
+}
+
+@end
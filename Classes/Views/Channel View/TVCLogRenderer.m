@@ -154,6 +154,155 @@ static NSInteger getNextAttributeRange(attr_t *attrBuf, NSInteger start, NSInteg
 
 #pragma mark -
 
+/* TVCLogRendererKeywordMatcher holds the highlight and excluded keywords of a
+ view compiled into scanners (or regular expressions) so that they are not
+ merged and searched for one at a time for every line rendered. A matcher 
+ remembers what it was compiled from and is replaced when any of it changes.
+
+ The keyword lists and highlight entries are compared by pointer. They are
+ replaced instead of modified when the preferences or the configuration of
+ the client change, so a new instance is what signals a change. Comparing
+ their contents would cost as much as the keywords are long for every line. */
+@interface TVCLogRendererKeywordMatcher : NSObject
+@property (nonatomic, strong) NSArray *highlightKeywords;
+@property (nonatomic, strong) NSArray *excludedKeywords;
+@property (nonatomic, strong) NSArray *highlightEntries;
+@property (nonatomic, copy) NSString *channelIdentifier;
+@property (nonatomic, assign) TXNicknameHighlightMatchType matchingMethod;
+@property (nonatomic, strong) TLOMultiPatternScanner *highlightScanner;
+@property (nonatomic, strong) TLOMultiPatternScanner *excludedScanner;
+@property (nonatomic, copy) NSArray *highlightExpressions;
+@end
+
+@implementation TVCLogRendererKeywordMatcher
+
+- (BOOL)isCompiledFromHighlightKeywords:(NSArray *)highlightKeywords
+					   excludedKeywords:(NSArray *)excludedKeywords
+					   highlightEntries:(NSArray *)highlightEntries
+					  channelIdentifier:(NSString *)channelIdentifier
+						 matchingMethod:(TXNicknameHighlightMatchType)matchingMethod
+{
+	return (self.matchingMethod == matchingMethod										&&
+			self.highlightEntries == highlightEntries									&&
+			self.highlightKeywords == highlightKeywords									&&
+			self.excludedKeywords == excludedKeywords									&&
+			NSObjectsAreEqual(self.channelIdentifier, channelIdentifier));
+}
+
+- (void)compile
+{
+	/* Merge in the highlight entries of the client which apply to this channel. */
+	NSMutableOrderedSet *highlightWords = [NSMutableOrderedSet orderedSetWithArray:self.highlightKeywords];
+	NSMutableOrderedSet *excludedWords = [NSMutableOrderedSet orderedSetWithArray:self.excludedKeywords];
+
+	for (TDCHighlightEntryMatchCondition *e in self.highlightEntries) {
+		NSString *matchChannel = [e matchChannelID];
+
+		if ([matchChannel length] > 0) {
+			if ([matchChannel isEqualToString:self.channelIdentifier] == NO) {
+				continue;
+			}
+		}
+
+		NSString *matchKeyword = [e matchKeyword];
+
+		NSObjectIsEmptyAssertLoopContinue(matchKeyword);
+
+		if ([e matchIsExcluded]) {
+			[excludedWords addObject:matchKeyword];
+		} else {
+			[highlightWords addObject:matchKeyword];
+		}
+	}
+
+	/* Excluded words are always matched literally. */
+	TLOMultiPatternScanner *excludedScanner = [TLOMultiPatternScanner new];
+
+	for (NSString *excludeWord in excludedWords) {
+		[excludedScanner addPattern:excludeWord withObject:excludeWord];
+	}
+
+	self.excludedScanner = excludedScanner;
+
+	if (self.matchingMethod == TXNicknameHighlightRegularExpressionMatchType) {
+		NSMutableArray *highlightExpressions = [NSMutableArray arrayWithCapacity:[highlightWords count]];
+
+		for (NSString *keyword in highlightWords) {
+			NSRegularExpression *expression = [NSRegularExpression regularExpressionWithPattern:keyword
+																						options:NSRegularExpressionCaseInsensitive
+																						  error:NULL];
+
+			if (expression) {
+				[highlightExpressions addObject:expression];
+			}
+		}
+
+		self.highlightExpressions = highlightExpressions;
+	} else {
+		/* Each keyword is added with its position in the list so that the
+		 keyword which comes first can be highlighted, as it always has been.
+		 They are added last to first because when two keywords fold the same,
+		 the one added last is the one the scanner keeps. */
+		TLOMultiPatternScanner *highlightScanner = [TLOMultiPatternScanner new];
+
+		NSArray *highlightWordsArray = [highlightWords array];
+
+		for (NSInteger i = ([highlightWordsArray count] - 1); i >= 0; i--) {
+			[highlightScanner addPattern:highlightWordsArray[i] withObject:@(i)];
+		}
+
+		self.highlightScanner = highlightScanner;
+	}
+}
+
++ (TVCLogRendererKeywordMatcher *)matcherForController:(TVCLogController *)controller
+									 highlightKeywords:(NSArray *)highlightKeywords
+									  excludedKeywords:(NSArray *)excludedKeywords
+{
+	static NSMapTable *cachedMatchers = nil;
+
+	static dispatch_once_t onceToken;
+
+	dispatch_once(&onceToken, ^{
+		cachedMatchers = [NSMapTable weakToStrongObjectsMapTable];
+	});
+
+	NSArray *highlightEntries = [[[controller associatedClient] config] highlightList];
+
+	NSString *channelIdentifier = [[controller associatedChannel] uniqueIdentifier];
+
+	TXNicknameHighlightMatchType matchingMethod = [TPCPreferences highlightMatchingMethod];
+
+	@synchronized(cachedMatchers) {
+		TVCLogRendererKeywordMatcher *matcher = [cachedMatchers objectForKey:controller];
+
+		if (matcher == nil || [matcher isCompiledFromHighlightKeywords:highlightKeywords
+													  excludedKeywords:excludedKeywords
+													  highlightEntries:highlightEntries
+													 channelIdentifier:channelIdentifier
+														matchingMethod:matchingMethod] == NO)
+		{
+			matcher = [TVCLogRendererKeywordMatcher new];
+
+			[matcher setHighlightKeywords:highlightKeywords];
+			[matcher setExcludedKeywords:excludedKeywords];
+			[matcher setHighlightEntries:highlightEntries];
+			[matcher setChannelIdentifier:channelIdentifier];
+			[matcher setMatchingMethod:matchingMethod];
+
+			[matcher compile];
+
+			[cachedMatchers setObject:matcher forKey:controller];
+		}
+
+		return matcher;
+	}
+}
+
+@end
+
+#pragma mark -
+
 @implementation TVCLogRenderer
 
 - (instancetype)init
@@ -171,159 +320,109 @@ static NSInteger getNextAttributeRange(attr_t *attrBuf, NSInteger start, NSInteg
 {
 	NSInteger length = [_body length];
 
-	NSInteger n	= 0;
-
-	attr_t attrBuf[length];
-	attr_t currentAttr = 0;
-
-	memset(attrBuf, 0, (length * sizeof(attr_t)));
-
-	UniChar dest[length];
-	UniChar source[length];
+	_effectAttributes = calloc(length, sizeof(attr_t));
 
-	CFStringGetCharacters((__bridge CFStringRef)_body, CFRangeMake(0, length), source);
+	TLOFormattingSpanList *spanList = [TLOFormattingSpanList spanListForString:_body];
 
-	for (NSInteger i = 0; i < length; i++) {
-		UniChar c = source[i];
+	/* Most lines have no formatting at all. */
+	if (spanList == nil) {
+		_outputDictionary[TVCLogRendererResultsOriginalBodyWithoutEffectsAttribute] = _body;
 
-		if (c < 0x20) {
-			switch (c) {
-				case IRCTextFormatterBoldEffectCharacter:
-				{
-					if (currentAttr & _rendererBoldFormatAttribute) {
-						currentAttr &= ~_rendererBoldFormatAttribute;
-					} else {
-						currentAttr |= _rendererBoldFormatAttribute;
-					}
+		return;
+	}
 
-					continue;
-				}
-				case IRCTextFormatterColorEffectCharacter:
-				{
-					NSInteger foregoundColor  = -1;
-					NSInteger backgroundColor = -1;
+	attr_t *attrBuf = _effectAttributes;
+	attr_t currentAttr = 0;
 
-					if ((i + 1) < length) {
-						c = source[(i + 1)];
+	/* The text between two spans has the effects of every span before it. */
+	NSInteger n = 0;
 
-						if (CSCEF_StringIsBase10Numeric(c)) {
-							++i;
+	NSUInteger segmentStart = 0;
 
-							foregoundColor = (c - '0');
+	NSUInteger spanCount = [spanList count];
 
-							if ((i + 1) < length) {
-								c = source[(i + 1)];
+	for (NSUInteger i = 0; i <= spanCount; i++) {
+		TLOFormattingSpan span = {{0, 0}, TLOFormattingBoldSpanType, -1, -1};
 
-								if (CSCEF_StringIsBase10Numeric(c)) {
-									++i;
+		NSUInteger segmentEnd = length;
 
-									foregoundColor = (foregoundColor * 10 + c - '0');
-								}
+		if (i < spanCount) {
+			span = [spanList spanAtIndex:i];
 
-								if ((i + 1) < length) {
-									c = source[(i + 1)];
-								}
-							}
+			segmentEnd = span.range.location;
+		}
 
-							/* It's possible for an IRC client to send formatting with only a comma
-							and the background color digit. Therefore, this logic is independent
-							of the logic shown above for the foreground color. */
-							if (c == ',') {
-								++i;
+		for (NSUInteger j = segmentStart; j < segmentEnd; j++) {
+			attrBuf[n++] = currentAttr;
+		}
 
-								if ((i + 1) < length) {
-									c = source[(i + 1)];
+		if (i == spanCount) {
+			break;
+		}
 
-									if (CSCEF_StringIsBase10Numeric(c)) {
-										++i;
+		segmentStart = NSMaxRange(span.range);
 
-										backgroundColor = (c - '0');
+		switch (span.type) {
+			case TLOFormattingBoldSpanType:
+			{
+				currentAttr ^= _rendererBoldFormatAttribute;
 
-										if ((i + 1) < length) {
-											c = source[(i + 1)];
+				break;
+			}
+			case TLOFormattingItalicSpanType:
+			{
+				currentAttr ^= _rendererItalicFormatAttribute;
 
-											if (CSCEF_StringIsBase10Numeric(c)) {
-												++i;
+				break;
+			}
+			case TLOFormattingUnderlineSpanType:
+			{
+				currentAttr ^= _rendererUnderlineFormatAttribute;
 
-												backgroundColor = (backgroundColor * 10 + c - '0');
-											}
-										}
-									} else {
-										i--;
-									}
-								}
-							}
-						}
+				break;
+			}
+			case TLOFormattingTerminatingSpanType:
+			{
+				currentAttr = 0;
 
-						currentAttr &= ~(_rendererTextColorAttribute | _rendererBackgroundColorAttribute | 0xFF);
+				break;
+			}
+			case TLOFormattingColorSpanType:
+			{
+				/* A color character at the very end of the body changes nothing. */
+				if (NSMaxRange(span.range) == length && span.range.length == 1) {
+					break;
+				}
 
-						if (backgroundColor >= 0) {
-							backgroundColor %= 16;
+				NSInteger foregoundColor = span.foregroundColor;
+				NSInteger backgroundColor = span.backgroundColor;
 
-							currentAttr |= _rendererBackgroundColorAttribute;
-							currentAttr |= ((backgroundColor << 4) & _backgroundColorMask);
-						} else {
-							currentAttr &= ~(_rendererBackgroundColorAttribute | _backgroundColorMask);
-						}
+				currentAttr &= ~(_rendererTextColorAttribute | _rendererBackgroundColorAttribute | 0xFF);
 
-						if (foregoundColor >= 0) {
-							foregoundColor %= 16;
+				if (backgroundColor >= 0) {
+					backgroundColor %= 16;
 
-							currentAttr |= _rendererTextColorAttribute;
-							currentAttr |= (foregoundColor & _textColorMask);
-						} else {
-							currentAttr &= ~(_rendererTextColorAttribute | _textColorMask);
-						}
-					}
-
-					continue;
+					currentAttr |= _rendererBackgroundColorAttribute;
+					currentAttr |= ((backgroundColor << 4) & _backgroundColorMask);
 				}
-				case IRCTextFormatterTerminatingCharacter:
-				{
-					currentAttr = 0;
 
-					continue;
-				}
-				case IRCTextFormatterItalicEffectCharacter:
-				case 0x16: // Old character used for italic text
-				{
-					if (currentAttr & _rendererItalicFormatAttribute) {
-						currentAttr &= ~_rendererItalicFormatAttribute;
-					} else {
-						currentAttr |= _rendererItalicFormatAttribute;
-					}
+				if (foregoundColor >= 0) {
+					foregoundColor %= 16;
 
-					continue;
+					currentAttr |= _rendererTextColorAttribute;
+					currentAttr |= (foregoundColor & _textColorMask);
 				}
-				case IRCTextFormatterUnderlineEffectCharacter:
-				{
-					if (currentAttr & _rendererUnderlineFormatAttribute) {
-						currentAttr &= ~_rendererUnderlineFormatAttribute;
-					} else {
-						currentAttr |= _rendererUnderlineFormatAttribute;
-					}
 
-					continue;
-				}
+				break;
 			}
 		}
-		
-		attrBuf[n] = currentAttr;
-		
-		dest[n++] = c;
 	}
 
-	NSString *stringBody = [NSString stringWithCharacters:dest length:n];
+	NSString *stringBody = [spanList strippedString];
 
 	_body = [stringBody copy];
 
 	_outputDictionary[TVCLogRendererResultsOriginalBodyWithoutEffectsAttribute] = stringBody;
-
-	NSInteger bufferSize = sizeof(attrBuf);
-
-	_effectAttributes = malloc(bufferSize);
-
-	memcpy(_effectAttributes, attrBuf, bufferSize);
 }
 
 - (BOOL)isRenderingPRIVMSG
@@ -407,83 +506,37 @@ static NSInteger getNextAttributeRange(attr_t *attrBuf, NSInteger start, NSInteg
 - (void)matchKeywords
 {
 	if ([self scanForKeywords]) {
-		id highlightWords = [_rendererAttributes arrayForKey:TVCLogRendererConfigurationHighlightKeywordsAttribute];
-		id excludedWords = [_rendererAttributes arrayForKey:TVCLogRendererConfigurationExcludedKeywordsAttribute];
+		NSArray *highlightWords = [_rendererAttributes arrayForKey:TVCLogRendererConfigurationHighlightKeywordsAttribute];
+		NSArray *excludedWords = [_rendererAttributes arrayForKey:TVCLogRendererConfigurationExcludedKeywordsAttribute];
 
 		PointerIsEmptyAssert(_controller);
 
-		IRCClient *client = [_controller associatedClient];
-		IRCChannel *channel = [_controller associatedChannel];
-
-		NSArray *clientHighlightList = [[client config] highlightList];
-
-		if ([clientHighlightList count] > 0) {
-			highlightWords = [highlightWords mutableCopy];
-
-			excludedWords = [excludedWords mutableCopy];
-		}
-
-		for (TDCHighlightEntryMatchCondition *e in clientHighlightList) {
-			BOOL addKeyword = NO;
-
-			NSString *matchChannel = [e matchChannelID];
-
-			if ([matchChannel length] > 0) {
-				NSString *channelID = [channel uniqueIdentifier];
-
-				if ([matchChannel isEqualToString:channelID]) {
-					addKeyword = YES;
-				}
-			} else {
-				addKeyword = YES;
-			}
-
-			if (addKeyword) {
-				if ([e matchIsExcluded]) {
-					[excludedWords addObjectWithoutDuplication:[e matchKeyword]];
-				} else {
-					[highlightWords addObjectWithoutDuplication:[e matchKeyword]];
-				}
-			}
-		}
-
-		NSMutableArray *excludeRanges = [NSMutableArray array];
+		TVCLogRendererKeywordMatcher *matcher = [TVCLogRendererKeywordMatcher matcherForController:_controller
+																				 highlightKeywords:highlightWords
+																				  excludedKeywords:excludedWords];
 
 		/* Exclude word matching. */
-		NSInteger start = 0;
-		NSInteger length = [_body length];
-
-		for (NSString *excludeWord in excludedWords) {
-			while (start < length) {
-				NSRange r = [_body rangeOfString:excludeWord
-										 options:NSCaseInsensitiveSearch
-										   range:NSMakeRange(start, (length - start))];
-
-				if (r.location == NSNotFound) {
-					break;
-				}
-
-				[excludeRanges addObject:[NSValue valueWithRange:r]];
-
-				start = (NSMaxRange(r) + 1);
-			}
+		NSMutableArray *excludeRanges = [NSMutableArray array];
 
-			start = 0;
-		}
+		[[matcher excludedScanner] enumerateMatchesInString:_body usingBlock:^(id object, NSRange range, BOOL *stop) {
+			[excludeRanges addObject:[NSValue valueWithRange:range]];
+		}];
 
 		BOOL foundKeyword = NO;
 
-		switch ([TPCPreferences highlightMatchingMethod]) {
+		switch ([matcher matchingMethod]) {
 			case TXNicknameHighlightExactMatchType:
 			case TXNicknameHighlightPartialMatchType:
 			{
-				foundKeyword = [self matchKeywordsUsingNormalMatching:highlightWords excludedRanges:excludeRanges];
+				foundKeyword = [self matchKeywordsUsingScanner:[matcher highlightScanner]
+												  exactMatches:([matcher matchingMethod] == TXNicknameHighlightExactMatchType)
+												excludedRanges:excludeRanges];
 
 				break;
 			}
 			case TXNicknameHighlightRegularExpressionMatchType:
 			{
-				foundKeyword = [self matchKeywordsUsingRegularExpression:highlightWords excludedRanges:excludeRanges];
+				foundKeyword = [self matchKeywordsUsingRegularExpressions:[matcher highlightExpressions] excludedRanges:excludeRanges];
 
 				break;
 			}
@@ -493,104 +546,93 @@ static NSInteger getNextAttributeRange(attr_t *attrBuf, NSInteger start, NSInteg
 	}
 }
 
-- (BOOL)matchKeywordsUsingNormalMatching:(NSArray *)keywrods excludedRanges:(NSArray *)excludedRanges
+- (BOOL)rangeOfBody:(NSRange)r intersectsExcludedRanges:(NSArray *)excludedRanges
 {
-	/* Normal keyword matching. Partial and absolute. */
-	BOOL foundKeyword = NO;
+	for (NSValue *e in excludedRanges) {
+		if (NSIntersectionRange(r, [e rangeValue]).length > 0) {
+			return YES;
+		}
+	}
 
-	for (__strong NSString *keyword in keywrods) {
-		NSInteger start = 0;
-		NSInteger length = [_body length];
+	return NO;
+}
 
-		while (start < length) {
-			NSRange r = [_body rangeOfString:keyword
-									 options:NSCaseInsensitiveSearch
-									   range:NSMakeRange(start, (length - start))];
+- (BOOL)matchKeywordsUsingScanner:(TLOMultiPatternScanner *)scanner exactMatches:(BOOL)exactMatches excludedRanges:(NSArray *)excludedRanges
+{
+	/* Normal keyword matching. Partial and absolute. */
+	/* Only one keyword is highlighted because as long as there is one amongst 
+	 many, that is all the end user really cares about. That is the keyword 
+	 which comes first in the list, at the first place it appears in the body. */
+	__block NSUInteger matchedKeywordIndex = NSNotFound;
 
-			if (r.location == NSNotFound) {
-				break;
-			}
+	__block NSRange matchedRange = NSMakeRange(NSNotFound, 0);
 
-			BOOL enabled = YES;
+	[scanner enumerateMatchesInString:_body usingBlock:^(NSNumber *keywordIndex, NSRange r, BOOL *stop) {
+		NSUInteger keywordIndexValue = [keywordIndex unsignedIntegerValue];
 
-			for (NSValue *e in excludedRanges) {
-				if (NSIntersectionRange(r, [e rangeValue]).length > 0) {
-					enabled = NO;
+		if (keywordIndexValue > matchedKeywordIndex) {
+			return;
+		} else if (keywordIndexValue == matchedKeywordIndex && r.location > matchedRange.location) {
+			return;
+		}
 
-					break;
-				}
-			}
+		if ([self rangeOfBody:r intersectsExcludedRanges:excludedRanges]) {
+			return;
+		}
 
-			if (enabled) {
-				if ([TPCPreferences highlightMatchingMethod] == TXNicknameHighlightExactMatchType) {
-					enabled = [self sectionOfBodyIsSurroundedByNonAlphabeticals:r];
-				}
+		if (exactMatches) {
+			if ([self sectionOfBodyIsSurroundedByNonAlphabeticals:r] == NO) {
+				return;
+			}
+		}
 
-				if (enabled) {
-					if (isClear(_effectAttributes, _rendererURLAttribute, r.location, r.length)) {
-						setFlag(_effectAttributes, _rendererKeywordHighlightAttribute, r.location, r.length);
+		if (isClear(_effectAttributes, _rendererURLAttribute, r.location, r.length)) {
+			matchedKeywordIndex = keywordIndexValue;
 
-						foundKeyword = YES;
+			matchedRange = r;
 
-						break;
-					}
-				}
+			/* Nothing can come before the first keyword. */
+			if (keywordIndexValue == 0) {
+				*stop = YES;
 			}
-
-			start = (NSMaxRange(r) + 1);
 		}
+	}];
 
-		/* We break after finding a keyword because as long as there is one
-		 amongst many, that is all the end user really cares about. */
-		if (foundKeyword) {
-			break;
-		}
+	if (matchedKeywordIndex == NSNotFound) {
+		return NO;
 	}
 
-	return foundKeyword;
+	setFlag(_effectAttributes, _rendererKeywordHighlightAttribute, matchedRange.location, matchedRange.length);
+
+	return YES;
 }
 
-- (BOOL)matchKeywordsUsingRegularExpression:(NSArray *)keywords excludedRanges:(NSArray *)excludedRanges
+- (BOOL)matchKeywordsUsingRegularExpressions:(NSArray *)expressions excludedRanges:(NSArray *)excludedRanges
 {
 	/* Regular expression keyword matching. */
-	BOOL foundKeyword = NO;
+	NSRange bodyRange = NSMakeRange(0, [_body length]);
 
-	for (NSString *keyword in keywords) {
-		NSRange matchRange = [XRRegularExpression string:_body rangeOfRegex:keyword withoutCase:YES];
+	for (NSRegularExpression *expression in expressions) {
+		NSRange matchRange = [expression rangeOfFirstMatchInString:_body options:0 range:bodyRange];
 
-		if (matchRange.location == NSNotFound) {
+		if (matchRange.location == NSNotFound || matchRange.length == 0) {
 			continue;
-		} else {
-			BOOL enabled = YES;
-
-			for (NSValue *e in excludedRanges) {
-				/* Did the regular expression find a match inside an excluded range? */
-				if (NSIntersectionRange(matchRange, [e rangeValue]).length > 0) {
-					enabled = NO;
-
-					break;
-				}
-			}
-
-			/* Found a match. */
-			if (enabled) {
-				if (isClear(_effectAttributes, _rendererURLAttribute, matchRange.location, matchRange.length)) {
-					setFlag(_effectAttributes, _rendererKeywordHighlightAttribute, matchRange.location, matchRange.length);
+		}
 
-					foundKeyword = YES;
+		/* Did the regular expression find a match inside an excluded range? */
+		if ([self rangeOfBody:matchRange intersectsExcludedRanges:excludedRanges]) {
+			continue;
+		}
 
-					break; // break from first for loop ending search
-				}
-			}
+		/* Found a match. */
+		if (isClear(_effectAttributes, _rendererURLAttribute, matchRange.location, matchRange.length)) {
+			setFlag(_effectAttributes, _rendererKeywordHighlightAttribute, matchRange.location, matchRange.length);
 
-			/* Break if any keywords are matched. */
-			if (foundKeyword) {
-				break;
-			}
+			return YES;
 		}
 	}
 
-	return foundKeyword;
+	return NO;
 }
 
 - (void)findAllChannelNames
@@ -682,56 +724,47 @@ static NSInteger getNextAttributeRange(attr_t *attrBuf, NSInteger start, NSInteg
 		IRCClient *client = [_controller associatedClient];
 		IRCChannel *channel = [_controller associatedChannel];
 
-		NSInteger totalNicknameLength = 0;
-		NSInteger totalNicknameCount = 0;
+		__block NSInteger totalNicknameLength = 0;
+		__block NSInteger totalNicknameCount = 0;
 
 		NSMutableSet *mentionedUsers = [NSMutableSet set];
 
-		NSArray *sortedMembers = [channel memberListSortedByNicknameLength];
-
-		NSInteger start = 0;
 		NSInteger length = [_body length];
 
-		for (IRCUser *user in sortedMembers) {
-			while (start < length) {
-				NSRange r = [_body rangeOfString:[user nickname]
-										 options:NSCaseInsensitiveSearch
-										   range:NSMakeRange(start, (length - start))];
-
-				if (r.location == NSNotFound) {
-					break;
-				}
+		/* The scanner reports every occurrence of every nickname in one pass
+		 over the body. Each is then checked the same way as before. */
+		[channel enumerateMembersMentionedInString:_body usingBlock:^(IRCUser *user, NSRange r, BOOL *stop) {
+			BOOL cleanMatch = [self sectionOfBodyIsSurroundedByNonAlphabeticals:r];
 
-				BOOL cleanMatch = [self sectionOfBodyIsSurroundedByNonAlphabeticals:r];
+			if (cleanMatch) {
+				if (isClear(_effectAttributes, _rendererURLAttribute, r.location, r.length) &&
+					isClear(_effectAttributes, _rendererKeywordHighlightAttribute, r.location, r.length))
+				{
+					/* Check if the nickname conversation tracking found is matched to an ignore
+					 that is set to hide them. */
+					IRCAddressBookEntry *ignoreCheck = [client checkIgnoreAgainstHostmask:[user hostmask] withFlags:IRCAddressBookIgnoreMessagesContainingMatchFlag];
 
-				if (cleanMatch) {
-					if (isClear(_effectAttributes, _rendererURLAttribute, r.location, r.length) &&
-						isClear(_effectAttributes, _rendererKeywordHighlightAttribute, r.location, r.length))
-					{
-						/* Check if the nickname conversation tracking found is matched to an ignore
-						 that is set to hide them. */
-						IRCAddressBookEntry *ignoreCheck = [client checkIgnoreAgainstHostmask:[user hostmask] withMatches:@[@"hideMessagesContainingMatch"]];
+					if (ignoreCheck && [ignoreCheck ignoreMessagesContainingMatchh]) {
+						_cancelRender = YES;
 
-						if (ignoreCheck && [ignoreCheck ignoreMessagesContainingMatchh]) {
-							_cancelRender = YES;
+						*stop = YES; // Break from the scan.
 
-							return; // Break from this method.
-						}
+						return;
+					}
 
-						/* Continue normally. */
-						setFlag(_effectAttributes, _rendererConversationTrackerAttribute, r.location, r.length);
+					/* Continue normally. */
+					setFlag(_effectAttributes, _rendererConversationTrackerAttribute, r.location, r.length);
 
-						totalNicknameCount += 1;
-						totalNicknameLength += [[user nickname] length];
+					totalNicknameCount += 1;
+					totalNicknameLength += r.length;
 
-						[mentionedUsers addObject:user];
-					}
+					[mentionedUsers addObject:user];
 				}
-
-				start = (NSMaxRange(r) + 1);
 			}
+		}];
 
-			start = 0;
+		if (_cancelRender) {
+			return; // Break from this method.
 		}
 
 		if ([mentionedUsers count] > 0) {
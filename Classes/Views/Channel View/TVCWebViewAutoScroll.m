@@ -69,6 +69,12 @@
 	
 	self.lastVisibleRect = [clipView.documentView visibleRect];
 
+	/* Lines trimmed from the WebView are paged back in from the
+	 scrollback model once the user scrolls up to the top. */
+	if (NSMinY(self.lastVisibleRect) <= 0 && [self canScroll]) {
+		[self.logController pageInOlderLines];
+	}
+
 	[self forceFrameRedraw];
 }
 
@@ -60,6 +60,16 @@ Textual.viewInitiated 					= function(viewType, serverHash, channelHash, channel
 
 Textual.newMessagePostedToView 			= function(lineNumber) {};
 
+/* Textual appends new messages in batches and calls newMessagesPostedToView() once per
+   batch with the line number of each message, in order. The default implementation calls
+   newMessagePostedToView() for each line so styles that only implement that still work. */
+Textual.newMessagesPostedToView 		= function(lineNumbers)
+{
+	for (var i = 0; i < lineNumbers.length; i++) {
+		Textual.newMessagePostedToView(lineNumbers[i]);
+	}
+};
+
 Textual.historyIndicatorAddedToView			= function() {};
 Textual.historyIndicatorRemovedFromView 	= function() {};
 